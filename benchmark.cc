@@ -0,0 +1,1266 @@
+#include "circular_vector.h"
+#include "concurrent_circular_vector.h"
+#include "circular_vector_pool.h"
+#include "small_circular_vector.h"
+#include "static_circular_vector.h"
+#include "mapped_circular_vector.h"
+#include "mirrored_circular_vector.h"
+#include "circular_vector_io.h"
+#include "circular_vector_stats.h"
+#include "circular_vector_window.h"
+#include "circular_vector_parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+typedef circular_vector<int, std::allocator<int>, circular_modulo_index> modulo_vector;
+typedef circular_vector<int, std::allocator<int>, circular_pow2_index>   pow2_vector;
+
+// Prevents the optimizer from discarding benchmarked work
+volatile long long g_sink;
+
+void BenchIndexPolicies();
+void BenchIteratorAlgorithms();
+void BenchEmplace();
+void BenchTrivialCopy();
+void BenchBulkMethods();
+void BenchSpsc();
+void BenchMpmc();
+void BenchInsertErase();
+void BenchShrink();
+void BenchGrowthPolicies();
+void BenchGrowthPlacement();
+void BenchPoolAllocator();
+void BenchSmallVector();
+void BenchStaticVector();
+void BenchMappedVector();
+void BenchMirroredVector();
+void BenchSerialization();
+void BenchStats();
+void BenchSimdAlgorithms();
+void BenchWindow();
+void BenchParallel();
+
+int main() {
+
+  BenchIndexPolicies();
+
+  BenchIteratorAlgorithms();
+
+  BenchEmplace();
+
+  BenchTrivialCopy();
+
+  BenchBulkMethods();
+
+  BenchSpsc();
+
+  BenchMpmc();
+
+  BenchInsertErase();
+
+  BenchShrink();
+
+  BenchGrowthPolicies();
+
+  BenchGrowthPlacement();
+
+  BenchPoolAllocator();
+
+  BenchSmallVector();
+
+  BenchStaticVector();
+
+  BenchMappedVector();
+
+  BenchMirroredVector();
+
+  BenchSerialization();
+
+  BenchStats();
+
+  BenchSimdAlgorithms();
+
+  BenchWindow();
+
+  BenchParallel();
+}
+
+// A 40 byte market event as built on an ingest path
+struct MarketEvent {
+  long long timestamp;
+  double price;
+  long long quantity;
+  char symbol[16];
+  MarketEvent(long long t, double p, long long q, const char *s)
+    : timestamp(t), price(p), quantity(q) {
+    std::copy(s, s + sizeof(symbol), symbol);
+  }
+};
+
+// Runs @a f and returns the average nanoseconds per operation
+template <typename F>
+double Time(F f, size_t ops) {
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  f();
+  std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() / ops;
+}
+
+void Report(const char *name, double modulo_ns, double pow2_ns) {
+  std::cout << name << ": modulo " << modulo_ns << " ns/op, pow2 "
+    << pow2_ns << " ns/op, speedup " << modulo_ns / pow2_ns << "x" << std::endl;
+}
+
+// Random access through operator[] on a wrapped %circular_vector
+template <typename Vector>
+double BenchRandomAccess(size_t n, size_t reads) {
+  Vector v(n);
+  for (size_t x = 0; x < n / 2; ++x) {
+    v.push_back(int(x));
+    v.push_front(int(x));
+  }
+  return Time([&] {
+    long long sum = 0;
+    size_t idx = 0;
+    for (size_t x = 0; x < reads; ++x) {
+      idx = (idx * 1103515245 + 12345) & (n - 1);
+      sum += v[idx];
+    }
+    g_sink = sum;
+  }, reads);
+}
+
+// Sequential access through operator[], the pattern of a simple indexed loop
+template <typename Vector>
+double BenchSequentialAccess(size_t n, size_t passes) {
+  Vector v(n);
+  for (size_t x = 0; x < n; ++x)
+    v.push_back(int(x));
+  return Time([&] {
+    long long sum = 0;
+    for (size_t pass = 0; pass < passes; ++pass)
+      for (size_t x = 0; x < n; ++x)
+        sum += v[x];
+    g_sink = sum;
+  }, n * passes);
+}
+
+// FIFO usage, push_back and pop_front on a %circular_vector with a fixed size
+template <typename Vector>
+double BenchFifo(size_t n, size_t ops) {
+  Vector v(n);
+  for (size_t x = 0; x < n / 2; ++x)
+    v.push_back(int(x));
+  return Time([&] {
+    for (size_t x = 0; x < ops; ++x) {
+      v.push_back(int(x));
+      v.pop_front();
+    }
+    g_sink = v.front();
+  }, ops);
+}
+
+void BenchIndexPolicies() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING INDEX POLICIES (MODULO VS POWER OF TWO)" << std::endl;
+
+  const size_t n = 1 << 16;
+  const size_t ops = 1 << 24;
+
+  Report("Random operator[]", BenchRandomAccess<modulo_vector>(n, ops),
+      BenchRandomAccess<pow2_vector>(n, ops));
+  Report("Sequential operator[]", BenchSequentialAccess<modulo_vector>(n, ops / n),
+      BenchSequentialAccess<pow2_vector>(n, ops / n));
+  Report("push_back/pop_front", BenchFifo<modulo_vector>(n, ops),
+      BenchFifo<pow2_vector>(n, ops));
+}
+
+void BenchIteratorAlgorithms() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING ITERATOR RANGE ALGORITHMS AGAINST STD::VECTOR" << std::endl;
+
+  const size_t n = 1 << 22;
+  const size_t passes = 8;
+
+  // Wrapped in the middle of the storage array
+  modulo_vector a(n), b(n);
+  std::vector<int> va, vb;
+  for (size_t x = 0; x < n; ++x) {
+    a.push_back(int(x));
+    b.push_back(int(x));
+    va.push_back(int(x));
+    vb.push_back(int(x));
+  }
+
+  double vector_ns = Time([&] {
+    long long sum = 0;
+    for (size_t pass = 0; pass < passes; ++pass)
+      sum += std::accumulate(va.begin(), va.end(), 0LL);
+    g_sink = sum;
+  }, n * passes);
+  double circular_ns = Time([&] {
+    long long sum = 0;
+    for (size_t pass = 0; pass < passes; ++pass)
+      sum += std::accumulate(a.begin(), a.end(), 0LL);
+    g_sink = sum;
+  }, n * passes);
+  std::cout << "std::accumulate: std::vector " << vector_ns << " ns/element, circular_vector "
+    << circular_ns << " ns/element" << std::endl;
+
+  vector_ns = Time([&] {
+    long long equal = 0;
+    for (size_t pass = 0; pass < passes; ++pass)
+      equal += std::equal(va.begin(), va.end(), vb.begin());
+    g_sink = equal;
+  }, n * passes);
+  circular_ns = Time([&] {
+    long long equal = 0;
+    for (size_t pass = 0; pass < passes; ++pass)
+      equal += std::equal(a.begin(), a.end(), b.begin());
+    g_sink = equal;
+  }, n * passes);
+  std::cout << "std::equal: std::vector " << vector_ns << " ns/element, circular_vector "
+    << circular_ns << " ns/element" << std::endl;
+}
+
+void BenchEmplace() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING PUSH_BACK OF A TEMPORARY AGAINST EMPLACE_BACK" << std::endl;
+
+  const size_t window = 1 << 12;
+  const size_t ops = 1 << 24;
+  const char symbol[16] = "ABCDEFGHIJKLMNO";
+
+  circular_vector<MarketEvent> events(window);
+  double push_ns = Time([&] {
+    for (size_t x = 0; x < ops; ++x) {
+      if (events.size() == window)
+        events.pop_front();
+      events.push_back(MarketEvent(x, x * 0.5, x & 1023, symbol));
+    }
+    g_sink = events.back().quantity;
+  }, ops);
+  events.clear();
+  double emplace_ns = Time([&] {
+    for (size_t x = 0; x < ops; ++x) {
+      if (events.size() == window)
+        events.pop_front();
+      events.emplace_back(x, x * 0.5, x & 1023, symbol);
+    }
+    g_sink = events.back().quantity;
+  }, ops);
+  std::cout << "MarketEvent (" << sizeof(MarketEvent) << " bytes): push_back " << push_ns
+    << " ns/op, emplace_back " << emplace_ns << " ns/op" << std::endl;
+}
+
+void BenchTrivialCopy() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING COPY AND GROWTH OF TRIVIALLY COPYABLE ELEMENTS" << std::endl;
+
+  const size_t n = 1 << 20;
+  const size_t passes = 32;
+
+  modulo_vector a(n);
+  std::vector<int> va;
+  for (size_t x = 0; x < n; ++x) {
+    a.push_back(int(x));
+    va.push_back(int(x));
+  }
+
+  double vector_ns = Time([&] {
+    for (size_t pass = 0; pass < passes; ++pass) {
+      std::vector<int> copy(va);
+      g_sink = copy.back();
+    }
+  }, passes);
+  double circular_ns = Time([&] {
+    for (size_t pass = 0; pass < passes; ++pass) {
+      modulo_vector copy(a);
+      g_sink = copy.back();
+    }
+  }, passes);
+  std::cout << "Copy of 1M ints: std::vector " << vector_ns / 1000 << " us, circular_vector "
+    << circular_ns / 1000 << " us" << std::endl;
+
+  circular_ns = Time([&] {
+    for (size_t pass = 0; pass < passes; ++pass) {
+      modulo_vector copy(a);
+      copy.reserve(2 * n);
+      g_sink = copy.back();
+    }
+  }, passes);
+  std::cout << "Copy and reserve(2n) of 1M ints: circular_vector " << circular_ns / 1000 << " us" << std::endl;
+}
+
+void BenchBulkMethods() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING BATCHED PRODUCER/CONSUMER, SINGLE VS BULK METHODS" << std::endl;
+
+  const size_t batch = 256;
+  const size_t batches = 1 << 16;
+  std::vector<int> input(batch, 7);
+
+  modulo_vector single(4 * batch);
+  double single_ns = Time([&] {
+    for (size_t x = 0; x < batches; ++x) {
+      for (size_t y = 0; y < batch; ++y)
+        single.push_back(input[y]);
+      for (size_t y = 0; y < batch; ++y)
+        single.pop_front();
+    }
+    g_sink = single.size();
+  }, batches * batch);
+
+  modulo_vector bulk(4 * batch);
+  double bulk_ns = Time([&] {
+    for (size_t x = 0; x < batches; ++x) {
+      bulk.push_back_n(input.data(), batch);
+      bulk.pop_front_n(batch);
+    }
+    g_sink = bulk.size();
+  }, batches * batch);
+  std::cout << "Batches of " << batch << " ints: push_back/pop_front " << single_ns
+    << " ns/element, push_back_n/pop_front_n " << bulk_ns << " ns/element" << std::endl;
+}
+
+// A %circular_vector FIFO shared between threads through a mutex
+class MutexQueue {
+  public:
+    explicit MutexQueue(size_t capacity) : queue_(capacity), capacity_(capacity) {}
+    bool try_push(int val) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (queue_.size() == capacity_)
+        return false;
+      queue_.push_back(val);
+      return true;
+    }
+    bool try_pop(int &val) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (queue_.empty())
+        return false;
+      val = queue_.front();
+      queue_.pop_front();
+      return true;
+    }
+  private:
+    std::mutex mutex_;
+    modulo_vector queue_;
+    size_t capacity_;
+};
+
+// Producer thread pushes @a ops ints while the calling thread pops them
+template <typename Queue>
+double BenchQueueThroughput(Queue &queue, size_t ops) {
+  return Time([&] {
+    std::thread producer([&] {
+      for (size_t x = 0; x < ops; ++x)
+        while (!queue.try_push(int(x)))
+          std::this_thread::yield();
+    });
+    long long sum = 0;
+    int val;
+    for (size_t x = 0; x < ops; ++x) {
+      while (!queue.try_pop(val))
+        std::this_thread::yield();
+      sum += val;
+    }
+    producer.join();
+    g_sink = sum;
+  }, ops);
+}
+
+// Round trip of a single element through a pair of queues
+template <typename Queue>
+double BenchQueueLatency(Queue &ping, Queue &pong, size_t trips) {
+  return Time([&] {
+    std::thread echo([&] {
+      int val;
+      for (size_t x = 0; x < trips; ++x) {
+        while (!ping.try_pop(val))
+          std::this_thread::yield();
+        while (!pong.try_push(val))
+          std::this_thread::yield();
+      }
+    });
+    int val = 0;
+    for (size_t x = 0; x < trips; ++x) {
+      while (!ping.try_push(int(x)))
+        std::this_thread::yield();
+      while (!pong.try_pop(val))
+        std::this_thread::yield();
+    }
+    echo.join();
+    g_sink = val;
+  }, trips);
+}
+
+void BenchSpsc() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING SPSC_CIRCULAR_VECTOR AGAINST A MUTEX WRAPPED CIRCULAR_VECTOR" << std::endl;
+
+  const size_t capacity = 1024;
+  const size_t ops = 1 << 22;
+  const size_t trips = 1 << 14;
+
+  MutexQueue mutex_queue(capacity);
+  spsc_circular_vector<int> spsc_queue(capacity);
+  double mutex_ns = BenchQueueThroughput(mutex_queue, ops);
+  double spsc_ns = BenchQueueThroughput(spsc_queue, ops);
+  std::cout << "Throughput: mutex " << 1e3 / mutex_ns << " Mops/s, spsc " << 1e3 / spsc_ns
+    << " Mops/s" << std::endl;
+
+  const size_t batch = 64;
+  spsc_ns = Time([&] {
+    std::thread producer([&] {
+      int input[batch];
+      for (size_t x = 0; x < ops;) {
+        for (size_t y = 0; y < batch; ++y)
+          input[y] = int(x + y);
+        size_t n = spsc_queue.try_push_n(input, std::min(batch, ops - x));
+        x += n;
+        if (n == 0)
+          std::this_thread::yield();
+      }
+    });
+    long long sum = 0;
+    int output[batch];
+    for (size_t x = 0; x < ops;) {
+      size_t n = spsc_queue.try_pop_n(output, batch);
+      for (size_t y = 0; y < n; ++y)
+        sum += output[y];
+      x += n;
+      if (n == 0)
+        std::this_thread::yield();
+    }
+    producer.join();
+    g_sink = sum;
+  }, ops);
+  std::cout << "Throughput, batches of " << batch << ": spsc " << 1e3 / spsc_ns << " Mops/s" << std::endl;
+
+  MutexQueue mutex_ping(capacity), mutex_pong(capacity);
+  spsc_circular_vector<int> spsc_ping(capacity), spsc_pong(capacity);
+  mutex_ns = BenchQueueLatency(mutex_ping, mutex_pong, trips);
+  spsc_ns = BenchQueueLatency(spsc_ping, spsc_pong, trips);
+  std::cout << "Round trip latency: mutex " << mutex_ns << " ns, spsc " << spsc_ns << " ns" << std::endl;
+}
+
+// @a threads producers push @a ops ints between them while @a threads consumers pop them
+template <typename Queue>
+double BenchQueueScaling(Queue &queue, size_t threads, size_t ops) {
+  const size_t share = ops / threads;
+  return Time([&] {
+    std::vector<std::thread> workers;
+    std::vector<long long> sums(threads);
+    for (size_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&queue, share] {
+        for (size_t x = 0; x < share; ++x)
+          while (!queue.try_push(int(x)))
+            std::this_thread::yield();
+      });
+      workers.emplace_back([&queue, &sums, share, t] {
+        int val;
+        for (size_t x = 0; x < share; ++x) {
+          while (!queue.try_pop(val))
+            std::this_thread::yield();
+          sums[t] += val;
+        }
+      });
+    }
+    for (size_t x = 0; x < workers.size(); ++x)
+      workers[x].join();
+    g_sink = std::accumulate(sums.begin(), sums.end(), 0LL);
+  }, share * threads);
+}
+
+void BenchMpmc() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING MPMC_CIRCULAR_VECTOR AGAINST A MUTEX WRAPPED CIRCULAR_VECTOR" << std::endl;
+
+  const size_t capacity = 1024;
+  const size_t ops = 1 << 21;
+  const size_t max_threads = std::max(2u, std::thread::hardware_concurrency());
+
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    MutexQueue mutex_queue(capacity);
+    mpmc_circular_vector<int> mpmc_queue(capacity);
+    double mutex_ns = BenchQueueScaling(mutex_queue, threads, ops);
+    double mpmc_ns = BenchQueueScaling(mpmc_queue, threads, ops);
+    std::cout << threads << " producers, " << threads << " consumers: mutex " << 1e3 / mutex_ns
+      << " Mops/s, mpmc " << 1e3 / mpmc_ns << " Mops/s" << std::endl;
+  }
+}
+
+// Inserts and erases an int at each of @a positions in turn, the size stays @a size
+template <typename Container>
+double BenchRandomInsertErase(size_t size, const std::vector<size_t> &positions) {
+  Container container(size, 1);
+  return Time([&] {
+    for (size_t x = 0; x < positions.size(); ++x) {
+      container.insert(container.begin() + positions[x], int(x));
+      container.erase(container.begin() + positions[positions.size() - 1 - x]);
+    }
+    g_sink = container.front();
+  }, positions.size() * 2);
+}
+
+void BenchInsertErase() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING INSERT/ERASE AT RANDOM POSITIONS AGAINST STD::VECTOR AND STD::DEQUE" << std::endl;
+
+  const size_t sizes[3] = {100, 10000, 100000};
+  const size_t ops = 1 << 14;
+  std::srand(1);
+  for (size_t s = 0; s < 3; ++s) {
+    std::vector<size_t> positions(ops);
+    for (size_t x = 0; x < ops; ++x)
+      positions[x] = std::rand() % sizes[s];
+    double vector_ns = BenchRandomInsertErase<std::vector<int> >(sizes[s], positions);
+    double deque_ns = BenchRandomInsertErase<std::deque<int> >(sizes[s], positions);
+    double circular_ns = BenchRandomInsertErase<circular_vector<int> >(sizes[s], positions);
+    std::cout << sizes[s] << " ints: vector " << vector_ns << " ns/op, deque " << deque_ns
+      << " ns/op, circular_vector " << circular_ns << " ns/op" << std::endl;
+  }
+}
+
+// Bursts to @a peak elements then drains back to @a floor, @a rounds times
+template <typename Container>
+double BenchBurstDrain(Container &container, size_t peak, size_t floor, size_t rounds) {
+  return Time([&] {
+    for (size_t r = 0; r < rounds; ++r) {
+      while (container.size() < peak)
+        container.push_back(int(r));
+      while (container.size() > floor)
+        container.pop_front();
+    }
+    g_sink = container.size();
+  }, rounds * (peak - floor) * 2);
+}
+
+void BenchShrink() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING SHRINK POLICIES ON BURSTS" << std::endl;
+
+  typedef circular_vector<int, std::allocator<int>, circular_modulo_index, circular_grow,
+    circular_shrink_hysteresis<> > shrinking_vector;
+  const size_t peak = 1 << 20;
+  const size_t floor = 1000;
+  const size_t rounds = 8;
+  modulo_vector never;
+  shrinking_vector hysteresis;
+  double never_ns = BenchBurstDrain(never, peak, floor, rounds);
+  double hysteresis_ns = BenchBurstDrain(hysteresis, peak, floor, rounds);
+  std::cout << "Bursts to " << peak << " ints, drained to " << floor << ": never shrink "
+    << never_ns << " ns/op, " << never.capacity() * sizeof(int) << " bytes held; hysteresis "
+    << hysteresis_ns << " ns/op, " << hysteresis.capacity() * sizeof(int) << " bytes held, "
+    << hysteresis.shrink_policy().shrink_count() << " shrinks, "
+    << hysteresis.shrink_policy().bytes_reclaimed() << " bytes reclaimed" << std::endl;
+}
+
+// Live and peak bytes allocated through CountingAllocator
+size_t g_live_bytes;
+size_t g_peak_bytes;
+
+// std::allocator that tracks the bytes it has handed out
+template <typename T>
+struct CountingAllocator : std::allocator<T> {
+  template <typename U>
+  struct rebind { typedef CountingAllocator<U> other; };
+  CountingAllocator() {}
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U> &) {}
+  T *allocate(size_t n) {
+    g_live_bytes += n * sizeof(T);
+    g_peak_bytes = std::max(g_peak_bytes, g_live_bytes);
+    return std::allocator<T>::allocate(n);
+  }
+  void deallocate(T *p, size_t n) {
+    g_live_bytes -= n * sizeof(T);
+    std::allocator<T>::deallocate(p, n);
+  }
+};
+
+// Pushes @a n ints in a child process and reports the reallocations, the bytes they
+// copied, the peak bytes allocated and the child's peak resident set size
+template <typename Container>
+void ReportGrowth(const char *name, size_t n) {
+  std::cout.flush();
+  pid_t child = fork();
+  if (child == 0) {
+    g_live_bytes = 0;
+    g_peak_bytes = 0;
+    size_t reallocations = 0, bytes_copied = 0;
+    Container container;
+    double ns = Time([&] {
+      for (size_t x = 0; x < n; ++x) {
+        size_t capacity = container.capacity();
+        container.push_back(int(x));
+        if (container.capacity() != capacity) {
+          ++reallocations;
+          bytes_copied += (container.size() - 1) * sizeof(int);
+        }
+      }
+    }, n);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << name << ": " << ns << " ns/push, " << reallocations << " reallocations, "
+      << bytes_copied / (1 << 20) << " MiB copied, final capacity "
+      << container.capacity() * sizeof(int) / (1 << 20) << " MiB, peak allocated "
+      << g_peak_bytes / (1 << 20) << " MiB, peak RSS " << usage.ru_maxrss / 1024 << " MiB" << std::endl;
+    _exit(0);
+  }
+  waitpid(child, nullptr, 0);
+}
+
+void BenchGrowthPolicies() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING GROWTH POLICIES" << std::endl;
+
+  typedef CountingAllocator<int> counting;
+  const size_t n = 1 << 25;
+  ReportGrowth<circular_vector<int, counting> >("geometric 3/2", n);
+  ReportGrowth<circular_vector<int, counting, circular_pow2_index, circular_grow,
+    circular_never_shrink, circular_growth_geometric<2, 1> > >("geometric 2/1, pow2 index", n);
+  ReportGrowth<circular_vector<int, counting, circular_modulo_index, circular_grow,
+    circular_never_shrink, circular_growth_geometric<5, 4> > >("geometric 5/4", n);
+  ReportGrowth<circular_vector<int, counting, circular_modulo_index, circular_grow,
+    circular_never_shrink, circular_growth_additive<(1 << 22)> > >("additive 16 MiB", n);
+  ReportGrowth<circular_vector<int, counting, circular_modulo_index, circular_grow,
+    circular_never_shrink, circular_growth_page<4096> > >("geometric 3/2, page rounded", n);
+}
+
+// Grows from empty by @a n pushes at the back, or at the front when @a front
+template <typename Container>
+double BenchGrowingPushes(size_t n, bool front) {
+  Container container;
+  return Time([&] {
+    for (size_t x = 0; x < n; ++x) {
+      if (front)
+        container.push_front(int(x));
+      else
+        container.push_back(int(x));
+    }
+    g_sink = container.size() + container.is_linearized();
+  }, n);
+}
+
+void BenchGrowthPlacement() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING GROWTH WITH STD::ALLOCATOR AGAINST CIRCULAR_REALLOC_ALLOCATOR" << std::endl;
+
+  typedef circular_vector<int, circular_realloc_allocator<int> > realloc_vector;
+  const size_t sizes[3] = {1 << 10, 1 << 16, 1 << 24};
+  for (size_t s = 0; s < 3; ++s) {
+    const size_t rounds = (1 << 24) / sizes[s];
+    double std_back = 0, realloc_back = 0, std_front = 0, realloc_front = 0;
+    for (size_t r = 0; r < rounds; ++r) {
+      std_back += BenchGrowingPushes<modulo_vector>(sizes[s], false) / rounds;
+      realloc_back += BenchGrowingPushes<realloc_vector>(sizes[s], false) / rounds;
+      std_front += BenchGrowingPushes<modulo_vector>(sizes[s], true) / rounds;
+      realloc_front += BenchGrowingPushes<realloc_vector>(sizes[s], true) / rounds;
+    }
+    std::cout << "Growing to " << sizes[s] << " ints: push_back std " << std_back << " ns, realloc "
+      << realloc_back << " ns; push_front std " << std_front << " ns, realloc " << realloc_front
+      << " ns" << std::endl;
+  }
+}
+
+// Builds and destroys @a count short lived vectors, each growing to a size from
+// @a sizes and draining through its shrink policy, allocating from @a alloc
+template <typename Container, typename Alloc>
+double BenchShortLived(const Alloc &alloc, const std::vector<size_t> &sizes, size_t count) {
+  size_t ops = 0;
+  for (size_t x = 0; x < count; ++x)
+    ops += sizes[x % sizes.size()] * 2;
+  return Time([&] {
+    long long sum = 0;
+    for (size_t x = 0; x < count; ++x) {
+      Container container(alloc);
+      const size_t n = sizes[x % sizes.size()];
+      for (size_t y = 0; y < n; ++y)
+        container.push_back(int(y));
+      while (!container.empty()) {
+        sum += container.front();
+        container.pop_front();
+      }
+    }
+    g_sink = sum;
+  }, ops);
+}
+
+void BenchPoolAllocator() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING SHORT LIVED VECTORS WITH STD::ALLOCATOR AGAINST CIRCULAR_BLOCK_POOL" << std::endl;
+
+  typedef circular_vector<int, std::allocator<int>, circular_pow2_index, circular_grow,
+    circular_shrink_hysteresis<> > std_vector;
+  typedef circular_vector<int, circular_pool_allocator<int>, circular_pow2_index, circular_grow,
+    circular_shrink_hysteresis<> > pool_vector;
+  std::srand(11);
+  const size_t maxima[3] = {64, 1024, 16384};
+  for (size_t m = 0; m < 3; ++m) {
+    std::vector<size_t> sizes(1024);
+    for (size_t x = 0; x < sizes.size(); ++x)
+      sizes[x] = 1 + std::rand() % maxima[m];
+    const size_t count = (size_t(1) << 24) / maxima[m];
+    circular_block_pool pool;
+    double std_ns = BenchShortLived<std_vector>(std::allocator<int>(), sizes, count);
+    double pool_ns = BenchShortLived<pool_vector>(circular_pool_allocator<int>(pool), sizes, count);
+    std::cout << "Vectors of up to " << maxima[m] << " ints: std " << std_ns << " ns, pool "
+      << pool_ns << " ns";
+#ifdef CIRCULAR_VECTOR_POOL_HAS_PMR
+    typedef pmr_circular_vector<int, circular_pow2_index, circular_grow,
+      circular_shrink_hysteresis<> > pmr_vector;
+    circular_pool_resource resource;
+    std::pmr::unsynchronized_pool_resource std_resource;
+    double resource_ns = BenchShortLived<pmr_vector>(std::pmr::polymorphic_allocator<int>(&resource), sizes, count);
+    double std_resource_ns = BenchShortLived<pmr_vector>(std::pmr::polymorphic_allocator<int>(&std_resource), sizes, count);
+    std::cout << ", pmr pool resource " << resource_ns << " ns, pmr unsynchronized_pool_resource "
+      << std_resource_ns << " ns";
+#endif
+    std::cout << " per element; pool recycled " << pool.recycled_allocations() << " of "
+      << pool.recycled_allocations() + pool.upstream_allocations() << " allocations" << std::endl;
+  }
+}
+
+// Counts the hardware cache misses of this thread with perf_event_open
+//   Falls back to counting nothing where perf events are unavailable, e.g. in
+//   containers or with perf_event_paranoid set, available() is then false.
+class CacheMissCounter {
+  public:
+    CacheMissCounter() {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof(attr);
+      attr.config = PERF_COUNT_HW_CACHE_MISSES;
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      fd_ = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    ~CacheMissCounter() {
+      if (fd_ >= 0)
+        close(fd_);
+    }
+    bool available() const { return fd_ >= 0; }
+    void start() {
+      if (fd_ < 0)
+        return;
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    // @return  The misses since start(), 0 without perf events
+    long long stop() {
+      long long count = 0;
+      if (fd_ < 0)
+        return 0;
+      ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd_, &count, sizeof(count)) != sizeof(count))
+        return 0;
+      return count;
+    }
+
+  private:
+    int fd_;
+};
+
+// Builds, fills with @a n elements and destroys @a count containers
+template <typename Container>
+double BenchConstruction(size_t n, size_t count) {
+  return Time([&] {
+    long long sum = 0;
+    for (size_t x = 0; x < count; ++x) {
+      Container container;
+      for (size_t y = 0; y < n; ++y)
+        container.push_back(int(x + y));
+      sum += container.size();
+    }
+    g_sink = sum;
+  }, count);
+}
+
+// Keeps a history of the last 4 values in each of @a windows containers, one per
+// connection, each opened with a 64 byte name allocated alongside as connections
+// would be. Then reads the oldest and newest value of every window. Reports ns and
+// cache misses per window of the reads.
+template <typename Container>
+void BenchHistoryWindows(const char *name, size_t windows) {
+  std::vector<Container> history;
+  std::vector<std::string> names;
+  history.reserve(windows);
+  names.reserve(windows);
+  for (size_t x = 0; x < windows; ++x) {
+    history.emplace_back();
+    names.push_back(std::string(64, char('a' + x % 26)));
+  }
+  for (size_t round = 0; round < 6; ++round) {
+    for (size_t x = 0; x < windows; ++x) {
+      history[x].push_back(int(x + round));
+      if (history[x].size() > 4)
+        history[x].pop_front();
+    }
+  }
+  CacheMissCounter misses;
+  misses.start();
+  double ns = Time([&] {
+    long long sum = 0;
+    for (size_t x = 0; x < windows; ++x)
+      sum += history[x].back() + history[x].front();
+    g_sink = sum;
+  }, windows);
+  long long count = misses.stop();
+  std::cout << name << ": " << ns << " ns per window read";
+  if (misses.available())
+    std::cout << ", " << double(count) / windows << " cache misses per window";
+  else
+    std::cout << ", cache misses unavailable (no perf events)";
+  std::cout << std::endl;
+}
+
+void BenchSmallVector() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING SMALL_CIRCULAR_VECTOR AGAINST CIRCULAR_VECTOR" << std::endl;
+
+  const size_t count = 1 << 22;
+  for (size_t n = 2; n <= 16; n *= 2) {
+    std::cout << "Construct, push " << n << " and destroy: circular_vector "
+      << BenchConstruction<circular_vector<int> >(n, count) << " ns, small_circular_vector<int, 8> "
+      << BenchConstruction<small_circular_vector<int, 8> >(n, count) << " ns, std::vector "
+      << BenchConstruction<std::vector<int> >(n, count) << " ns" << std::endl;
+  }
+
+  const size_t windows = 1 << 20;
+  BenchHistoryWindows<circular_vector<int> >("1M circular_vector windows", windows);
+  BenchHistoryWindows<small_circular_vector<int, 4> >("1M small_circular_vector<int, 4> windows", windows);
+}
+
+// Half fills @a v then times @a ops push_back/pop_front pairs and @a ops random reads
+template <typename Vector>
+std::pair<double, double> BenchFixedRing(Vector &v, size_t ops) {
+  const size_t n = v.capacity();
+  for (size_t x = 0; x < n / 2; ++x)
+    v.push_back(int(x));
+  double fifo = Time([&] {
+    for (size_t x = 0; x < ops; ++x) {
+      v.push_back(int(x));
+      v.pop_front();
+    }
+    g_sink = v.front();
+  }, ops);
+  double reads = Time([&] {
+    long long sum = 0;
+    size_t idx = 0;
+    for (size_t x = 0; x < ops; ++x) {
+      idx = (idx * 1103515245 + 12345) % v.size();
+      sum += v[idx];
+    }
+    g_sink = sum;
+  }, ops);
+  return std::make_pair(fifo, reads);
+}
+
+void BenchStaticVector() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING STATIC_CIRCULAR_VECTOR AGAINST CIRCULAR_VECTOR" << std::endl;
+
+  const size_t ops = 1 << 24;
+  static static_circular_vector<int, 1024> static_pow2;
+  static static_circular_vector<int, 1000> static_odd;
+  pow2_vector dynamic_pow2(1024);
+  modulo_vector dynamic_odd(1000);
+  std::pair<double, double> results[4] = {
+    BenchFixedRing(static_pow2, ops), BenchFixedRing(dynamic_pow2, ops),
+    BenchFixedRing(static_odd, ops), BenchFixedRing(dynamic_odd, ops)};
+  std::cout << "Capacity 1024, push_back/pop_front: static " << results[0].first << " ns, circular_vector pow2 "
+    << results[1].first << " ns; random operator[]: static " << results[0].second << " ns, circular_vector pow2 "
+    << results[1].second << " ns" << std::endl;
+  std::cout << "Capacity 1000, push_back/pop_front: static " << results[2].first << " ns, circular_vector modulo "
+    << results[3].first << " ns; random operator[]: static " << results[2].second << " ns, circular_vector modulo "
+    << results[3].second << " ns" << std::endl;
+}
+
+void BenchMappedVector() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING MAPPED_CIRCULAR_VECTOR AGAINST ELEMENT WISE SERIALIZATION" << std::endl;
+
+  const char *dir = std::getenv("TMPDIR");
+  const std::string path = std::string(dir ? dir : "/tmp") + "/circular_vector_bench.ring";
+  const size_t n = 1 << 24;
+  std::remove(path.c_str());
+
+  // The journal kept in memory and written out one element at a time
+  circular_vector<long long> memory(n);
+  for (size_t x = 0; x < n; ++x)
+    memory.push_back((long long)x);
+  double write_ns = Time([&] {
+    std::ofstream out(path.c_str(), std::ios::binary);
+    for (size_t x = 0; x < memory.size(); ++x)
+      out.write(reinterpret_cast<const char *>(&memory[x]), sizeof(long long));
+  }, n);
+  double read_ns = Time([&] {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    circular_vector<long long> loaded(n);
+    long long val;
+    while (in.read(reinterpret_cast<char *>(&val), sizeof(val)))
+      loaded.push_back(val);
+    g_sink = loaded.size();
+  }, n);
+  std::remove(path.c_str());
+  std::cout << "Element wise: write " << write_ns << " ns, read back " << read_ns << " ns per element" << std::endl;
+
+  // The journal kept in the mapping, flushed with msync
+  double push_ns = Time([&] {
+    mapped_circular_vector<long long> journal(path, n);
+    for (size_t x = 0; x < n; ++x)
+      journal.push_back((long long)x);
+    journal.sync();
+  }, n);
+  double reopen_ns = Time([&] {
+    mapped_circular_vector<long long> journal(path);
+    g_sink = journal.size() + journal.back();
+  }, n);
+  double scan_ns = Time([&] {
+    mapped_circular_vector<long long> journal(path);
+    long long sum = 0;
+    for (size_t x = 0; x < journal.size(); ++x)
+      sum += journal[x];
+    g_sink = sum;
+  }, n);
+  std::remove(path.c_str());
+  std::cout << "Mapped: push and sync " << push_ns << " ns, reopen " << reopen_ns * n / 1000
+    << " us in total, reopen and scan " << scan_ns << " ns per element" << std::endl;
+}
+
+// Streams @a bytes through a byte ring in @a chunk sized pushes, and after each push
+// copies the newest @a window bytes out as a parser would, through @a copy_window
+template <typename Ring, typename CopyWindow>
+double BenchStreamWindows(Ring &ring, size_t bytes, size_t chunk, size_t window, CopyWindow copy_window) {
+  std::vector<char> input(chunk, 'x');
+  std::vector<char> out(window);
+  return Time([&] {
+    long long sum = 0;
+    for (size_t x = 0; x < bytes; x += chunk) {
+      ring.push_back_n(input.data(), chunk);
+      copy_window(ring, out.data(), window);
+      sum += out[window / 2];
+    }
+    g_sink = sum;
+  }, bytes / chunk);
+}
+
+void BenchMirroredVector() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING MIRRORED_CIRCULAR_VECTOR AGAINST CIRCULAR_VECTOR SPANS" << std::endl;
+
+  const size_t capacity = 1 << 20, bytes = size_t(1) << 31;
+  const size_t chunks[3] = {1000, 4093, 65521};
+  for (size_t c = 0; c < 3; ++c) {
+    const size_t chunk = chunks[c], window = chunk * 4;
+    circular_vector<char, std::allocator<char>, circular_pow2_index, circular_overwrite> spans(capacity);
+    mirrored_circular_vector<char, circular_overwrite> mirrored(capacity);
+    mirrored_circular_vector<char, circular_overwrite> fallback(capacity, false);
+    double spans_ns = BenchStreamWindows(spans, bytes, chunk, window,
+        [](decltype(spans) &ring, char *out, size_t n) {
+          // The newest n bytes may straddle the seam, copied in up to two pieces
+          n = std::min(n, ring.size());
+          circular_vector<char, std::allocator<char>, circular_pow2_index, circular_overwrite>::array_range
+            one = ring.array_one(), two = ring.array_two();
+          const size_t skip = ring.size() - n;
+          if (skip < one.second) {
+            const size_t first = std::min(n, one.second - skip);
+            std::memcpy(out, one.first + skip, first);
+            std::memcpy(out + first, two.first, n - first);
+          } else {
+            std::memcpy(out, two.first + (skip - one.second), n);
+          }
+        });
+    auto contiguous = [](mirrored_circular_vector<char, circular_overwrite> &ring, char *out, size_t n) {
+      n = std::min(n, ring.size());
+      std::memcpy(out, ring.data() + ring.size() - n, n);
+    };
+    double mirrored_ns = BenchStreamWindows(mirrored, bytes, chunk, window, contiguous);
+    double fallback_ns = BenchStreamWindows(fallback, bytes, chunk, window, contiguous);
+    std::cout << "Pushes of " << chunk << " bytes, copying the newest " << window << ": spans " << spans_ns
+      << " ns, double mapped " << mirrored_ns << " ns, fallback " << fallback_ns << " ns per push" << std::endl;
+  }
+}
+
+void BenchSerialization() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING CIRCULAR_VECTOR SERIALIZATION AGAINST ELEMENT WISE STREAMS" << std::endl;
+
+  const char *dir = std::getenv("TMPDIR");
+  const std::string path = std::string(dir ? dir : "/tmp") + "/circular_vector_bench.bin";
+  const size_t n = size_t(1) << 26;  // 512MB of elements, wrapped at the middle
+  circular_vector<long long> snapshot(n);
+  for (size_t x = 0; x < n + n / 2; ++x) {
+    if (snapshot.size() == n)
+      snapshot.pop_front();
+    snapshot.push_back((long long)x);
+  }
+
+  double write_ns = Time([&] {
+    std::ofstream out(path.c_str(), std::ios::binary);
+    for (size_t x = 0; x < snapshot.size(); ++x)
+      out.write(reinterpret_cast<const char *>(&snapshot[x]), sizeof(long long));
+  }, n);
+  double read_ns = Time([&] {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    circular_vector<long long> loaded(n);
+    long long val;
+    while (in.read(reinterpret_cast<char *>(&val), sizeof(val)))
+      loaded.push_back(val);
+    g_sink = loaded.size();
+  }, n);
+  std::cout << "Element wise: write " << write_ns * n / 1e6 << " ms, read " << read_ns * n / 1e6 << " ms" << std::endl;
+
+  double stream_write_ns = Time([&] {
+    std::ofstream out(path.c_str(), std::ios::binary);
+    write_circular_vector(out, snapshot);
+  }, n);
+  double stream_read_ns = Time([&] {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    circular_vector<long long> loaded;
+    read_circular_vector(in, loaded);
+    g_sink = loaded.size();
+  }, n);
+  std::cout << "Stream runs: write " << stream_write_ns * n / 1e6 << " ms, read " << stream_read_ns * n / 1e6
+    << " ms" << std::endl;
+
+  double fd_write_ns = Time([&] {
+    const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    write_circular_vector(fd, snapshot);
+    close(fd);
+  }, n);
+  double fd_read_ns = Time([&] {
+    const int fd = open(path.c_str(), O_RDONLY);
+    circular_vector<long long> loaded;
+    read_circular_vector(fd, loaded);
+    close(fd);
+    g_sink = loaded.size();
+  }, n);
+  std::remove(path.c_str());
+  std::cout << "writev/readv: write " << fd_write_ns * n / 1e6 << " ms, read " << fd_read_ns * n / 1e6
+    << " ms, speedup " << (write_ns + read_ns) / (fd_write_ns + fd_read_ns) << "x" << std::endl;
+}
+
+void BenchStats() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING THE STATISTICS POLICY" << std::endl;
+
+  typedef circular_vector<int, std::allocator<int>, circular_modulo_index, circular_grow,
+          circular_never_shrink, circular_growth_geometric<>, circular_stats> stats_vector;
+  const size_t n = 1 << 16;
+  const size_t ops = 1 << 26;
+  std::cout << "push_back/pop_front: circular_no_stats " << BenchFifo<modulo_vector>(n, ops)
+    << " ns/op, circular_stats " << BenchFifo<stats_vector>(n, ops) << " ns/op" << std::endl;
+  std::cout << "Random operator[]: circular_no_stats " << BenchRandomAccess<modulo_vector>(n, ops)
+    << " ns/op, circular_stats " << BenchRandomAccess<stats_vector>(n, ops) << " ns/op" << std::endl;
+}
+
+// Times each algorithm through the iterators against the kernel of circular_vector_simd.h
+// on a wrapped %circular_vector of @a n elements of type @a T
+template <typename T>
+void BenchSimdType(const char *type, size_t n, size_t passes) {
+  circular_vector<T> a(n), b(n);
+  for (size_t x = 0; x < n + n / 2; ++x) {
+    if (a.size() == n) {
+      a.pop_front();
+      b.pop_front();
+    }
+    a.push_back(T(x % 1000));
+    b.push_back(T(x % 1000));
+  }
+  const T missing = T(5000);
+  double iter_ns[5], simd_ns[5];
+  iter_ns[0] = Time([&] {
+    long long sum = 0;
+    for (size_t pass = 0; pass < passes; ++pass)
+      sum += (long long)std::accumulate(a.begin(), a.end(), T(0));
+    g_sink = sum;
+  }, n * passes);
+  simd_ns[0] = Time([&] {
+    long long sum = 0;
+    for (size_t pass = 0; pass < passes; ++pass)
+      sum += (long long)circular_accumulate(a, T(0));
+    g_sink = sum;
+  }, n * passes);
+  iter_ns[1] = Time([&] {
+    long long sum = 0;
+    for (size_t pass = 0; pass < passes; ++pass)
+      sum += (long long)*std::max_element(a.begin(), a.end());
+    g_sink = sum;
+  }, n * passes);
+  simd_ns[1] = Time([&] {
+    long long sum = 0;
+    for (size_t pass = 0; pass < passes; ++pass)
+      sum += (long long)circular_minmax(a).second;
+    g_sink = sum;
+  }, n * passes);
+  iter_ns[2] = Time([&] {
+    long long sum = 0;
+    for (size_t pass = 0; pass < passes; ++pass)
+      sum += std::find(a.begin(), a.end(), missing) - a.begin();
+    g_sink = sum;
+  }, n * passes);
+  simd_ns[2] = Time([&] {
+    long long sum = 0;
+    for (size_t pass = 0; pass < passes; ++pass)
+      sum += circular_find(a, missing) - a.begin();
+    g_sink = sum;
+  }, n * passes);
+  iter_ns[3] = Time([&] {
+    long long sum = 0;
+    for (size_t pass = 0; pass < passes; ++pass)
+      sum += std::count(a.begin(), a.end(), T(7));
+    g_sink = sum;
+  }, n * passes);
+  simd_ns[3] = Time([&] {
+    long long sum = 0;
+    for (size_t pass = 0; pass < passes; ++pass)
+      sum += (long long)circular_count(a, T(7));
+    g_sink = sum;
+  }, n * passes);
+  iter_ns[4] = Time([&] {
+    long long sum = 0;
+    for (size_t pass = 0; pass < passes; ++pass)
+      sum += std::equal(a.begin(), a.end(), b.begin());
+    g_sink = sum;
+  }, n * passes);
+  simd_ns[4] = Time([&] {
+    long long sum = 0;
+    for (size_t pass = 0; pass < passes; ++pass)
+      sum += a == b;
+    g_sink = sum;
+  }, n * passes);
+  const char *names[5] = {"accumulate", "max", "find", "count", "equal"};
+  for (int x = 0; x < 5; ++x)
+    std::cout << type << " " << names[x] << ": iterators " << iter_ns[x] << " ns, runs "
+      << simd_ns[x] << " ns per element, speedup " << iter_ns[x] / simd_ns[x] << "x" << std::endl;
+}
+
+void BenchSimdAlgorithms() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING SIMD ALGORITHMS AGAINST ITERATOR ALGORITHMS"
+    << (circular_simd_has_avx2() ? " (AVX2)" : "") << std::endl;
+
+  const size_t n = 1 << 16;
+  const size_t passes = 256;
+  BenchSimdType<int>("int", n, passes);
+  BenchSimdType<short>("short", n, passes);
+  BenchSimdType<double>("double", n, passes);
+}
+
+// One tick of a time window: push_back a sample, pop_front the oldest, then read the
+// mean, variance, minimum and maximum
+void BenchWindow() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING SLIDING WINDOW AGGREGATES AGAINST RECOMPUTING" << std::endl;
+
+  for (size_t n = 64; n <= 16384; n *= 16) {
+    const size_t ticks = (size_t(1) << 28) / n;
+    std::vector<double> samples(4096);
+    for (size_t x = 0; x < samples.size(); ++x)
+      samples[x] = 100 + rand() % 10000 / 100.0;
+
+    circular_vector<double> window(n);
+    for (size_t x = 0; x < n; ++x)
+      window.push_back(samples[x % samples.size()]);
+    const double recompute_ns = Time([&] {
+      double total = 0;
+      for (size_t x = 0; x < ticks; ++x) {
+        window.pop_front();
+        window.push_back(samples[x % samples.size()]);
+        double sum = 0, squares = 0, low = window[0], high = window[0];
+        for (size_t y = 0; y < window.size(); ++y) {
+          sum += window[y];
+          squares += window[y] * window[y];
+          low = std::min(low, window[y]);
+          high = std::max(high, window[y]);
+        }
+        const double mean = sum / n;
+        total += mean + (squares / n - mean * mean) + low + high;
+      }
+      g_sink = (long long)total;
+    }, ticks);
+
+    circular_window_stats<double> stats(n);
+    for (size_t x = 0; x < n; ++x)
+      stats.push_back(samples[x % samples.size()]);
+    const size_t incremental_ticks = ticks * 16;
+    const double incremental_ns = Time([&] {
+      double total = 0;
+      for (size_t x = 0; x < incremental_ticks; ++x) {
+        stats.push_back(samples[x % samples.size()]);
+        total += stats.mean() + stats.variance() + stats.min() + stats.max();
+      }
+      g_sink = (long long)total;
+    }, incremental_ticks);
+    std::cout << "Window of " << n << ": recompute " << recompute_ns << " ns/tick, circular_window_stats "
+      << incremental_ns << " ns/tick, speedup " << recompute_ns / incremental_ns << "x" << std::endl;
+  }
+}
+
+// for_each, reduce and sort on a wrapped %circular_vector of 16M doubles, through the
+// iterators and then on 1, 2, 4... threads up to the hardware threads
+void BenchParallel() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "BENCHMARKING PARALLEL ALGORITHMS ON "
+    << std::thread::hardware_concurrency() << " HARDWARE THREADS" << std::endl;
+
+  const size_t n = 1 << 24;
+  circular_vector<double> v(n);
+  for (size_t x = 0; x < n + n / 2; ++x) {
+    if (v.full())
+      v.pop_front();
+    v.push_back(double((x * 7919) % 1000003));
+  }
+  const circular_vector<double> unsorted(v);
+  // Enough arithmetic per element that the scan is not bound by memory bandwidth
+  auto work = [](double &x) {
+    for (int y = 0; y < 8; ++y)
+      x = x * 0.999 + 1.0 / (x + 1.0);
+  };
+
+  const double each_ns = Time([&] { std::for_each(v.begin(), v.end(), work); }, n);
+  const double reduce_ns = Time([&] { g_sink = (long long)std::accumulate(v.begin(), v.end(), 0.0); }, n);
+  v = unsorted;
+  const double sort_ns = Time([&] { std::sort(v.begin(), v.end()); }, n);
+  std::cout << "Iterators: for_each " << each_ns << " ns, reduce " << reduce_ns
+    << " ns, sort " << sort_ns << " ns per element" << std::endl;
+
+  const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+  for (size_t threads = 1; ; threads = std::min(threads * 2, hardware)) {
+    circular_thread_pool pool(threads);
+    const circular_parallel_policy par = circular_par(pool);
+    const double par_each_ns = Time([&] { circular_for_each(par, v, work); }, n);
+    const double par_reduce_ns = Time([&] { g_sink = (long long)circular_reduce(par, v, 0.0); }, n);
+    v = unsorted;
+    const double par_sort_ns = Time([&] { circular_sort(par, v); }, n);
+    std::cout << threads << " threads: for_each " << par_each_ns << " ns (" << each_ns / par_each_ns
+      << "x), reduce " << par_reduce_ns << " ns (" << reduce_ns / par_reduce_ns
+      << "x), sort " << par_sort_ns << " ns (" << sort_ns / par_sort_ns << "x)" << std::endl;
+    if (threads == hardware)
+      break;
+  }
+}
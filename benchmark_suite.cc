@@ -0,0 +1,588 @@
+/* ---------------------------------------------------------------------------
+** This software is in the public domain, furnished "as is", without technical
+** support, and with no warranty, express or implied, as to its usefulness for
+** any purpose.
+**
+** benchmark_suite.cc
+** A regression suite in the style of Google Benchmark. Measures circular_vector
+** against std::vector, std::deque and a hand rolled ring buffer over a matrix of
+** access patterns, element sizes and container sizes, and reports the results
+** for a terminal, or as JSON or CSV to compare between runs.
+**
+**   ./benchmark_suite [--filter=REGEX] [--format=console|json|csv]
+**                     [--min_time=SECONDS] [--out=FILE] [--list]
+**
+** Author: Konrad Janica
+** -------------------------------------------------------------------------*/
+
+#include "circular_vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Prevents the optimizer from discarding benchmarked work
+volatile long long g_sink;
+
+// An element of @a N bytes
+template <size_t N>
+struct Blob {
+  unsigned char bytes[N];
+};
+
+// @return  An element with every byte set to @a x
+template <typename T>
+T MakeElement(size_t x) {
+  T val;
+  std::memset(val.bytes, int(x & 0xFF), sizeof(val.bytes));
+  return val;
+}
+
+// The baseline ring buffer as written by hand: a fixed power of two capacity,
+// unchecked pushes and a mask on every access.
+template <typename T>
+class HandRing {
+  public:
+    typedef T value_type;
+
+    explicit HandRing(size_t capacity) : array_(RoundUp(capacity)), mask_(array_.size() - 1),
+      head_(0), size_(0) {}
+
+    size_t size() const { return size_; }
+    void clear() { head_ = size_ = 0; }
+    T &operator[](size_t n) { return array_[(head_ + n) & mask_]; }
+    const T &operator[](size_t n) const { return array_[(head_ + n) & mask_]; }
+    T &back() { return (*this)[size_ - 1]; }
+    void push_back(const T &val) { array_[(head_ + size_++) & mask_] = val; }
+    void push_front(const T &val) {
+      head_ = (head_ - 1) & mask_;
+      array_[head_] = val;
+      ++size_;
+    }
+    void pop_back() { --size_; }
+    void pop_front() {
+      head_ = (head_ + 1) & mask_;
+      --size_;
+    }
+
+    // Calls @a f with each element, front to back, as the two contiguous runs
+    template <typename F>
+    void for_each(F f) const {
+      const size_t one = std::min(size_, array_.size() - head_);
+      for (const T *p = array_.data() + head_, *last = p + one; p != last; ++p)
+        f(*p);
+      for (const T *p = array_.data(), *last = p + (size_ - one); p != last; ++p)
+        f(*p);
+    }
+
+  private:
+    static size_t RoundUp(size_t n) {
+      size_t capacity = 1;
+      while (capacity < n)
+        capacity <<= 1;
+      return capacity;
+    }
+
+    std::vector<T> array_;
+    size_t mask_;
+    size_t head_;
+    size_t size_;
+};
+
+// How to build each container with room for @a n elements, and whether it has
+// push_front and pop_front
+template <typename C> struct SuiteTraits;
+template <typename T>
+struct SuiteTraits<circular_vector<T> > {
+  static const bool kFront = true;
+  static const char *name() { return "circular_vector"; }
+  static circular_vector<T> make(size_t n) { return circular_vector<T>(n); }
+};
+template <typename T>
+struct SuiteTraits<std::vector<T> > {
+  static const bool kFront = false;
+  static const char *name() { return "std::vector"; }
+  static std::vector<T> make(size_t n) {
+    std::vector<T> v;
+    v.reserve(n);
+    return v;
+  }
+};
+template <typename T>
+struct SuiteTraits<std::deque<T> > {
+  static const bool kFront = true;
+  static const char *name() { return "std::deque"; }
+  static std::deque<T> make(size_t) { return std::deque<T>(); }
+};
+template <typename T>
+struct SuiteTraits<HandRing<T> > {
+  static const bool kFront = true;
+  static const char *name() { return "hand_ring"; }
+  static HandRing<T> make(size_t n) { return HandRing<T>(n); }
+};
+
+// @return  The sum of the first byte of every element of @a c, iterating as its users would
+template <typename C>
+long long SumAll(const C &c) {
+  long long sum = 0;
+  for (typename C::const_iterator it = c.begin(); it != c.end(); ++it)
+    sum += it->bytes[0];
+  return sum;
+}
+template <typename T>
+long long SumAll(const HandRing<T> &c) {
+  long long sum = 0;
+  c.for_each([&sum](const T &val) { sum += val.bytes[0]; });
+  return sum;
+}
+
+// @brief  Fills @a c with @a n elements, wrapped in the middle of the storage when
+//         the container has pop_front
+template <typename C>
+void Prefill(C &c, size_t n, std::true_type) {
+  typedef typename C::value_type T;
+  for (size_t x = 0; x < n; ++x)
+    c.push_back(MakeElement<T>(x));
+  for (size_t x = 0; x < n / 2; ++x) {
+    c.pop_front();
+    c.push_back(MakeElement<T>(x));
+  }
+}
+template <typename C>
+void Prefill(C &c, size_t n, std::false_type) {
+  typedef typename C::value_type T;
+  for (size_t x = 0; x < n; ++x)
+    c.push_back(MakeElement<T>(x));
+}
+template <typename C>
+void Prefill(C &c, size_t n) {
+  Prefill(c, n, std::integral_constant<bool, SuiteTraits<C>::kFront>());
+}
+
+// TIMING:
+// The state of one run of a benchmark, as in Google Benchmark the body sets up its
+// container, then loops while KeepRunning(). Only the loop is timed.
+class BenchState {
+  public:
+    explicit BenchState(size_t iterations) : iterations_(iterations), remaining_(iterations),
+      items_(0), started_(false) {}
+
+    bool KeepRunning() {
+      if (!started_) {
+        started_ = true;
+        start_ = std::chrono::steady_clock::now();
+      }
+      if (remaining_ > 0) {
+        --remaining_;
+        return true;
+      }
+      stop_ = std::chrono::steady_clock::now();
+      return false;
+    }
+
+    size_t iterations() const { return iterations_; }
+    double seconds() const { return std::chrono::duration<double>(stop_ - start_).count(); }
+    // The elements pushed, popped, read or copied, the unit of the reported time
+    void SetItemsProcessed(size_t items) { items_ = items; }
+    size_t items() const { return items_; }
+
+  private:
+    size_t iterations_;
+    size_t remaining_;
+    size_t items_;
+    bool started_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point stop_;
+};
+
+// PATTERNS:
+// Each iteration pushes @a n elements at the back then pops them all, a stack
+template <typename C>
+void BM_Lifo(BenchState &state, size_t n) {
+  typedef typename C::value_type T;
+  C c = SuiteTraits<C>::make(n);
+  const T val = MakeElement<T>(1);
+  long long sum = 0;
+  while (state.KeepRunning()) {
+    for (size_t x = 0; x < n; ++x)
+      c.push_back(val);
+    sum += c.back().bytes[0];
+    for (size_t x = 0; x < n; ++x)
+      c.pop_back();
+  }
+  g_sink = sum;
+  state.SetItemsProcessed(state.iterations() * n * 2);
+}
+
+// Each iteration reads one element at a pseudo random index of a full container
+template <typename C>
+void BM_Random(BenchState &state, size_t n) {
+  C c = SuiteTraits<C>::make(n);
+  Prefill(c, n);
+  long long sum = 0;
+  size_t idx = 0;
+  while (state.KeepRunning()) {
+    idx = (idx * 1103515245 + 12345) & (n - 1);
+    sum += c[idx].bytes[0];
+  }
+  g_sink = sum;
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Each iteration visits every element of a full container with its iterators
+template <typename C>
+void BM_Iterate(BenchState &state, size_t n) {
+  C c = SuiteTraits<C>::make(n);
+  Prefill(c, n);
+  long long sum = 0;
+  while (state.KeepRunning())
+    sum += SumAll(c);
+  g_sink = sum;
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Each iteration copy constructs a full container
+template <typename C>
+void BM_Copy(BenchState &state, size_t n) {
+  C c = SuiteTraits<C>::make(n);
+  Prefill(c, n);
+  long long sum = 0;
+  while (state.KeepRunning()) {
+    C copy(c);
+    sum += copy[n / 2].bytes[0];
+  }
+  g_sink = sum;
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Each iteration builds a container with room for @a n elements and fills it
+template <typename C>
+void BM_Reserve(BenchState &state, size_t n) {
+  typedef typename C::value_type T;
+  const T val = MakeElement<T>(1);
+  long long sum = 0;
+  while (state.KeepRunning()) {
+    C c = SuiteTraits<C>::make(n);
+    for (size_t x = 0; x < n; ++x)
+      c.push_back(val);
+    sum += c[n - 1].bytes[0];
+  }
+  g_sink = sum;
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Each iteration pushes one element at the back of a full queue and pops the front
+template <typename C>
+void BM_Fifo(BenchState &state, size_t n) {
+  typedef typename C::value_type T;
+  C c = SuiteTraits<C>::make(n);
+  Prefill(c, n);
+  const T val = MakeElement<T>(1);
+  while (state.KeepRunning()) {
+    c.push_back(val);
+    c.pop_front();
+  }
+  g_sink = c[0].bytes[0];
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Each iteration pushes @a n elements at the front then clears them
+template <typename C>
+void BM_PushFront(BenchState &state, size_t n) {
+  typedef typename C::value_type T;
+  C c = SuiteTraits<C>::make(n);
+  const T val = MakeElement<T>(1);
+  long long sum = 0;
+  while (state.KeepRunning()) {
+    for (size_t x = 0; x < n; ++x)
+      c.push_front(val);
+    sum += c[0].bytes[0];
+    c.clear();
+  }
+  g_sink = sum;
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Each iteration slides a full container by one element and reads the newest
+// kWindow elements through operator[], as a moving statistic would
+template <typename C>
+void BM_Window(BenchState &state, size_t n) {
+  typedef typename C::value_type T;
+  static const size_t kWindow = 16;
+  C c = SuiteTraits<C>::make(n);
+  Prefill(c, n);
+  const T val = MakeElement<T>(1);
+  long long sum = 0;
+  while (state.KeepRunning()) {
+    c.push_back(val);
+    c.pop_front();
+    for (size_t x = n - kWindow; x < n; ++x)
+      sum += c[x].bytes[0];
+  }
+  g_sink = sum;
+  state.SetItemsProcessed(state.iterations());
+}
+
+// REGISTRY:
+struct SuiteCase {
+  std::string name;
+  std::string pattern;
+  std::string container;
+  std::string level;
+  size_t element_bytes;
+  size_t elements;
+  std::function<void(BenchState &)> body;
+};
+
+struct SuiteResult {
+  const SuiteCase *bench;
+  size_t iterations;
+  double seconds;
+  size_t items;
+};
+
+// The container sizes, in bytes of elements, sized to stay in each level of the
+// memory hierarchy of a typical x86 core
+struct SuiteLevel {
+  const char *name;
+  size_t bytes;
+};
+static const SuiteLevel kSuiteLevels[] = {
+  {"L1", size_t(16) << 10}, {"L2", size_t(256) << 10}, {"L3", size_t(4) << 20}, {"DRAM", size_t(64) << 20}};
+
+void AddCase(std::vector<SuiteCase> &suite, const char *pattern, const char *container,
+    const SuiteLevel &level, size_t element_bytes, std::function<void(BenchState &)> body) {
+  SuiteCase bench;
+  std::ostringstream name;
+  name << pattern << "/" << container << "/" << element_bytes << "B/" << level.name;
+  bench.name = name.str();
+  bench.pattern = pattern;
+  bench.container = container;
+  bench.level = level.name;
+  bench.element_bytes = element_bytes;
+  bench.elements = level.bytes / element_bytes;
+  bench.body = body;
+  suite.push_back(bench);
+}
+
+// The patterns that need push_front and pop_front
+template <typename C>
+void RegisterFront(std::vector<SuiteCase> &suite, const SuiteLevel &level, size_t n, std::true_type) {
+  const char *name = SuiteTraits<C>::name();
+  const size_t bytes = sizeof(typename C::value_type);
+  AddCase(suite, "fifo", name, level, bytes, [n](BenchState &s) { BM_Fifo<C>(s, n); });
+  AddCase(suite, "push_front", name, level, bytes, [n](BenchState &s) { BM_PushFront<C>(s, n); });
+  AddCase(suite, "window", name, level, bytes, [n](BenchState &s) { BM_Window<C>(s, n); });
+}
+template <typename C>
+void RegisterFront(std::vector<SuiteCase> &, const SuiteLevel &, size_t, std::false_type) {}
+
+template <typename C>
+void RegisterContainer(std::vector<SuiteCase> &suite) {
+  const char *name = SuiteTraits<C>::name();
+  const size_t bytes = sizeof(typename C::value_type);
+  for (size_t l = 0; l < sizeof(kSuiteLevels) / sizeof(kSuiteLevels[0]); ++l) {
+    const SuiteLevel &level = kSuiteLevels[l];
+    const size_t n = level.bytes / bytes;
+    AddCase(suite, "lifo", name, level, bytes, [n](BenchState &s) { BM_Lifo<C>(s, n); });
+    AddCase(suite, "random", name, level, bytes, [n](BenchState &s) { BM_Random<C>(s, n); });
+    AddCase(suite, "iterate", name, level, bytes, [n](BenchState &s) { BM_Iterate<C>(s, n); });
+    AddCase(suite, "copy", name, level, bytes, [n](BenchState &s) { BM_Copy<C>(s, n); });
+    AddCase(suite, "reserve", name, level, bytes, [n](BenchState &s) { BM_Reserve<C>(s, n); });
+    RegisterFront<C>(suite, level, n, std::integral_constant<bool, SuiteTraits<C>::kFront>());
+  }
+}
+
+template <typename T>
+void RegisterElement(std::vector<SuiteCase> &suite) {
+  RegisterContainer<circular_vector<T> >(suite);
+  RegisterContainer<std::vector<T> >(suite);
+  RegisterContainer<std::deque<T> >(suite);
+  RegisterContainer<HandRing<T> >(suite);
+}
+
+// RUNNING:
+// @brief  Runs @a bench with a growing iteration count until a run takes at least
+//         @a min_time seconds, as Google Benchmark does
+SuiteResult RunCase(const SuiteCase &bench, double min_time) {
+  static const size_t kMaxIterations = 1000000000;
+  size_t iterations = 1;
+  for (;;) {
+    BenchState state(iterations);
+    bench.body(state);
+    const double seconds = state.seconds();
+    if (seconds >= min_time || iterations >= kMaxIterations) {
+      SuiteResult result = {&bench, iterations, seconds, state.items()};
+      return result;
+    }
+    // Aim past min_time so the next run is very likely the last
+    double multiplier = seconds > 0 ? min_time * 1.4 / seconds : 10;
+    multiplier = std::min(10.0, std::max(multiplier, 1.0));
+    iterations = std::min(kMaxIterations, std::max(iterations + 1, size_t(double(iterations) * multiplier)));
+  }
+}
+
+double NsPerItem(const SuiteResult &r) { return r.seconds * 1e9 / double(r.items); }
+double ItemsPerSecond(const SuiteResult &r) { return double(r.items) / r.seconds; }
+double BytesPerSecond(const SuiteResult &r) { return ItemsPerSecond(r) * double(r.bench->element_bytes); }
+
+// REPORTING:
+void PrintConsoleHeader(std::ostream &os) {
+  char line[160];
+  std::snprintf(line, sizeof(line), "%-40s %12s %12s %14s %12s", "Benchmark", "Time/item",
+      "Iterations", "Items/s", "MB/s");
+  os << line << "\n" << std::string(94, '-') << std::endl;
+}
+void PrintConsole(std::ostream &os, const SuiteResult &r) {
+  char line[160];
+  std::snprintf(line, sizeof(line), "%-40s %9.3f ns %12zu %14.4g %12.1f", r.bench->name.c_str(),
+      NsPerItem(r), r.iterations, ItemsPerSecond(r), BytesPerSecond(r) / 1e6);
+  os << line << std::endl;
+}
+
+void PrintCsvHeader(std::ostream &os) {
+  os << "name,pattern,container,element_bytes,level,elements,iterations,ns_per_item,"
+    "items_per_second,bytes_per_second" << std::endl;
+}
+void PrintCsv(std::ostream &os, const SuiteResult &r) {
+  const SuiteCase &b = *r.bench;
+  os << b.name << "," << b.pattern << "," << b.container << "," << b.element_bytes << "," << b.level
+    << "," << b.elements << "," << r.iterations << "," << NsPerItem(r) << "," << ItemsPerSecond(r) << ","
+    << BytesPerSecond(r) << std::endl;
+}
+
+// The same layout as Google Benchmark's JSON reporter, a context object and an
+// array of benchmarks, so the same tools can compare two runs
+void PrintJsonHeader(std::ostream &os, double min_time) {
+  char date[64];
+  const std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+  os << "{\n  \"context\": {\n"
+    << "    \"date\": \"" << date << "\",\n"
+    << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+    << "    \"min_time\": " << min_time << ",\n"
+#ifdef NDEBUG
+    << "    \"library_build_type\": \"release\"\n"
+#else
+    << "    \"library_build_type\": \"debug\"\n"
+#endif
+    << "  },\n  \"benchmarks\": [";
+}
+void PrintJson(std::ostream &os, const SuiteResult &r, bool first) {
+  const SuiteCase &b = *r.bench;
+  os << (first ? "\n" : ",\n")
+    << "    {\n"
+    << "      \"name\": \"" << b.name << "\",\n"
+    << "      \"pattern\": \"" << b.pattern << "\",\n"
+    << "      \"container\": \"" << b.container << "\",\n"
+    << "      \"element_bytes\": " << b.element_bytes << ",\n"
+    << "      \"level\": \"" << b.level << "\",\n"
+    << "      \"elements\": " << b.elements << ",\n"
+    << "      \"iterations\": " << r.iterations << ",\n"
+    << "      \"real_time\": " << NsPerItem(r) << ",\n"
+    << "      \"time_unit\": \"ns\",\n"
+    << "      \"items_per_second\": " << ItemsPerSecond(r) << ",\n"
+    << "      \"bytes_per_second\": " << BytesPerSecond(r) << "\n"
+    << "    }";
+  os.flush();
+}
+void PrintJsonFooter(std::ostream &os) {
+  os << "\n  ]\n}" << std::endl;
+}
+
+void Usage(const char *program) {
+  std::cerr << "usage: " << program << " [--filter=REGEX] [--format=console|json|csv]"
+    " [--min_time=SECONDS] [--out=FILE] [--list]" << std::endl;
+}
+
+int main(int argc, char **argv) {
+  std::string filter = ".*", format = "console", out_path;
+  double min_time = 0.05;
+  bool list = false;
+  for (int x = 1; x < argc; ++x) {
+    const std::string arg = argv[x];
+    if (arg.compare(0, 9, "--filter=") == 0) {
+      filter = arg.substr(9);
+    } else if (arg.compare(0, 9, "--format=") == 0) {
+      format = arg.substr(9);
+    } else if (arg.compare(0, 11, "--min_time=") == 0) {
+      min_time = std::atof(arg.c_str() + 11);
+    } else if (arg.compare(0, 6, "--out=") == 0) {
+      out_path = arg.substr(6);
+    } else if (arg == "--list") {
+      list = true;
+    } else {
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+  if ((format != "console" && format != "json" && format != "csv") || !(min_time > 0)) {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  std::vector<SuiteCase> suite;
+  RegisterElement<Blob<4> >(suite);
+  RegisterElement<Blob<16> >(suite);
+  RegisterElement<Blob<64> >(suite);
+  RegisterElement<Blob<256> >(suite);
+
+  std::regex pattern;
+  try {
+    pattern = std::regex(filter);
+  } catch (const std::regex_error &) {
+    std::cerr << "invalid --filter regex: " << filter << std::endl;
+    return 1;
+  }
+  std::vector<const SuiteCase *> selected;
+  for (size_t x = 0; x < suite.size(); ++x)
+    if (std::regex_search(suite[x].name, pattern))
+      selected.push_back(&suite[x]);
+  if (list) {
+    for (size_t x = 0; x < selected.size(); ++x)
+      std::cout << selected[x]->name << std::endl;
+    return 0;
+  }
+
+  std::ofstream file;
+  if (!out_path.empty()) {
+    file.open(out_path.c_str());
+    if (!file) {
+      std::cerr << "cannot open " << out_path << std::endl;
+      return 1;
+    }
+  }
+  std::ostream &os = out_path.empty() ? std::cout : file;
+
+  if (format == "console")
+    PrintConsoleHeader(os);
+  else if (format == "csv")
+    PrintCsvHeader(os);
+  else
+    PrintJsonHeader(os, min_time);
+  for (size_t x = 0; x < selected.size(); ++x) {
+    const SuiteResult result = RunCase(*selected[x], min_time);
+    if (format == "console")
+      PrintConsole(os, result);
+    else if (format == "csv")
+      PrintCsv(os, result);
+    else
+      PrintJson(os, result, x == 0);
+  }
+  if (format == "json")
+    PrintJsonFooter(os);
+  return 0;
+}
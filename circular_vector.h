@@ -6,10 +6,11 @@
 ** circular_vector.h
 ** An STL-Compliant Circular Vector Container. Shares similarities to a Circular
 ** Buffer Data Structure, except allows access to all elements in the container.
-** Contains all the same member functions as C++98 std::vector from the STL,
-** except for vector::insert and vector::erase.
+** Contains all the same member functions as C++98 std::vector from the STL.
 ** Newly introduced member functions include: push_front and pop_front which
 ** unlike the counterpart operations in std::vector are O(1) time (Constant).
+** Like std::deque, insert and erase only shift the elements on the shorter
+** side of the position.
 **
 **
 ** Author: Konrad Janica
@@ -18,14 +19,228 @@
 #ifndef CIRCULAR_VECTOR_HPP_
 #define CIRCULAR_VECTOR_HPP_
 
-#include <algorithm> // std::swap, std::max, std::lexicographical_compare, std::equal
+#include <algorithm> // std::swap, std::max, std::min, std::rotate, std::move_backward, std::fill_n, std::lexicographical_compare, std::equal
+#include <cstddef>   // std::size_t, std::max_align_t, std::nullptr_t
+#include <cstdlib>   // std::malloc, std::realloc, std::free
+#include <cstring>   // std::memcpy, std::memmove
+#include <iterator>  // std::iterator_traits, std::distance, std::make_move_iterator
 #include <stdexcept> // std::invalid_argument, std::out_of_range
-#include <memory>    // std::allocator
+#include <memory>    // std::allocator, std::allocator_traits
+#include <new>       // std::bad_alloc
+#include <type_traits> // std::is_trivially_copyable, std::is_trivially_destructible, std::is_nothrow_default_constructible
+#include <utility>   // std::pair, std::move, std::move_if_noexcept, std::forward, std::declval
+
+#include "circular_vector_simd.h" // circular_equal, circular_lexicographical_compare
 
 // Forward declaration of iterator class
 template <typename _T_noconst, typename _T, typename _element_type = typename _T::value_type>
 class circular_vector_iterator;
 
+// Index wrapping policies
+//   Selects how a logical position is wrapped onto the storage array. Every
+//   element access and every push/pop goes through the selected policy.
+//   A policy provides:
+//     round_capacity(n)  - The capacity actually allocated for a request of @a n
+//     wrap(n, capacity)  - @a n in [0, 2 * capacity) mapped into [0, capacity)
+//     next(i, capacity)  - The index following @a i
+//     prev(i, capacity)  - The index preceding @a i
+
+// The default policy. Any capacity is allowed, wrapping uses the modulo operator.
+struct circular_modulo_index {
+  template <typename size_type>
+  static size_type round_capacity(size_type n)              { return n; }
+  template <typename size_type>
+  static size_type wrap(size_type n, size_type capacity)    { return n % capacity; }
+  template <typename size_type>
+  static size_type next(size_type i, size_type capacity)    { return (i + 1) % capacity; }
+  template <typename size_type>
+  static size_type prev(size_type i, size_type capacity)    { return i == 0 ? capacity - 1 : i - 1; }
+};
+
+// Capacity is always rounded up to a power of two so wrapping is a single
+//   bitwise and with (capacity - 1) instead of an integer division.
+//   reserve, resize and growth on push_back/push_front keep the invariant,
+//   so capacity() may be larger than requested.
+struct circular_pow2_index {
+  template <typename size_type>
+  static size_type round_capacity(size_type n) {
+    size_type capacity = 1;
+    while (capacity < n)
+      capacity <<= 1;
+    return capacity;
+  }
+  template <typename size_type>
+  static size_type wrap(size_type n, size_type capacity)    { return n & (capacity - 1); }
+  template <typename size_type>
+  static size_type next(size_type i, size_type capacity)    { return (i + 1) & (capacity - 1); }
+  template <typename size_type>
+  static size_type prev(size_type i, size_type capacity)    { return (i - 1) & (capacity - 1); }
+};
+
+// Full capacity policies
+//   Selects what adding an element to a full %circular_vector does.
+
+// The default policy. The storage is reallocated increasing its capacity.
+struct circular_grow {
+  static const bool overwrite = false;
+};
+
+// Ring buffer semantics. The capacity is fixed at construction and adding an element
+//   never allocates: push_back overwrites the first element and push_front overwrites
+//   the last element. Explicit reserve and resize calls still reallocate.
+struct circular_overwrite {
+  static const bool overwrite = true;
+};
+
+// Growth policies
+//   Selects the capacity a %circular_vector reallocates to when it grows, on a push
+//   to a full container, a bulk push or insert, or a reserve. The result is then
+//   rounded by the index policy.
+//   A policy provides:
+//     grow_capacity(capacity, required, element_size)  - The new capacity, at least
+//                                                        @a required and larger than
+//                                                        @a capacity
+
+// The default policy. Grows by the compile time ratio @a _Num / @a _Den, by at least
+//   one element, in integer arithmetic. e.g. circular_growth_geometric<2, 1> doubles,
+//   combined with circular_pow2_index every capacity is a power of two.
+template <std::size_t _Num = 3, std::size_t _Den = 2>
+struct circular_growth_geometric {
+  static_assert(_Den != 0 && _Num > _Den, "the growth ratio must be larger than 1");
+  template <typename size_type>
+  static size_type grow_capacity(size_type capacity, size_type required, size_type) {
+    // Divide first so large capacities do not overflow
+    const size_type grown = capacity / _Den * _Num + capacity % _Den * _Num / _Den;
+    return std::max(required, std::max<size_type>(grown, capacity + 1));
+  }
+};
+
+// Grows by a fixed @a _Chunk elements, limiting the memory held beyond size() for
+//   very large containers at the cost of O(n) amortized pushes.
+template <std::size_t _Chunk>
+struct circular_growth_additive {
+  static_assert(_Chunk != 0, "the growth chunk must not be empty");
+  template <typename size_type>
+  static size_type grow_capacity(size_type capacity, size_type required, size_type) {
+    return std::max<size_type>(required, capacity + _Chunk);
+  }
+};
+
+// Grows as @a _Base, then extends the storage to a whole number of @a _PageSize
+//   byte pages, so the tail of the last page allocated is used rather than wasted.
+template <std::size_t _PageSize = 4096, typename _Base = circular_growth_geometric<> >
+struct circular_growth_page {
+  template <typename size_type>
+  static size_type grow_capacity(size_type capacity, size_type required, size_type element_size) {
+    const size_type n = _Base::grow_capacity(capacity, required, element_size);
+    const size_type pages = (n * element_size + _PageSize - 1) / _PageSize;
+    return std::max<size_type>(n, pages * _PageSize / element_size);
+  }
+};
+
+// An allocator using malloc, realloc and free. %circular_vector detects its reallocate
+//   member and grows storage of trivially copyable elements with realloc, which can
+//   often extend the block in place instead of copying every element.
+template <typename _T>
+struct circular_realloc_allocator : std::allocator<_T> {
+  static_assert(alignof(_T) <= alignof(std::max_align_t), "over-aligned types need operator new");
+  template <typename _U>
+  struct rebind { typedef circular_realloc_allocator<_U> other; };
+  circular_realloc_allocator() noexcept {}
+  template <typename _U>
+  circular_realloc_allocator(const circular_realloc_allocator<_U> &) noexcept {}
+
+  _T *allocate(std::size_t n) {
+    void *p = std::malloc(n * sizeof(_T));
+    if (!p && n != 0)
+      throw std::bad_alloc();
+    return static_cast<_T *>(p);
+  }
+  void deallocate(_T *p, std::size_t) noexcept { std::free(p); }
+  // @brief  Resizes the block at @a p from @a old_n to @a n elements, keeping the bytes
+  //         of the first min(old_n, n) elements
+  // @return  The resized block, which may have moved
+  // @throws  std::bad_alloc  If the block cannot be resized, @a p is left unchanged
+  _T *reallocate(_T *p, std::size_t old_n, std::size_t n) {
+    (void)old_n;
+    void *resized = std::realloc(p, n * sizeof(_T));
+    if (!resized && n != 0)
+      throw std::bad_alloc();
+    return static_cast<_T *>(resized);
+  }
+};
+
+// Shrink policies
+//   Selects whether the %circular_vector gives memory back as elements are popped
+//   or erased. The policy is held by value so it may keep state. It stays with its
+//   %circular_vector: copies and moves start with a default constructed policy,
+//   swap and assignment keep each container's own.
+//   A policy provides:
+//     shrink_capacity(size, capacity)    - The capacity to shrink to after elements are
+//                                          removed, @a capacity keeps the storage
+//     reclaimed(old, new, element_size)  - Called after every reallocation to a smaller
+//                                          capacity, including shrink_to_fit()
+
+// The default policy. Capacity only shrinks on an explicit shrink_to_fit().
+struct circular_never_shrink {
+  template <typename size_type>
+  static size_type shrink_capacity(size_type, size_type capacity) { return capacity; }
+  template <typename size_type>
+  void reclaimed(size_type, size_type, size_type) {}
+};
+
+// Halves the capacity while fewer than 1 / @a _Below of it is used, down to
+//   @a _MinCapacity. The capacity left is 2 to @a _Below times the size, so the
+//   storage is not reallocated again by small changes in size after a shrink.
+//   Counts the reallocations to a smaller capacity and the memory they gave back.
+template <std::size_t _Below = 4, std::size_t _MinCapacity = 16>
+class circular_shrink_hysteresis {
+  public:
+    circular_shrink_hysteresis() noexcept : shrink_count_(0), bytes_reclaimed_(0) {}
+    template <typename size_type>
+    static size_type shrink_capacity(size_type size, size_type capacity) {
+      while (capacity > _MinCapacity && size * _Below < capacity)
+        capacity = std::max<size_type>(capacity / 2, _MinCapacity);
+      return capacity;
+    }
+    template <typename size_type>
+    void reclaimed(size_type old_capacity, size_type new_capacity, size_type element_size) {
+      ++shrink_count_;
+      bytes_reclaimed_ += (old_capacity - new_capacity) * element_size;
+    }
+    // @return  The number of reallocations to a smaller capacity
+    std::size_t shrink_count() const    { return shrink_count_; }
+    // @return  The total storage given back, in bytes
+    std::size_t bytes_reclaimed() const { return bytes_reclaimed_; }
+
+  private:
+    std::size_t shrink_count_;
+    std::size_t bytes_reclaimed_;
+};
+
+// Statistics policies
+//   Selects what a %circular_vector records about its use, read through stats(). Like
+//   the shrink policy it is held by value and stays with its %circular_vector.
+//   A policy provides:
+//     pushed(back, n, wrapped, size, capacity)  - After @a n elements are added at the
+//                                                 back or front, @a wrapped iff the
+//                                                 index crossed the end of the array
+//     popped(back, n, wrapped)                  - After @a n elements are removed
+//     reallocated(old, new, relocated)          - After the storage is replaced, or
+//                                                 grown in place, @a relocated elements
+//                                                 were moved
+//   See circular_vector_stats.h for circular_stats, which counts them.
+
+// The default policy. Records nothing, the calls compile away.
+struct circular_no_stats {
+  template <typename size_type>
+  void pushed(bool, size_type, bool, size_type, size_type) {}
+  template <typename size_type>
+  void popped(bool, size_type, bool) {}
+  template <typename size_type>
+  void reallocated(size_type, size_type, size_type) {}
+};
+
 // An STL Compliant Circular Vector Container
 //   This Data Structure is basically a centered wrapping vector with space at both sides
 //   to allow O(1) (constant time) insert/erase(front) as well as O(1) push_back and pop_back.
@@ -34,24 +249,45 @@ class circular_vector_iterator;
 //   As elements are added to the front and end, the start and end indices move
 //   accordingly.
 //   When capacity is reached, the storage container will reallocate its storage
-//   increasing its capacity to 1.5 * capacity.
+//   increasing its capacity, to 1.5 * capacity by default.
 //     Like vectors, this makes push_back and push_front amortized time O(1)
 //     per insertion.
 //   The Default Capacity should be larger than 1 otherwise a Circular Vector is
 //   pointless.
-template <typename _T, typename _Alloc = std::allocator<_T> >
+//   The index wrapping is selected with @a _Index, see circular_modulo_index
+//   (default) and circular_pow2_index.
+//   The behaviour when full is selected with @a _Overflow, see circular_grow
+//   (default) and circular_overwrite.
+//   Giving memory back as elements are removed is selected with @a _Shrink, see
+//   circular_never_shrink (default) and circular_shrink_hysteresis.
+//   The capacity to grow to is selected with @a _Growth, see circular_growth_geometric
+//   (default, 1.5 * capacity), circular_growth_additive and circular_growth_page.
+//   Usage statistics are recorded with @a _Stats, see circular_no_stats (default)
+//   and circular_stats.
+template <typename _T, typename _Alloc = std::allocator<_T>, typename _Index = circular_modulo_index,
+          typename _Overflow = circular_grow, typename _Shrink = circular_never_shrink,
+          typename _Growth = circular_growth_geometric<>, typename _Stats = circular_no_stats>
 class circular_vector {
   public:
     // TYPEDEFS:
-    typedef circular_vector<_T, _Alloc>           self_type;
+    typedef circular_vector<_T, _Alloc, _Index, _Overflow, _Shrink, _Growth, _Stats> self_type;
     typedef _Alloc                                allocator_type;
-    typedef typename _Alloc::value_type           value_type;
-    typedef typename _Alloc::pointer              pointer;
-    typedef typename _Alloc::const_pointer        const_pointer;
-    typedef typename _Alloc::reference            reference;
-    typedef typename _Alloc::const_reference      const_reference;
-    typedef typename _Alloc::size_type            size_type;
-    typedef typename _Alloc::difference_type      difference_type;
+    typedef _Index                                index_policy;
+    typedef _Overflow                             overflow_policy;
+    typedef _Shrink                               shrink_policy_type;
+    typedef _Growth                               growth_policy;
+    typedef _Stats                                stats_policy_type;
+    // Every allocator call goes through std::allocator_traits
+    typedef std::allocator_traits<_Alloc>         alloc_traits;
+    typedef typename alloc_traits::value_type     value_type;
+    typedef typename alloc_traits::pointer        pointer;
+    typedef typename alloc_traits::const_pointer  const_pointer;
+    typedef value_type &                          reference;
+    typedef const value_type &                    const_reference;
+    typedef typename alloc_traits::size_type      size_type;
+    typedef typename alloc_traits::difference_type difference_type;
+    static_assert(std::is_same<pointer, value_type *>::value,
+        "allocators with fancy pointers are not supported");
     // Iterator
     typedef circular_vector_iterator <self_type, self_type> 
       iterator;
@@ -62,6 +298,9 @@ class circular_vector {
     typedef std::reverse_iterator<iterator>       reverse_iterator;
     // Reverse Const Iterator
     typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+    // A contiguous run of elements in the storage array, (pointer, length)
+    typedef std::pair<pointer, size_type>         array_range;
+    typedef std::pair<const_pointer, size_type>   const_array_range;
 
     // CONSTANTS:
     static const size_type kDefaultCapacity = 5;
@@ -77,19 +316,26 @@ class circular_vector {
     // @param  capacity  The starting allocated storage reserve
     // @throws  std::invalid_argument  With negative capacity values
     explicit circular_vector(size_type capacity = kDefaultCapacity, const _Alloc &alloc = _Alloc())
-      : size_(0), capacity_(capacity), start_idx_(capacity/2), end_idx_(capacity/2),
-      alloc_(alloc), array_(alloc_.allocate(capacity)) {
+      : size_(0), capacity_(_Index::round_capacity(capacity)),
+      start_idx_(capacity_/2), end_idx_(capacity_/2),
+      alloc_(alloc), array_(alloc_traits::allocate(alloc_, capacity_)) {
         if (capacity <= 0) {
           throw std::invalid_argument("invalid capacity");
         }
       };
+    // @brief  Empty container constructor with kDefaultCapacity reserved space, allocated
+    //         from @a alloc. For allocators that cannot be default constructed.
+    // @param  alloc  The allocator to allocate storage with
+    explicit circular_vector(const _Alloc &alloc)
+      : circular_vector(kDefaultCapacity, alloc) {}
     // @brief  Fill constructor. Constructs a container with @a n elements. Each element is a copy of @a val.
     // @param  n    The size and capacity of the %circular_vector
     // @param  val  The data value to fill the %circular_vector
     // @throws  std::invalid_argument  With negative size values
     explicit circular_vector(size_type n, const value_type &val, const _Alloc &alloc = _Alloc())
-      : size_(0), capacity_(n), start_idx_(n/2), end_idx_(n/2),
-      alloc_(alloc), array_(alloc_.allocate(n)) {
+      : size_(0), capacity_(_Index::round_capacity(n)),
+      start_idx_(capacity_/2), end_idx_(capacity_/2),
+      alloc_(alloc), array_(alloc_traits::allocate(alloc_, capacity_)) {
         if (n <= 0) {
           throw std::invalid_argument("invalid capacity");
         }
@@ -102,58 +348,125 @@ class circular_vector {
     // @param  last   The final exclusive position of the copy range
     template <class InputIterator>
       circular_vector(InputIterator first, InputIterator last, const _Alloc &alloc = _Alloc())
-      : size_(0), capacity_(last-first), start_idx_((last-first)/2), end_idx_((last-first)/2),
-      alloc_(alloc), array_(alloc_.allocate(last-first)) {
+      : size_(0), capacity_(_Index::round_capacity(size_type(last-first))),
+      start_idx_(capacity_/2), end_idx_(capacity_/2),
+      alloc_(alloc), array_(alloc_traits::allocate(alloc_, capacity_)) {
         try {
           assign(first,last);
         } catch (...) {
           clear();
-          alloc_.deallocate(array_, capacity_);
+          alloc_traits::deallocate(alloc_, array_, capacity_);
           throw std::length_error("out of memory");
         }
       }
     // @brief  Copy constructor. Constructs a container with a copy of each of the elements in x, in the same order.
+    //         The allocator is obtained with select_on_container_copy_construction.
     // @param  x  Another vector object of the same type (with the same class template arguments _T and _Alloc), whose contents are copied.
     // @throws  std::length_error  Upon catching any exception while assigning memory
     circular_vector(const circular_vector &x)
+      : circular_vector(x, alloc_traits::select_on_container_copy_construction(x.alloc_)) {}
+    // @brief  Allocator-extended copy constructor. Copies x using @a alloc.
+    // @param  x      Another vector object of the same type, whose contents are copied.
+    // @param  alloc  The allocator of the copy
+    // @throws  std::length_error  Upon catching any exception while assigning memory
+    circular_vector(const circular_vector &x, const _Alloc &alloc)
       : size_(0), capacity_(x.capacity()), start_idx_(x.capacity()/2), end_idx_(x.capacity()/2),
-      alloc_(x.get_allocator()), array_(x.get_allocator().allocate(x.capacity())) {
+      alloc_(alloc), array_(alloc_traits::allocate(alloc_, x.capacity())) {
         try {
-          assign(x.begin(), x.end());
+          copy_elements(x, std::is_trivially_copyable<value_type>());
         } catch (...) {
           clear();
-          alloc_.deallocate(array_, capacity_);
+          alloc_traits::deallocate(alloc_, array_, capacity_);
           throw std::length_error("out of memory");
         }
       }
-    // @brief  Move constructor. Assigns new contents to the container, replacing its current contents, and modifying its size accordingly.
+    // @brief  Move constructor. Constructs a container that takes over the storage of x.
+    //         No elements are copied or moved, O(1) time. noexcept unless the shrink or
+    //         statistics policy of the new container may throw when constructed, as
+    //         circular_stats may when it registers
+    // @param  x  Another vector object of the same type, left empty with no storage.
+    circular_vector(circular_vector &&x)
+      noexcept(std::is_nothrow_default_constructible<_Shrink>::value &&
+               std::is_nothrow_default_constructible<_Stats>::value)
+      : size_(0), capacity_(0), start_idx_(0), end_idx_(0),
+      alloc_(std::move(x.alloc_)), array_(nullptr) {
+        swap_storage(x);
+      }
+    // @brief  Allocator-extended move constructor. Takes over the storage of x if
+    //         @a alloc equals its allocator, otherwise moves the elements one by one
+    //         into storage from @a alloc.
+    // @param  x      Another vector object of the same type, left empty.
+    // @param  alloc  The allocator of the new %circular_vector
+    circular_vector(circular_vector &&x, const _Alloc &alloc)
+      : size_(0), capacity_(0), start_idx_(0), end_idx_(0), alloc_(alloc), array_(nullptr) {
+        if (alloc_ == x.alloc_) {
+          swap_storage(x);
+        } else if (x.capacity_ != 0) {
+          capacity_ = x.capacity_;
+          start_idx_ = end_idx_ = capacity_ / 2;
+          array_ = alloc_traits::allocate(alloc_, capacity_);
+          try {
+            push_back_n(std::make_move_iterator(x.begin()), std::make_move_iterator(x.end()));
+          } catch (...) {
+            alloc_traits::deallocate(alloc_, array_, capacity_);
+            throw;
+          }
+          x.clear();
+        }
+      }
+    // @brief  Copy assignment. Assigns new contents to the container, replacing its current contents, and modifying its size accordingly.
+    //         The allocator is replaced by the allocator of x iff
+    //         propagate_on_container_copy_assignment.
     // @param  x  A vector object of the same type (i.e., with the same template parameters, _T and _Alloc).
     circular_vector &operator = (const self_type &x) {
-      size_ = 0;
-      capacity_ = x.capacity();
-      start_idx_ = x.capacity()/2;
-      end_idx_ = x.capacity()/2;
-      array_ = alloc_.allocate(x.capacity());
-
-      assign(x.begin(), x.end());
+      if (this == &x)
+        return *this;
+      typedef typename alloc_traits::propagate_on_container_copy_assignment propagate;
+      if (std::is_trivially_copyable<value_type>::value && x.size() <= capacity() &&
+          (!propagate::value || alloc_ == x.alloc_)) {
+        // Reuse the existing storage, the copy is at most two memcpy calls
+        copy_elements(x, std::is_trivially_copyable<value_type>());
+        copy_allocator(x, propagate());
+      } else {
+        // Copy with the allocator kept, the old storage is released by its own allocator
+        circular_vector temp(x, propagate::value ? x.alloc_ : alloc_);
+        swap_storage(temp);
+        swap_allocator(temp, propagate());
+      }
+      return *this;
+    }
+    // @brief  Move assignment. Takes over the storage of x, the previous contents are destroyed.
+    //         The allocator is replaced by the allocator of x iff
+    //         propagate_on_container_move_assignment. If it is not and the allocators
+    //         differ, the storage cannot be taken over and the elements are moved one by one.
+    // @param  x  A vector object of the same type, left empty with no storage.
+    circular_vector &operator = (self_type &&x)
+      noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+               alloc_traits::is_always_equal::value) {
+      if (this != &x) {
+        move_assign(x, std::integral_constant<bool,
+            alloc_traits::propagate_on_container_move_assignment::value ||
+            alloc_traits::is_always_equal::value>());
+      }
       return *this;
     }
 
     // DECONSTRUCTORS:
     ~circular_vector() {
-      // clear();
-      alloc_.deallocate(array_, capacity_);
+      clear();
+      if (array_)
+        alloc_traits::deallocate(alloc_, array_, capacity_);
     };
 
     // ITERATORS
     // begin(), An iterator referring to array_[0], i.e. the first element
     // @warn  Iterator should be repositioned upon capacity reallocation or after push_front call
-    iterator         begin()              { return iterator(this, 0); }
-    const_iterator   begin() const        { return const_iterator(this, 0); }
+    iterator         begin()              { return iterator(array_ + start_idx_, array_, array_ + capacity_, 0); }
+    const_iterator   begin() const        { return const_iterator(array_ + start_idx_, array_, array_ + capacity_, 0); }
     // end(), An iterator referring to array_[size()], i.e. past-the-end element
     // @warn  Iterator should be repositioned upon capacity reallocation or after push_back call
-    iterator         end()                { return iterator(this, size()); }
-    const_iterator   end() const          { return const_iterator(this, size()); }
+    iterator         end()                { return iterator(array_ + end_idx_, array_, array_ + capacity_, size()); }
+    const_iterator   end() const          { return const_iterator(array_ + end_idx_, array_, array_ + capacity_, size()); }
     // rbegin()
     // @warn  Iterator should be repositioned upon capacity reallocation or after push_back call
     reverse_iterator rbegin()             { return reverse_iterator(end()); }
@@ -162,6 +475,11 @@ class circular_vector {
     // @warn  Iterator should be repositioned upon capacity reallocation or after push_front call
     reverse_iterator rend()               { return reverse_iterator(begin()); }
     const_reverse_iterator rend() const   { return const_reverse_iterator(begin()); }
+    // cbegin(), cend(), crbegin(), crend(), The const iterators of a non-const %circular_vector
+    const_iterator   cbegin() const       { return begin(); }
+    const_iterator   cend() const         { return end(); }
+    const_reverse_iterator crbegin() const { return rbegin(); }
+    const_reverse_iterator crend() const  { return rend(); }
 
     // ALLOCATORS:
     // @brief  Returns a copy of the allocator object associated with the @circular_vector
@@ -175,7 +493,7 @@ class circular_vector {
     // @brief  Returns the maximum number of elements that the %circular_vector can hold
     //         during dynamic allocation mode
     // @return  Read-only (constant) maximum size
-    size_type max_size() const { return alloc_.max_size(); };
+    size_type max_size() const { return alloc_traits::max_size(alloc_); };
     // @brief  Resizes the %circular_vector to specified size
     // @param  n  Number of elements the %circular_vector should contain.
     // @param  val  The value of the element to fill the extra size
@@ -185,23 +503,17 @@ class circular_vector {
     //        %circular_vector is truncated, otherwise default (or specified) elements
     //        are appended until size reaches @a n size.
     //        If capacity needs to increase => capacity becomes @a n.
-    //        Capacity never shrinks.
+    //        Capacity only shrinks as selected by the shrink policy.
     void resize(size_type n, const value_type &val = value_type()) {
       if (n > size()) {
-        if (n > capacity()) {
-          circular_vector temp(n); // Capacity = n
-          temp.assign(begin(), end());
-          swap(temp);
-        }
+        if (n > capacity())
+          reallocate(n, kGrowBack); // Capacity = n
         // Push new valued elements until size() = n
         while (n != size()) {
           push_back(val);
         }
       } else if (n < size()) {
-        // A more efficient method of doing this can be used
-        // but must ensure wrapped arrays are addressed properly.
-        while (n != size())
-          pop_back();
+        pop_back_n(size() - n);
       }
       // else n == size() => do nothing
     };
@@ -210,19 +522,33 @@ class circular_vector {
     // @brief  Returns true if there are elements in the %circular_vector
     // @return  Read-only (constant) True iff end index is in default state 
     bool empty() const         { return !size_; };
+    // @brief  Returns true if size() has reached capacity(), the next push will either
+    //         reallocate or, with circular_overwrite, overwrite an element
+    bool full() const          { return size_ == capacity_; };
     // @brief  Request that the %circular_vector capacity be at least enough to contain
     //         n elements. This function has no effect on the %circular_vector size and
     //         cannot alter its elements.
     // @warn  If @a n is greater than the current %circular_vector capacity, the function
     //        causes the container to reallocate its storage increasing its
-    //        capacity to @a n (or greater). O(n) time and space required when this occurs
+    //        capacity to @a n or greater, as selected by the growth policy.
+    //        O(n) time and space required when this occurs
     void reserve(size_type n) {
-      if (capacity() < n) {
-        circular_vector temp( std::max<size_type>(n, capacity() * 1.5) );
-        temp.assign(begin(), end());
-        swap(temp);
-      }
+      expand(n, kGrowBoth);
+    }
+    // @brief  Reduces capacity() to size(), at least one element, by relocating the
+    //         elements into newly allocated storage. The shrink policy is told of the
+    //         memory given back
+    // @warn  O(n) time and space, a no-op if the capacity rounded by the index policy
+    //        would not shrink. All iterators are invalidated
+    void shrink_to_fit() {
+      shrink(std::max<size_type>(size_, 1));
     }
+    // @brief  Returns the shrink policy, e.g. for the counters of
+    //         circular_shrink_hysteresis
+    const _Shrink &shrink_policy() const { return shrink_; }
+    // @brief  Returns the statistics policy, e.g. the counters of circular_stats
+    const _Stats &stats() const { return stats_; }
+    _Stats &stats()             { return stats_; }
 
     // MODIFIERS:
     // @brief  Fills a %circular_vector with copies of the elements in the
@@ -234,12 +560,8 @@ class circular_vector {
     //        elements assigned. Old data will be lost
     template <typename iter>
       void assign(iter start, iter last) {
-        if (size() != 0) 
-          clear();
-        while (start != last) {
-          push_back(*start);
-          ++start;
-        }
+        // Pointer ranges of trivially copyable elements are copied with memcpy
+        assign_range(start, last, is_trivial_pointer<iter>());
       }
     // @brief  Fills a %circular_vector with the specified value in the
     //         range [0, n)
@@ -259,65 +581,313 @@ class circular_vector {
     // @brief  Removes the first indexed element
     // @warn  Undefined behaviour when calling on an empty %circular_vector
     void pop_front() {
-      alloc_.destroy(array_ + start_idx_);
+      alloc_traits::destroy(alloc_, array_ + start_idx_);
       increment(kStart);
+      shrink_after_pop();
     }
     // @brief  Removes the last indexed element
     // @warn  Undefined behaviour when calling on an empty %circular_vector
     void pop_back() {
       decrement(kEnd);
-      alloc_.destroy(array_ + end_idx_);
+      alloc_traits::destroy(alloc_, array_ + end_idx_);
+      shrink_after_pop();
+    }
+    // @brief  Removes the first @a n elements
+    // @param  n  Number of elements to remove
+    // @warn  Undefined behaviour when @a n is larger than size()
+    void pop_front_n(size_type n) {
+      if (n == 0)
+        return;
+      drop_front(n);
+      shrink_after_pop();
     }
+    // @brief  Removes the last @a n elements
+    // @param  n  Number of elements to remove
+    // @warn  Undefined behaviour when @a n is larger than size()
+    void pop_back_n(size_type n) {
+      if (n == 0)
+        return;
+      drop_back(n);
+      shrink_after_pop();
+    }
+    // @brief  Appends copies of the elements in the range [first, last) to the tail
+    //         of the %circular_vector. Storage is reserved once and the indices are
+    //         updated once, pointer ranges of trivially copyable elements are
+    //         copied with memcpy
+    // @param  first  An input iterator
+    // @param  last   An input iterator
+    // @warn  If capacity is insufficient the container reallocates once, as selected
+    //        by the growth policy. With circular_overwrite the first elements are
+    //        overwritten instead, only the last capacity() elements are kept.
+    //        The range must not refer to elements of the %circular_vector
+    template <typename iter>
+      void push_back_n(iter first, iter last) {
+        append_range(first, last, typename std::iterator_traits<iter>::iterator_category());
+      }
+    // @brief  Appends copies of @a n elements starting at @a first to the tail
+    //         of the %circular_vector
+    void push_back_n(const value_type *first, size_type n) { push_back_n(first, first + n); }
+    // @brief  Prepends copies of the elements in the range [first, last) to the head
+    //         of the %circular_vector, keeping their order, i.e. front() becomes *first.
+    //         Storage is reserved once and the indices are updated once
+    // @param  first  An input iterator
+    // @param  last   An input iterator
+    // @warn  If capacity is insufficient the container reallocates once, as selected
+    //        by the growth policy. With circular_overwrite the last elements are
+    //        overwritten instead, only the first capacity() elements are kept.
+    //        The range must not refer to elements of the %circular_vector
+    template <typename iter>
+      void push_front_n(iter first, iter last) {
+        prepend_range(first, last, typename std::iterator_traits<iter>::iterator_category());
+      }
+    // @brief  Prepends copies of @a n elements starting at @a first to the head
+    //         of the %circular_vector
+    void push_front_n(const value_type *first, size_type n) { push_front_n(first, first + n); }
     // @brief  Adds an element to the head of the %circular_vector
     //         and decrements the start index
     // @param  val  Element to be added
+    // @return  True iff the last element was overwritten to make room (circular_overwrite)
     // @warn  If capacity has been reached, the function causes the container to
-    //        reallocate its storage increasing its capacity to 1.5 * capacity.
-    //        O(n) time and space required when this occurs
-    void push_front(const value_type &val) {
-      if (end_idx_ == start_idx_ && !empty()) {
-        reserve(capacity() * 1.5);
-      } else if (end_idx_ == start_idx_) {
-        // Do a push_back only on empty case
-        push_back(val);
-        return;
-      }
-
-      decrement(kStart);
-      // array_[start_idx_] = val;
-      alloc_.construct(array_ + start_idx_, val);
+    //        reallocate its storage increasing its capacity as selected by the
+    //        growth policy. O(n) time and space required when this occurs.
+    //        With circular_overwrite the last element is overwritten instead
+    bool push_front(const value_type &val) {
+      const bool overwrite = will_overwrite();
+      emplace_front(val);
+      return overwrite;
+    }
+    // @brief  Adds an element to the head of the %circular_vector by moving @a val
+    // @param  val  Element to be moved in
+    // @return  True iff the last element was overwritten to make room (circular_overwrite)
+    // @warn  If capacity has been reached, the function causes the container to
+    //        reallocate its storage increasing its capacity as selected by the
+    //        growth policy. O(n) time and space required when this occurs.
+    //        With circular_overwrite the last element is overwritten instead
+    bool push_front(value_type &&val) {
+      const bool overwrite = will_overwrite();
+      emplace_front(std::move(val));
+      return overwrite;
     }
     // @brief  Adds an element to the tail of the %circular_vector
     // @param  val  Element to be added
+    // @return  True iff the first element was overwritten to make room (circular_overwrite)
     // @warn  If capacity has been reached, the function causes the container to
-    //        reallocate its storage increasing its capacity to 1.5 * capacity.
-    //        O(n) time and space required when this occurs
-    void push_back(const value_type &val) {
-      if (end_idx_ == start_idx_ && !empty())
-        reserve(capacity() * 1.5);
-
-      alloc_.construct(array_ + end_idx_, val);
-      // array_[end_idx_] = val;
-      increment(kEnd);
+    //        reallocate its storage increasing its capacity as selected by the
+    //        growth policy. O(n) time and space required when this occurs.
+    //        With circular_overwrite the first element is overwritten instead
+    bool push_back(const value_type &val) {
+      const bool overwrite = will_overwrite();
+      emplace_back(val);
+      return overwrite;
+    }
+    // @brief  Adds an element to the tail of the %circular_vector by moving @a val
+    // @param  val  Element to be moved in
+    // @return  True iff the first element was overwritten to make room (circular_overwrite)
+    // @warn  If capacity has been reached, the function causes the container to
+    //        reallocate its storage increasing its capacity as selected by the
+    //        growth policy. O(n) time and space required when this occurs.
+    //        With circular_overwrite the first element is overwritten instead
+    bool push_back(value_type &&val) {
+      const bool overwrite = will_overwrite();
+      emplace_back(std::move(val));
+      return overwrite;
+    }
+    // @brief  Constructs an element in place at the head of the %circular_vector
+    //         and decrements the start index
+    // @param  args  Arguments forwarded to the element's constructor
+    // @return  Read/write reference to the new first element
+    // @warn  If capacity has been reached, the function causes the container to
+    //        reallocate its storage increasing its capacity as selected by the
+    //        growth policy. O(n) time and space required when this occurs.
+    //        With circular_overwrite the last element is overwritten instead
+    template <typename... Args>
+      reference emplace_front(Args&&... args) {
+        if (empty()) {
+          // Do an emplace_back only on empty case
+          return emplace_back(std::forward<Args>(args)...);
+        } else if (will_overwrite()) {
+          // The arguments may refer to the replaced element, construct before assigning
+          const bool wrapped = start_idx_ == 0;
+          start_idx_ = _Index::prev(start_idx_, capacity_);
+          array_[start_idx_] = value_type(std::forward<Args>(args)...);
+          end_idx_ = start_idx_;
+          stats_.popped(true, size_type(1), wrapped);
+          stats_.pushed(false, size_type(1), wrapped, size_, capacity_);
+          return array_[start_idx_];
+        } else if (size_ == capacity_) {
+          // The arguments may refer to an element, construct before relocating
+          value_type val(std::forward<Args>(args)...);
+          grow(kGrowFront);
+          alloc_traits::construct(alloc_, array_ + _Index::prev(start_idx_, capacity_), std::move(val));
+        } else {
+          alloc_traits::construct(alloc_, array_ + _Index::prev(start_idx_, capacity_), std::forward<Args>(args)...);
+        }
+        decrement(kStart);
+        return array_[start_idx_];
+      }
+    // @brief  Constructs an element in place at the tail of the %circular_vector
+    // @param  args  Arguments forwarded to the element's constructor
+    // @return  Read/write reference to the new last element
+    // @warn  If capacity has been reached, the function causes the container to
+    //        reallocate its storage increasing its capacity as selected by the
+    //        growth policy. O(n) time and space required when this occurs.
+    //        With circular_overwrite the first element is overwritten instead
+    template <typename... Args>
+      reference emplace_back(Args&&... args) {
+        if (will_overwrite()) {
+          // The arguments may refer to the replaced element, construct before assigning
+          value_type *element = array_ + end_idx_;
+          *element = value_type(std::forward<Args>(args)...);
+          start_idx_ = _Index::next(start_idx_, capacity_);
+          end_idx_ = start_idx_;
+          stats_.popped(false, size_type(1), start_idx_ == 0);
+          stats_.pushed(true, size_type(1), start_idx_ == 0, size_, capacity_);
+          return *element;
+        } else if (size_ == capacity_) {
+          // The arguments may refer to an element, construct before relocating
+          value_type val(std::forward<Args>(args)...);
+          grow(kGrowBack);
+          alloc_traits::construct(alloc_, array_ + end_idx_, std::move(val));
+        } else {
+          alloc_traits::construct(alloc_, array_ + end_idx_, std::forward<Args>(args)...);
+        }
+        value_type *element = array_ + end_idx_;
+        increment(kEnd);
+        return *element;
+      }
+    // @brief  Constructs an element in place before @a pos
+    // @param  pos   Position in the %circular_vector before which the element is inserted
+    // @param  args  Arguments forwarded to the element's constructor
+    // @return  An iterator to the new element
+    // @warn  The elements on the shorter side of @a pos are shifted by one, O(min(i, size() - i))
+    //        time for an element inserted at index i. If capacity has been reached the
+    //        container reallocates, also with circular_overwrite, no element is overwritten.
+    //        All iterators are invalidated
+    template <typename... Args>
+      iterator emplace(const_iterator pos, Args&&... args) {
+        const size_type index = pos - begin();
+        if (!will_overwrite()) {
+          if (index == 0) {
+            emplace_front(std::forward<Args>(args)...);
+            return begin();
+          } else if (index == size_) {
+            emplace_back(std::forward<Args>(args)...);
+            return end() - 1;
+          }
+        }
+        // The arguments may refer to an element, construct before shifting
+        value_type val(std::forward<Args>(args)...);
+        reserve(size_ + 1);
+        if (index == 0) {
+          emplace_front(std::move(val));
+        } else if (index == size_) {
+          emplace_back(std::move(val));
+        } else {
+          open_gap(index, 1);
+          (*this)[index] = std::move(val);
+        }
+        return begin() + index;
+      }
+    // @brief  Inserts a copy of @a val before @a pos
+    // @param  pos  Position in the %circular_vector before which the element is inserted
+    // @param  val  Element to be inserted
+    // @return  An iterator to the new element
+    // @warn  See emplace()
+    iterator insert(const_iterator pos, const value_type &val) { return emplace(pos, val); }
+    // @brief  Inserts @a val before @a pos by moving it
+    // @param  pos  Position in the %circular_vector before which the element is inserted
+    // @param  val  Element to be moved in
+    // @return  An iterator to the new element
+    // @warn  See emplace()
+    iterator insert(const_iterator pos, value_type &&val) { return emplace(pos, std::move(val)); }
+    // @brief  Inserts @a n copies of @a val before @a pos
+    // @param  pos  Position in the %circular_vector before which the elements are inserted
+    // @param  n    Number of elements to insert
+    // @param  val  Value to be inserted
+    // @return  An iterator to the first new element, or @a pos if @a n is 0
+    // @warn  The elements on the shorter side of @a pos are shifted by @a n,
+    //        O(n + min(i, size() - i)) time for elements inserted at index i. Storage is
+    //        reserved once, also with circular_overwrite, no element is overwritten.
+    //        All iterators are invalidated
+    iterator insert(const_iterator pos, size_type n, const value_type &val) {
+      const size_type index = pos - begin();
+      if (n == 0)
+        return begin() + index;
+      // The value may refer to an element, copy before shifting
+      const value_type copy(val);
+      reserve(size_ + n);
+      if (n <= std::min(index, size_ - index)) {
+        open_gap(index, n);
+        std::fill_n(begin() + index, n, copy);
+      } else if (index < size_ - index) {
+        // The new elements outnumber the shorter side, rotate them into place
+        for (size_type x = 0; x < n; ++x)
+          emplace_front(copy);
+        std::rotate(begin(), begin() + n, begin() + n + index);
+      } else {
+        const size_type old_size = size_;
+        for (size_type x = 0; x < n; ++x)
+          emplace_back(copy);
+        std::rotate(begin() + index, begin() + old_size, end());
+      }
+      return begin() + index;
+    }
+    // @brief  Inserts copies of the elements in the range [first, last) before @a pos,
+    //         keeping their order
+    // @param  pos    Position in the %circular_vector before which the elements are inserted
+    // @param  first  An input iterator
+    // @param  last   An input iterator
+    // @return  An iterator to the first new element, or @a pos if the range is empty
+    // @warn  See insert(pos, n, val). The range must not refer to elements of the
+    //        %circular_vector
+    template <typename iter>
+      iterator insert(const_iterator pos, iter first, iter last) {
+        // Integral arguments are a count and a value, as in std::vector
+        return insert_dispatch(pos - begin(), first, last, std::is_integral<iter>());
+      }
+    // @brief  Removes the element at @a pos
+    // @param  pos  Position of the element to remove
+    // @return  An iterator to the element that followed the removed element
+    // @warn  The elements on the shorter side of @a pos are shifted by one,
+    //        O(min(i, size() - i)) time for the element at index i. All iterators are
+    //        invalidated
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+    // @brief  Removes the elements in the range [first, last)
+    // @param  first  Position of the first element to remove
+    // @param  last   Position one past the last element to remove
+    // @return  An iterator to the element that followed the removed elements
+    // @warn  The elements on the shorter side of the range are shifted to close the
+    //        gap, O(min(i, size() - i - n)) time for @a n elements removed at index i.
+    //        All iterators are invalidated
+    iterator erase(const_iterator first, const_iterator last) {
+      const size_type index = first - begin();
+      const size_type n = last - first;
+      if (n == 0)
+        return begin() + index;
+      if (index < size_ - index - n) {
+        shift_elements(0, index, n);
+        pop_front_n(n);
+      } else {
+        shift_elements(index + n, size_ - index - n, index);
+        pop_back_n(n);
+      }
+      return begin() + index;
     }
     // @brief  Exchanges the content of the container by the content of x, which is
     //         another %circular_vector object of the same type. Sizes may differ.
+    //         The allocators are exchanged iff propagate_on_container_swap.
     // @param  x  The %circular_vector of the same type to swap with.
-    void swap(circular_vector &x) {
-      std::swap(size_,       x.size_);
-      std::swap(capacity_,   x.capacity_);
-      std::swap(start_idx_,  x.start_idx_);
-      std::swap(end_idx_,    x.end_idx_);
-      std::swap(array_,      x.array_);
+    // @warn  Undefined behaviour if the allocators do not propagate and are not equal
+    void swap(circular_vector &x) noexcept {
+      swap_storage(x);
+      swap_allocator(x, typename alloc_traits::propagate_on_container_swap());
     }
     // @brief  Removes all elements from the @circular_vector (which are destroyed),
     //         leaving the container with a size of 0.
     // @warn  If the elements themselves are pointers, the pointed-to memory is not
     //        touched in any way. Managing the pointer is the user's responsibility.
     void clear() {
-      for (size_type x = 0; x < size(); ++x) {
-        alloc_.destroy(array_ + (start_idx_ + x) % capacity());
-      }
+      destroy_n(start_idx_, size_);
       start_idx_ = capacity() / 2;
       end_idx_ = capacity() /2;
       size_ = 0;
@@ -379,6 +949,118 @@ class circular_vector {
     //        behaviour
     const_reference back()  const  { return *(end()-1); };
 
+    // CONTIGUOUS ACCESS:
+    //   The elements occupy at most two contiguous runs of the storage array,
+    //   [start, capacity) followed by [0, end) when the %circular_vector wraps.
+    // @return  The first run, starting at front(). Its length is size() unless the
+    //          elements wrap around the end of the storage array
+    array_range array_one() {
+      return array_range(array_ + start_idx_, std::min(size_, capacity_ - start_idx_));
+    }
+    const_array_range array_one() const {
+      return const_array_range(array_ + start_idx_, std::min(size_, capacity_ - start_idx_));
+    }
+    // @return  The second run, starting at the beginning of the storage array and
+    //          ending with back(). Its length is 0 unless the elements wrap
+    array_range array_two() {
+      return array_range(array_, size_ - array_one().second);
+    }
+    const_array_range array_two() const {
+      return const_array_range(array_, size_ - array_one().second);
+    }
+    // @return  Both runs, array_one() then array_two()
+    std::pair<array_range, array_range> as_spans() {
+      return std::make_pair(array_one(), array_two());
+    }
+    std::pair<const_array_range, const_array_range> as_spans() const {
+      return std::make_pair(array_one(), array_two());
+    }
+    // @return  True iff the elements occupy a single contiguous run
+    bool is_linearized() const     { return start_idx_ + size_ <= capacity_; };
+    // @brief  Rotates the elements in place so they occupy a single contiguous run.
+    //         Never reallocates, O(n) time when the elements wrap.
+    // @return  A pointer to front(), the elements are [linearize(), linearize() + size())
+    // @warn  Invalidates all iterators and pointers when the elements wrap
+    pointer linearize() {
+      if (is_linearized())
+        return array_ + start_idx_;
+
+      // Shift the first run down so it directly follows the second run, closing the
+      // gap [end_idx_, start_idx_) which holds no constructed elements
+      if (end_idx_ != start_idx_) {
+        for (size_type x = start_idx_; x < capacity_; ++x) {
+          pointer dest = array_ + end_idx_ + (x - start_idx_);
+          if (dest < array_ + start_idx_)
+            alloc_traits::construct(alloc_, dest, std::move(array_[x]));
+          else
+            *dest = std::move(array_[x]);
+        }
+        // Destroy the tail of the first run which was not overwritten
+        for (size_type x = std::max(start_idx_, size_); x < capacity_; ++x)
+          alloc_traits::destroy(alloc_, array_ + x);
+      }
+      // [0, size) is now the second run followed by the first run
+      std::rotate(array_, array_ + end_idx_, array_ + size_);
+      start_idx_ = 0;
+      end_idx_ = _Index::wrap(size_, capacity_);
+      return array_;
+    }
+    // @brief  Makes room for @a n more elements at the back, reallocating as selected
+    //         by the growth policy if needed, and returns the uninitialized storage
+    //         they will occupy. Fill it, e.g. with readv or memcpy, then commit_back().
+    // @return  The storage for the next @a n elements as at most two runs, the second
+    //          is empty unless the storage wraps
+    // @warn  The storage holds no elements, only trivially copyable types may be
+    //        written to it without constructing them
+    std::pair<array_range, array_range> prepare_back(size_type n) {
+      if (n == 0)
+        return std::make_pair(array_range(array_ + end_idx_, 0), array_range(array_, 0));
+      expand(size_ + n, kGrowBack);
+      const size_type one = std::min(n, capacity_ - end_idx_);
+      return std::make_pair(array_range(array_ + end_idx_, one), array_range(array_, n - one));
+    }
+    // @brief  Adds the @a n elements written to the storage returned by prepare_back()
+    //         to the back of the %circular_vector
+    // @warn  @a n must not exceed the room prepared
+    void commit_back(size_type n) {
+      // A moved from %circular_vector has no storage to wrap in
+      if (n == 0)
+        return;
+      const bool wrapped = end_idx_ + n >= capacity_;
+      end_idx_ = _Index::wrap(end_idx_ + n, capacity_);
+      size_ += n;
+      stats_.pushed(true, n, wrapped, size_, capacity_);
+    }
+
+  protected:
+    // For containers built on %circular_vector whose allocator hands out storage of
+    //   its own, see small_circular_vector
+
+    // @brief  Constructs a %circular_vector with no storage, as a move leaves it, to be
+    //         given storage with swap_storage()
+    circular_vector(const _Alloc &alloc, std::nullptr_t)
+      noexcept(std::is_nothrow_default_constructible<_Shrink>::value &&
+               std::is_nothrow_default_constructible<_Stats>::value)
+      : size_(0), capacity_(0), start_idx_(0), end_idx_(0), alloc_(alloc), array_(nullptr) {}
+    // @brief  Exchanges the storage and elements with @a x, the allocators are kept
+    // @warn  Each allocator must be able to deallocate the storage it is given
+    void swap_storage(circular_vector &x) noexcept {
+      std::swap(size_,       x.size_);
+      std::swap(capacity_,   x.capacity_);
+      std::swap(start_idx_,  x.start_idx_);
+      std::swap(end_idx_,    x.end_idx_);
+      std::swap(array_,      x.array_);
+    }
+    // @brief  Relocates the elements into newly allocated storage of capacity @a n,
+    //         rounded by the index policy, whether it is smaller or larger. The shrink
+    //         policy is told of any memory given back
+    // @warn  Requires @a n >= size()
+    void relocate(size_type n) {
+      const size_type old_capacity = capacity_;
+      reallocate(n);
+      if (capacity_ < old_capacity)
+        shrink_.reclaimed(old_capacity, capacity_, size_type(sizeof(value_type)));
+    }
 
   private:
     // Number of elements in the %circular_vector
@@ -393,19 +1075,370 @@ class circular_vector {
     _Alloc alloc_;
     // The Data Storage Array
     value_type * array_;
+    // Decides when capacity shrinks as elements are removed
+    _Shrink shrink_;
+    // Records pushes, pops and reallocations
+    _Stats stats_;
+
+    // The end of the %circular_vector that a reallocation makes room for
+    enum GrowthHint {
+      kGrowFront,
+      kGrowBack,
+      kGrowBoth,
+    };
+    // True iff @a _A has reallocate(pointer, old_n, new_n)
+    template <typename _A, typename = void>
+      struct has_reallocate : std::false_type {};
+    template <typename _A>
+      struct has_reallocate<_A, decltype(void(std::declval<_A &>().reallocate(
+          std::declval<value_type *>(), size_type(), size_type())))> : std::true_type {};
+    // True iff the storage can grow through the allocator's reallocate, which relocates
+    // the elements bytewise
+    typedef std::integral_constant<bool, has_reallocate<_Alloc>::value &&
+      std::is_trivially_copyable<value_type>::value> can_reallocate_in_place;
 
     // HELPER FUNCTIONS:
+    // @brief  True iff adding an element replaces an existing one, i.e. the
+    //         %circular_vector is full under circular_overwrite. A moved-from
+    //         %circular_vector without storage grows instead
+    bool will_overwrite() const {
+      return _Overflow::overwrite && size_ == capacity_ && capacity_ != 0;
+    }
+    // True iff @a iter is a pointer to trivially copyable value_type elements,
+    // whose ranges can be copied with memcpy
+    template <typename iter>
+      struct is_trivial_pointer : std::integral_constant<bool,
+        std::is_trivially_copyable<value_type>::value && std::is_pointer<iter>::value &&
+        std::is_same<typename std::remove_cv<typename std::remove_pointer<iter>::type>::type,
+                     value_type>::value> {};
+    // @brief  Copies, exchanges or moves the allocator of @a x when the matching
+    //         propagate_on_container_* trait is true, otherwise does nothing so
+    //         allocators that cannot be assigned are supported
+    void copy_allocator(const circular_vector &x, std::true_type) { alloc_ = x.alloc_; }
+    void copy_allocator(const circular_vector &, std::false_type) {}
+    void swap_allocator(circular_vector &x, std::true_type) {
+      using std::swap;
+      swap(alloc_, x.alloc_);
+    }
+    void swap_allocator(circular_vector &, std::false_type) {}
+    void move_allocator(circular_vector &x, std::true_type) { alloc_ = std::move(x.alloc_); }
+    void move_allocator(circular_vector &, std::false_type) {}
+    // @brief  Implements move assignment when the storage of @a x can be taken over
+    void move_assign(circular_vector &x, std::true_type) {
+      clear();
+      if (array_)
+        alloc_traits::deallocate(alloc_, array_, capacity_);
+      capacity_ = start_idx_ = end_idx_ = 0;
+      array_ = nullptr;
+      swap_storage(x);
+      move_allocator(x, typename alloc_traits::propagate_on_container_move_assignment());
+    }
+    // @brief  Implements move assignment with allocators that neither propagate nor
+    //         always compare equal
+    void move_assign(circular_vector &x, std::false_type) {
+      if (alloc_ == x.alloc_) {
+        move_assign(x, std::true_type());
+      } else {
+        assign(std::make_move_iterator(x.begin()), std::make_move_iterator(x.end()));
+        x.clear();
+      }
+    }
+    // @brief  Destroys the first @a n elements, keeping the capacity
+    void drop_front(size_type n) {
+      destroy_n(start_idx_, n);
+      stats_.popped(false, n, start_idx_ + n >= capacity_);
+      start_idx_ = _Index::wrap(start_idx_ + n, capacity_);
+      size_ -= n;
+    }
+    // @brief  Destroys the last @a n elements, keeping the capacity
+    void drop_back(size_type n) {
+      stats_.popped(true, n, n > end_idx_);
+      end_idx_ = _Index::wrap(end_idx_ + capacity_ - n, capacity_);
+      destroy_n(end_idx_, n);
+      size_ -= n;
+    }
+    // @brief  Reallocates to the smaller capacity @a n, rounded by the index policy,
+    //         and tells the shrink policy of the memory given back. A no-op unless
+    //         the capacity shrinks
+    void shrink(size_type n) {
+      n = _Index::round_capacity(n);
+      if (n < capacity_)
+        relocate(n);
+    }
+    // @brief  Applies the shrink policy after elements are removed. Shrinking is
+    //         only an optimization, a failed reallocation keeps the current storage
+    void shrink_after_pop() {
+      const size_type n = shrink_.shrink_capacity(size_, capacity_);
+      if (n < capacity_) {
+        try {
+          shrink(n);
+        } catch (...) {
+        }
+      }
+    }
+    // @brief  Destroys @a n elements starting at storage index @a index, a no-op
+    //         for trivially destructible elements
+    void destroy_n(size_type index, size_type n) {
+      if (std::is_trivially_destructible<value_type>::value)
+        return;
+      for (; n != 0; --n) {
+        alloc_traits::destroy(alloc_, array_ + index);
+        index = _Index::next(index, capacity_);
+      }
+    }
+    // @brief  Constructs copies of @a n elements starting at @a first into the
+    //         storage starting at index @a index. On an exception the elements
+    //         constructed so far are destroyed
+    template <typename iter>
+      void construct_n(size_type index, iter first, size_type n, std::false_type) {
+        size_type x = 0;
+        try {
+          for (; x < n; ++x, ++first)
+            alloc_traits::construct(alloc_, array_ + _Index::wrap(index + x, capacity_), *first);
+        } catch (...) {
+          destroy_n(index, x);
+          throw;
+        }
+      }
+    void construct_n(size_type index, const value_type *first, size_type n, std::true_type) {
+      copy_into_ring(array_, capacity_, index, first, n);
+    }
+    // @brief  Implements push_back_n, one element at a time for single pass iterators
+    template <typename iter>
+      void append_range(iter first, iter last, std::input_iterator_tag) {
+        for (; first != last; ++first)
+          emplace_back(*first);
+      }
+    template <typename iter>
+      void append_range(iter first, iter last, std::forward_iterator_tag) {
+        size_type n = std::distance(first, last);
+        if (n == 0)
+          return;
+        if (_Overflow::overwrite && capacity_ != 0 && size_ + n > capacity_) {
+          // The range is appended in full, the first elements are dropped
+          if (n >= capacity_) {
+            std::advance(first, n - capacity_);
+            n = capacity_;
+            clear();
+          } else {
+            drop_front(size_ + n - capacity_);
+          }
+        }
+        expand(size_ + n, kGrowBack);
+        construct_n(end_idx_, first, n, is_trivial_pointer<iter>());
+        const bool wrapped = end_idx_ + n >= capacity_;
+        end_idx_ = _Index::wrap(end_idx_ + n, capacity_);
+        size_ += n;
+        stats_.pushed(true, n, wrapped, size_, capacity_);
+      }
+    // @brief  Implements push_front_n, single pass ranges are buffered first so
+    //         their order is kept
+    template <typename iter>
+      void prepend_range(iter first, iter last, std::input_iterator_tag) {
+        // Buffer in a growing %circular_vector, regardless of the overflow policy
+        circular_vector<_T, _Alloc, _Index> temp(kDefaultCapacity, alloc_);
+        temp.push_back_n(first, last);
+        prepend_range(std::make_move_iterator(temp.begin()), std::make_move_iterator(temp.end()),
+            std::forward_iterator_tag());
+      }
+    template <typename iter>
+      void prepend_range(iter first, iter last, std::forward_iterator_tag) {
+        size_type n = std::distance(first, last);
+        if (n == 0)
+          return;
+        if (_Overflow::overwrite && capacity_ != 0 && size_ + n > capacity_) {
+          // The range is prepended in full, the last elements are dropped
+          if (n >= capacity_) {
+            clear();
+            iter stop = first;
+            std::advance(stop, capacity_);
+            append_range(first, stop, std::forward_iterator_tag());
+            return;
+          }
+          drop_back(size_ + n - capacity_);
+        }
+        if (empty()) {
+          append_range(first, last, std::forward_iterator_tag());
+          return;
+        }
+        expand(size_ + n, kGrowFront);
+        const size_type start = _Index::wrap(start_idx_ + capacity_ - n, capacity_);
+        construct_n(start, first, n, is_trivial_pointer<iter>());
+        const bool wrapped = n > start_idx_;
+        start_idx_ = start;
+        size_ += n;
+        stats_.pushed(false, n, wrapped, size_, capacity_);
+      }
+    // @brief  Implements insert(pos, first, last), integral arguments are a count and
+    //         a value
+    template <typename integral>
+      iterator insert_dispatch(size_type index, integral n, integral val, std::true_type) {
+        return insert(begin() + index, size_type(n), value_type(val));
+      }
+    template <typename iter>
+      iterator insert_dispatch(size_type index, iter first, iter last, std::false_type) {
+        return insert_range(index, first, last, typename std::iterator_traits<iter>::iterator_category());
+      }
+    // @brief  Implements insert(pos, first, last), single pass ranges are buffered first
+    //         so the gap is opened once
+    template <typename iter>
+      iterator insert_range(size_type index, iter first, iter last, std::input_iterator_tag) {
+        circular_vector<_T, _Alloc, _Index> temp(kDefaultCapacity, alloc_);
+        temp.push_back_n(first, last);
+        return insert_range(index, std::make_move_iterator(temp.begin()),
+            std::make_move_iterator(temp.end()), std::forward_iterator_tag());
+      }
+    template <typename iter>
+      iterator insert_range(size_type index, iter first, iter last, std::forward_iterator_tag) {
+        const size_type n = std::distance(first, last);
+        if (n == 0)
+          return begin() + index;
+        reserve(size_ + n);
+        if (n <= std::min(index, size_ - index)) {
+          open_gap(index, n);
+          std::copy(first, last, begin() + index);
+        } else if (index < size_ - index) {
+          // The new elements outnumber the shorter side, rotate them into place
+          push_front_n(first, last);
+          std::rotate(begin(), begin() + n, begin() + n + index);
+        } else {
+          const size_type old_size = size_;
+          push_back_n(first, last);
+          std::rotate(begin() + index, begin() + old_size, end());
+        }
+        return begin() + index;
+      }
+    // @brief  Opens a gap of @a n moved-from elements at [index, index + n) by moving the
+    //         elements on the shorter side of @a index outwards. The outermost @a n
+    //         elements are move constructed into new slots, the rest are move assigned
+    // @warn  Requires capacity for @a n more elements and @a n no larger than the number
+    //        of elements on the shorter side
+    void open_gap(size_type index, size_type n) {
+      if (index < size_ - index) {
+        for (size_type x = 0; x < n; ++x)
+          emplace_front(std::move((*this)[n - 1]));
+        shift_elements(2 * n, index - n, n);
+      } else {
+        const size_type old_size = size_;
+        for (size_type x = 0; x < n; ++x)
+          emplace_back(std::move((*this)[old_size - n + x]));
+        shift_elements(index, old_size - n - index, index + n);
+      }
+    }
+    // @brief  Move assigns the @a n elements at logical index @a first to logical index
+    //         @a dest, the ranges may overlap. Works on the contiguous runs of the
+    //         storage array between wrap points, so trivially copyable elements are
+    //         moved with memmove
+    void shift_elements(size_type first, size_type n, size_type dest) {
+      if (dest < first) {
+        while (n != 0) {
+          const size_type from = _Index::wrap(start_idx_ + first, capacity_);
+          const size_type to = _Index::wrap(start_idx_ + dest, capacity_);
+          const size_type run = std::min(n, std::min(capacity_ - from, capacity_ - to));
+          std::move(array_ + from, array_ + from + run, array_ + to);
+          first += run;
+          dest += run;
+          n -= run;
+        }
+      } else if (first < dest) {
+        while (n != 0) {
+          // Runs end one past the last element, counted back to the start of the array
+          const size_type from = _Index::wrap(start_idx_ + first + n - 1, capacity_) + 1;
+          const size_type to = _Index::wrap(start_idx_ + dest + n - 1, capacity_) + 1;
+          const size_type run = std::min(n, std::min(from, to));
+          std::move_backward(array_ + from - run, array_ + from, array_ + to);
+          n -= run;
+        }
+      }
+    }
+    // @brief  Increases capacity as selected by the growth policy, by at least one
+    //         element. A moved-from %circular_vector has no storage and restarts at
+    //         kDefaultCapacity
+    // @param  hint  The end that is growing
+    void grow(GrowthHint hint) {
+      if (capacity_ == 0)
+        expand(kDefaultCapacity, hint);
+      else
+        expand(capacity_ + 1, hint);
+    }
+    // @brief  Implements reserve, growing to at least @a n as selected by the growth policy
+    // @param  hint  The end that is growing
+    void expand(size_type n, GrowthHint hint) {
+      if (capacity_ < n)
+        reallocate(_Growth::grow_capacity(capacity_, n, size_type(sizeof(value_type))), hint);
+    }
+    // @brief  Relocates the elements into newly allocated storage. The elements are placed
+    //         so the end that is growing has all the new room before the elements wrap:
+    //         at the start of the array when growing at the back, at the end of the
+    //         array when growing at the front, and centred like a newly constructed
+    //         %circular_vector otherwise. Elements are moved unless their move
+    //         constructor may throw, in which case they are copied so that an exception
+    //         leaves the %circular_vector unchanged.
+    //         Growing trivially copyable elements with an allocator that can reallocate,
+    //         see circular_realloc_allocator, keeps the elements where they are instead
+    // @param  n     The new capacity, at least size(), rounded by the index policy
+    // @param  hint  The end that is growing
+    void reallocate(size_type n, GrowthHint hint = kGrowBoth) {
+      n = _Index::round_capacity(n);
+      if (n > capacity_ && array_)
+        if (reallocate_in_place(n, can_reallocate_in_place()))
+          return;
+      value_type *array = alloc_traits::allocate(alloc_, n);
+      const size_type start = hint == kGrowBack ? 0 : hint == kGrowFront ? n - size_ : n / 2;
+      relocate_elements(array, n, start, std::is_trivially_copyable<value_type>());
+
+      const size_type size = size_, old_capacity = capacity_;
+      clear();
+      if (array_)
+        alloc_traits::deallocate(alloc_, array_, capacity_);
+      array_ = array;
+      capacity_ = n;
+      size_ = size;
+      start_idx_ = start;
+      end_idx_ = _Index::wrap(start + size, n);
+      stats_.reallocated(old_capacity, n, size);
+    }
+    // @brief  Grows the storage with the allocator's reallocate, which may extend it
+    //         without copying. The elements keep their indices, unless they wrap: then
+    //         the shorter run that fits is moved, the run from index 0 to just past the
+    //         old end of the array, or the run from start to the new end of the array
+    // @return  True iff the storage was reallocated, false if the allocator cannot
+    bool reallocate_in_place(size_type n, std::true_type) {
+      value_type *array = alloc_.reallocate(array_, capacity_, n);
+      const size_type old_capacity = capacity_;
+      array_ = array;
+      capacity_ = n;
+      size_type relocated = 0;
+      if (start_idx_ + size_ > old_capacity) {
+        const size_type one = old_capacity - start_idx_;
+        const size_type two = size_ - one;
+        if (old_capacity + two <= n && two <= one) {
+          std::memcpy(array_ + old_capacity, array_, two * sizeof(value_type));
+          relocated = two;
+        } else {
+          std::memmove(array_ + n - one, array_ + start_idx_, one * sizeof(value_type));
+          start_idx_ = n - one;
+          relocated = one;
+        }
+      }
+      end_idx_ = _Index::wrap(start_idx_ + size_, n);
+      stats_.reallocated(old_capacity, n, relocated);
+      return true;
+    }
+    bool reallocate_in_place(size_type, std::false_type) { return false; }
     // @brief  Increments the specified index and changes size appropriately
     // @param  index  The enum representing 0 - start_idx_ or 1 - end_idx_
     void increment(const size_type index) {
       switch(index) {
         case kStart:
-          start_idx_ = (start_idx_ + 1) % capacity();
+          start_idx_ = _Index::next(start_idx_, capacity_);
           --size_;
+          stats_.popped(false, size_type(1), start_idx_ == 0);
           break;
         case kEnd:
-          end_idx_ = (end_idx_ + 1) % capacity_;
+          end_idx_ = _Index::next(end_idx_, capacity_);
           ++size_;
+          stats_.pushed(true, size_type(1), end_idx_ == 0, size_, capacity_);
           break;
         default:
           throw std::invalid_argument("invalid enumerator");
@@ -416,62 +1449,142 @@ class circular_vector {
     void decrement(const size_type index) {
       switch(index) {
         case kStart:
-          if (start_idx_ == 0)
-            start_idx_ = capacity() - 1;
-          else
-            --start_idx_;
+          stats_.pushed(false, size_type(1), start_idx_ == 0, size_ + 1, capacity_);
+          start_idx_ = _Index::prev(start_idx_, capacity_);
           ++size_;
           break;
         case kEnd:
-          if (end_idx_ == 0)
-            end_idx_ = capacity() - 1;
-          else
-            --end_idx_;
+          stats_.popped(true, size_type(1), end_idx_ == 0);
+          end_idx_ = _Index::prev(end_idx_, capacity_);
           --size_;
           break;
         default:
           throw std::invalid_argument("invalid enumerator");
       }
     }
+    // @brief  Constructs the elements in @a array of capacity @a n starting at index
+    //         @a start. Trivially copyable elements are copied run by run with memcpy.
+    //         On an exception @a array is deallocated and the elements are unchanged
+    void relocate_elements(value_type *array, size_type n, size_type start, std::true_type) {
+      const_array_range one = array_one(), two = array_two();
+      start = copy_into_ring(array, n, start, one.first, one.second);
+      copy_into_ring(array, n, start, two.first, two.second);
+    }
+    void relocate_elements(value_type *array, size_type n, size_type start, std::false_type) {
+      const array_range runs[2] = {array_one(), array_two()};
+      size_type x = 0;
+      try {
+        for (int run = 0; run < 2; ++run) {
+          value_type *element = runs[run].first;
+          for (value_type *last = element + runs[run].second; element != last; ++element, ++x)
+            alloc_traits::construct(alloc_, array + _Index::wrap(start + x, n), std::move_if_noexcept(*element));
+        }
+      } catch (...) {
+        while (x != 0) {
+          --x;
+          alloc_traits::destroy(alloc_, array + _Index::wrap(start + x, n));
+        }
+        alloc_traits::deallocate(alloc_, array, n);
+        throw;
+      }
+    }
+    // @brief  Replaces the elements with copies of the elements of @a x
+    // @warn  Requires capacity() >= x.size()
+    void copy_elements(const circular_vector &x, std::true_type) {
+      clear();
+      const_array_range one = x.array_one(), two = x.array_two();
+      end_idx_ = copy_into_ring(array_, capacity_, start_idx_, one.first, one.second);
+      end_idx_ = copy_into_ring(array_, capacity_, end_idx_, two.first, two.second);
+      size_ = x.size_;
+      stats_.pushed(true, size_, start_idx_ + size_ >= capacity_, size_, capacity_);
+    }
+    void copy_elements(const circular_vector &x, std::false_type) {
+      assign(x.begin(), x.end());
+    }
+    // @brief  Range assignment, memcpy for pointer ranges of trivially copyable elements
+    void assign_range(const value_type *start, const value_type *last, std::true_type) {
+      const size_type n = last - start;
+      clear();
+      reserve(n);
+      end_idx_ = copy_into_ring(array_, capacity_, start_idx_, start, n);
+      size_ = n;
+      stats_.pushed(true, n, start_idx_ + n >= capacity_, size_, capacity_);
+    }
+    template <typename iter>
+      void assign_range(iter start, iter last, std::false_type) {
+        if (size() != 0)
+          clear();
+        while (start != last) {
+          push_back(*start);
+          ++start;
+        }
+      }
+    // @brief  Copies @a len trivially copyable elements bytewise into @a array of
+    //         capacity @a n starting at index @a dest, wrapping at the end of @a array
+    // @return  The index following the last copied element
+    static size_type copy_into_ring(value_type *array, size_type n, size_type dest,
+        const value_type *src, size_type len) {
+      while (len != 0) {
+        const size_type chunk = std::min(len, n - dest);
+        std::memcpy(array + dest, src, chunk * sizeof(value_type));
+        src += chunk;
+        len -= chunk;
+        dest += chunk;
+        if (dest == n)
+          dest = 0;
+      }
+      return dest;
+    }
     // @brief  Returns the given index normalized to the %circular_vector wrapping
     // @param n The index of the element for which data should be accessed
     // @return  Read/write reference to data
     // @warn  Calling this function with an argument @a n that is out of range
     //        causes undefined behaviour
     reference normalize(const size_type n) const {
-      return array_[(start_idx_ + n) % capacity()];
+      return array_[_Index::wrap(start_idx_ + n, capacity_)];
     }
 };
 
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource> // std::pmr::polymorphic_allocator
+
+// A %circular_vector allocating from a std::pmr::memory_resource
+template <typename _T, typename... _Policies>
+using pmr_circular_vector = circular_vector<_T, std::pmr::polymorphic_allocator<_T>, _Policies...>;
+#endif
+#endif
+
 // RELATIONAL OPERATORS:
 // a==b
-template <typename _T, typename _Alloc>
-bool operator==(const circular_vector<_T, _Alloc> &a, const circular_vector<_T, _Alloc> &b) {
-  return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+template <typename _T, typename _Alloc, typename... _Policies>
+bool operator==(const circular_vector<_T, _Alloc, _Policies...> &a, const circular_vector<_T, _Alloc, _Policies...> &b) {
+  // Over the contiguous runs, with vector instructions for arithmetic elements
+  return circular_equal(a, b);
 }
 // a!=b which is equivalent to !(a==b)
-template <typename _T, typename _Alloc>
-bool operator != (const circular_vector<_T, _Alloc> &a, const circular_vector<_T, _Alloc> &b) {
+template <typename _T, typename _Alloc, typename... _Policies>
+bool operator != (const circular_vector<_T, _Alloc, _Policies...> &a, const circular_vector<_T, _Alloc, _Policies...> &b) {
   return !(a==b);
 }
 // a<b
-template <typename _T, typename _Alloc>
-bool operator < (const circular_vector<_T, _Alloc> &a, const circular_vector<_T, _Alloc> &b) {
-  return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+template <typename _T, typename _Alloc, typename... _Policies>
+bool operator < (const circular_vector<_T, _Alloc, _Policies...> &a, const circular_vector<_T, _Alloc, _Policies...> &b) {
+  return circular_lexicographical_compare(a, b);
 }
 // a>b
-template <typename _T, typename _Alloc>
-bool operator > (const circular_vector<_T, _Alloc> &a, const circular_vector<_T, _Alloc> &b) {
-  return std::lexicographical_compare(b.begin(), b.end(), a.begin(), a.end());
+template <typename _T, typename _Alloc, typename... _Policies>
+bool operator > (const circular_vector<_T, _Alloc, _Policies...> &a, const circular_vector<_T, _Alloc, _Policies...> &b) {
+  return circular_lexicographical_compare(b, a);
 }
 // a<=b which is equivalent to !(b<a)
-template <typename _T, typename _Alloc>
-bool operator <= (const circular_vector<_T, _Alloc> &a, const circular_vector<_T, _Alloc> &b) {
+template <typename _T, typename _Alloc, typename... _Policies>
+bool operator <= (const circular_vector<_T, _Alloc, _Policies...> &a, const circular_vector<_T, _Alloc, _Policies...> &b) {
   return !(b<a);
 }
 // a>=b which is equivalent to !(a<b)
-template <typename _T, typename _Alloc>
-bool operator >= (const circular_vector<_T, _Alloc> &a, const circular_vector<_T, _Alloc> &b) {
+template <typename _T, typename _Alloc, typename... _Policies>
+bool operator >= (const circular_vector<_T, _Alloc, _Policies...> &a, const circular_vector<_T, _Alloc, _Policies...> &b) {
   return !(a<b);
 }
 
@@ -479,6 +1592,11 @@ bool operator >= (const circular_vector<_T, _Alloc> &a, const circular_vector<_T
 //   The following template class provides all variants of forward/reverse/const/noconst
 //   iterators using template properties.
 //   It is enough to instantiate it using %circular_vector
+//   The iterator holds a raw pointer into the storage array together with the array
+//   bounds, so dereferencing needs no index normalization and stepping is a pointer
+//   bump with a single compare against the wrap boundary. The logical index is kept
+//   alongside for distance and ordering, which also tells begin() and end() apart
+//   when the %circular_vector is full.
 //   @sample usage: circular_vector<int>::iterator it = foo.begin();
 //                  foo++... etc.
 template <typename _T_noconst, typename _T, typename _element_type>
@@ -489,30 +1607,43 @@ class circular_vector_iterator {
     typedef std::random_access_iterator_tag     iterator_category;
     typedef typename _T::value_type              value_type;
     typedef typename _T::size_type               size_type;
-    typedef typename _T::pointer                 pointer;
+    // Const for the const_iterator
+    typedef _element_type *                      pointer;
     typedef typename _T::const_pointer           const_pointer;
-    typedef typename _T::reference               reference;
+    typedef _element_type &                      reference;
     typedef typename _T::const_reference         const_reference;
     typedef typename _T::difference_type         difference_type;
 
-    circular_vector_iterator(_T * cbuffer, size_type index)
-      : carray_(cbuffer), index_(index) {};
+    // A singular iterator, which may only be assigned to
+    circular_vector_iterator() : ptr_(nullptr), first_(nullptr), last_(nullptr), index_(0) {};
+
+    // @param  ptr    The element referred to
+    // @param  first  The start of the storage array
+    // @param  last   One past the end of the storage array, where ptr wraps to first
+    // @param  index  The logical index of ptr in the %circular_vector
+    circular_vector_iterator(_element_type *ptr, _element_type *first,
+        _element_type *last, difference_type index)
+      : ptr_(ptr), first_(first), last_(last), index_(index) {};
 
     // Converting a non-const iterator to a const iterator
     circular_vector_iterator(const circular_vector_iterator<_T_noconst,
         _T_noconst, typename _T_noconst::value_type> &other)
-      : carray_(other.carray_), index_(other.index_) {};
+      : ptr_(other.ptr_), first_(other.first_), last_(other.last_), index_(other.index_) {};
 
     friend class circular_vector_iterator<_T, const _T, const _element_type>;
 
     // Use compiler generated copy constructor, copy assignment operator
     // and destructor
 
-    _element_type &operator * ()  { return (*carray_)[index_]; };
-    _element_type *operator -> () { return &(operator * ()); };
+    reference operator * () const  { return *ptr_; };
+    pointer operator -> () const   { return ptr_; };
+    // @brief  Returns the element @a n places away, |n| never exceeds the capacity
+    reference operator [] (difference_type n) const { return *(*this + n); };
 
     self_type &operator ++ () {
-      index_++;
+      if (++ptr_ == last_)
+        ptr_ = first_;
+      ++index_;
       return *this;
     }
     self_type operator ++ (int) {
@@ -522,7 +1653,10 @@ class circular_vector_iterator {
     }
 
     self_type &operator -- () {
-      index_--;
+      if (ptr_ == first_)
+        ptr_ = last_;
+      --ptr_;
+      --index_;
       return *this;
     }
     self_type operator -- (int) {
@@ -533,62 +1667,65 @@ class circular_vector_iterator {
 
     self_type operator + (difference_type n) const {
       self_type temp(*this);
-      temp.index_ += n;
+      temp += n;
       return temp;
     }
+    // Jumps across the wrap boundary directly, |n| never exceeds the capacity
     self_type &operator += (difference_type n) {
+      difference_type offset = (ptr_ - first_) + n;
+      const difference_type capacity = last_ - first_;
+      if (offset >= capacity)
+        offset -= capacity;
+      else if (offset < 0)
+        offset += capacity;
+      ptr_ = first_ + offset;
       index_ += n;
       return *this;
     }
 
     self_type operator - (difference_type n) const {
       self_type temp(*this);
-      temp.index_ -= n;
+      temp += -n;
       return temp;
     }
     self_type &operator -= (difference_type n) {
-      index_ -= n;
-      return *this;
+      return *this += -n;
     }
 
-    difference_type operator - (const self_type &c) const {
-      return index_ - c.index_;
+    // Friends, so an iterator and a const_iterator compare either way round
+    friend self_type operator + (difference_type n, const self_type &it) {
+      return it + n;
     }
-
-    bool operator == (const self_type &other) const {
-      return index_ == other.index_ && carray_ == other.carray_;
+    friend difference_type operator - (const self_type &a, const self_type &b) {
+      return a.index_ - b.index_;
+    }
+    friend bool operator == (const self_type &a, const self_type &b) {
+      return a.index_ == b.index_ && a.first_ == b.first_;
     }
-    bool operator != (const self_type &other) const {
-      return index_ != other.index_ && carray_ == other.carray_;
+    friend bool operator != (const self_type &a, const self_type &b) {
+      return !(a == b);
     }
-    bool operator >( const self_type &other) const {
-      return index_ > other.index_;
+    friend bool operator > (const self_type &a, const self_type &b) {
+      return a.index_ > b.index_;
     }
-    bool operator >= (const self_type &other) const {
-      return index_ >= other.index_;
+    friend bool operator >= (const self_type &a, const self_type &b) {
+      return a.index_ >= b.index_;
     }
-    bool operator <( const self_type &other) const {
-      return index_ < other.index_;
+    friend bool operator < (const self_type &a, const self_type &b) {
+      return a.index_ < b.index_;
     }
-    bool operator <= (const self_type &other) const {
-      return index_ <= other.index_;
+    friend bool operator <= (const self_type &a, const self_type &b) {
+      return a.index_ <= b.index_;
     }
 
   private:
-    _T * carray_;
-    size_type  index_;
+    // The element referred to
+    _element_type *ptr_;
+    // The storage array bounds of the %circular_vector
+    _element_type *first_;
+    _element_type *last_;
+    // Logical index of ptr_ in the %circular_vector
+    difference_type index_;
 };
 
-template <typename circular_vector_iterator_t>
-circular_vector_iterator_t operator + (const typename circular_vector_iterator_t::difference_type &a,
-    const circular_vector_iterator_t &b) {
-  return circular_vector_iterator_t(a) + b;
-}
-
-template <typename circular_vector_iterator_t>
-circular_vector_iterator_t operator - (const typename circular_vector_iterator_t::difference_type &a,
-    const circular_vector_iterator_t &b) {
-  return circular_vector_iterator_t(a) - b;
-}
-
 #endif
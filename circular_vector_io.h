@@ -0,0 +1,266 @@
+/* ---------------------------------------------------------------------------
+** This software is in the public domain, furnished "as is", without technical
+** support, and with no warranty, express or implied, as to its usefulness for
+** any purpose.
+**
+** circular_vector_io.h
+** Binary serialization of a %circular_vector to a file descriptor or a stream.
+** A compact header is followed by the elements as at most two contiguous runs,
+** written with one writev and read back into new storage with one readv. Other
+** types are encoded one element at a time by a user supplied codec.
+**
+**
+** Author: Konrad Janica
+** -------------------------------------------------------------------------*/
+
+#ifndef CIRCULAR_VECTOR_IO_HPP_
+#define CIRCULAR_VECTOR_IO_HPP_
+
+#include "circular_vector.h"
+
+#include <algorithm>    // std::min
+#include <cerrno>       // errno, EINTR
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint32_t, std::uint64_t
+#include <istream>      // std::istream
+#include <limits>       // std::numeric_limits
+#include <ostream>      // std::ostream
+#include <stdexcept>    // std::runtime_error
+#include <system_error> // std::system_error, std::system_category
+#include <type_traits>  // std::is_trivially_copyable
+
+#include <sys/stat.h>   // fstat, struct stat, S_ISREG
+#include <sys/uio.h>    // writev, readv, struct iovec
+#include <unistd.h>     // ssize_t, lseek
+
+// The header written before the elements, 32 bytes
+//   element_size is 0 for elements written by a codec.
+struct circular_io_header {
+  std::uint64_t magic;
+  std::uint32_t version;
+  std::uint32_t element_size;
+  std::uint64_t size;
+  std::uint64_t reserved;
+};
+static_assert(sizeof(circular_io_header) == 32, "the header layout is part of the format");
+
+// "CIRCSER" followed by a zero byte, little endian
+static const std::uint64_t kCircularIoMagic = 0x0052455343524943ULL;
+static const std::uint32_t kCircularIoVersion = 1;
+
+// @brief  Writes or reads every byte of the @a count buffers in @a iov, retrying after
+//         partial transfers and interrupts. Modifies @a iov.
+// @throws  std::system_error   If the system call fails
+// @throws  std::runtime_error  If the file ends before the buffers are read
+inline void circular_io_transfer(int fd, struct iovec *iov, int count, bool write) {
+  while (count > 0) {
+    if (iov->iov_len == 0) {
+      ++iov;
+      --count;
+      continue;
+    }
+    const ssize_t n = write ? ::writev(fd, iov, count) : ::readv(fd, iov, count);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      throw std::system_error(errno, std::system_category(), write ? "writev" : "readv");
+    }
+    if (n == 0 && !write)
+      throw std::runtime_error("circular_vector data truncated");
+    // Skip the buffers transferred in full, then advance into the partial one
+    std::size_t done = std::size_t(n);
+    while (count > 0 && done >= iov->iov_len) {
+      done -= iov->iov_len;
+      ++iov;
+      --count;
+    }
+    if (count > 0) {
+      iov->iov_base = static_cast<char *>(iov->iov_base) + done;
+      iov->iov_len -= done;
+    }
+  }
+}
+
+// @brief  Checks @a header was written for elements of @a element_size bytes
+// @throws  std::runtime_error  If it was not
+inline void circular_io_validate(const circular_io_header &header, std::uint32_t element_size) {
+  if (header.magic != kCircularIoMagic || header.version != kCircularIoVersion)
+    throw std::runtime_error("not a serialized circular_vector");
+  if (header.element_size != element_size)
+    throw std::runtime_error("serialized circular_vector holds elements of a different encoding");
+}
+
+// @brief  Checks the @a header.size elements of @a element_size bytes fit in @a max_size
+//         and in the @a remaining bytes of the input, before any storage is allocated
+//         for them. A codec encodes elements in an unknown number of bytes, at least 0
+// @throws  std::runtime_error  If they do not
+inline void circular_io_validate_size(const circular_io_header &header, std::uint32_t element_size,
+    std::size_t max_size, std::uint64_t remaining) {
+  if (header.size > max_size || (element_size && header.size > remaining / element_size))
+    throw std::runtime_error("serialized circular_vector size exceeds the data");
+}
+
+// @return  The bytes left to read from @a fd, unbounded unless it is a regular file
+inline std::uint64_t circular_io_remaining(int fd) {
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+    return std::numeric_limits<std::uint64_t>::max();
+  const off_t offset = ::lseek(fd, 0, SEEK_CUR);
+  if (offset < 0)
+    return std::numeric_limits<std::uint64_t>::max();
+  return offset < st.st_size ? std::uint64_t(st.st_size - offset) : 0;
+}
+
+// @return  The bytes left to read from @a is, unbounded unless it can seek
+inline std::uint64_t circular_io_remaining(std::istream &is) {
+  const std::istream::pos_type offset = is.tellg();
+  if (offset == std::istream::pos_type(-1))
+    return std::numeric_limits<std::uint64_t>::max();
+  is.seekg(0, std::ios_base::end);
+  const std::istream::pos_type end = is.tellg();
+  is.seekg(offset);
+  if (!is || end == std::istream::pos_type(-1)) {
+    is.clear();
+    is.seekg(offset);
+    return std::numeric_limits<std::uint64_t>::max();
+  }
+  return end > offset ? std::uint64_t(end - offset) : 0;
+}
+
+// A codec decoded %circular_vector starts with room for at most this many elements
+//   and doubles as they are read, the header alone does not size the allocation
+static const std::size_t kCircularIoCodecReserve = 1024;
+
+// @return  The header for @a size elements of @a element_size bytes
+inline circular_io_header circular_io_make_header(std::size_t size, std::uint32_t element_size) {
+  circular_io_header header = {kCircularIoMagic, kCircularIoVersion, element_size, size, 0};
+  return header;
+}
+
+// FILE DESCRIPTORS:
+// @brief  Writes the header and the elements of @a v to @a fd with a single writev of
+//         at most three buffers, repeated only after a partial write
+// @throws  std::system_error  If writev fails
+template <typename _T, typename _Alloc, typename... _Policies>
+void write_circular_vector(int fd, const circular_vector<_T, _Alloc, _Policies...> &v) {
+  static_assert(std::is_trivially_copyable<_T>::value,
+      "elements are written as raw bytes, use a codec with a stream for other types");
+  circular_io_header header = circular_io_make_header(v.size(), sizeof(_T));
+  struct iovec iov[3] = {
+    {&header, sizeof(header)},
+    {const_cast<_T *>(v.array_one().first), v.array_one().second * sizeof(_T)},
+    {const_cast<_T *>(v.array_two().first), v.array_two().second * sizeof(_T)}};
+  circular_io_transfer(fd, iov, v.array_two().second ? 3 : 2, true);
+}
+// @brief  Replaces the contents of @a v with the elements read from @a fd. The
+//         elements are read straight into newly allocated storage with a single
+//         readv, repeated only after a partial read
+// @throws  std::system_error   If readv fails
+// @throws  std::runtime_error  If the data is not a serialized %circular_vector of
+//                              this element size, its size exceeds max_size() or the
+//                              rest of a regular file, or it ends early
+template <typename _T, typename _Alloc, typename... _Policies>
+void read_circular_vector(int fd, circular_vector<_T, _Alloc, _Policies...> &v) {
+  static_assert(std::is_trivially_copyable<_T>::value,
+      "elements are read as raw bytes, use a codec with a stream for other types");
+  typedef circular_vector<_T, _Alloc, _Policies...> vector_type;
+  circular_io_header header;
+  struct iovec head = {&header, sizeof(header)};
+  circular_io_transfer(fd, &head, 1, false);
+  circular_io_validate(header, sizeof(_T));
+  circular_io_validate_size(header, sizeof(_T), v.max_size(), circular_io_remaining(fd));
+
+  const std::size_t n = std::size_t(header.size);
+  vector_type temp(n ? n : 1, v.get_allocator());
+  const std::pair<typename vector_type::array_range, typename vector_type::array_range> room = temp.prepare_back(n);
+  struct iovec iov[2] = {
+    {room.first.first, room.first.second * sizeof(_T)},
+    {room.second.first, room.second.second * sizeof(_T)}};
+  circular_io_transfer(fd, iov, room.second.second ? 2 : 1, false);
+  temp.commit_back(n);
+  v = std::move(temp);
+}
+
+// STREAMS:
+// @brief  Writes the header and the elements of @a v to @a os as at most two runs
+// @throws  std::runtime_error  If the stream fails
+template <typename _T, typename _Alloc, typename... _Policies>
+void write_circular_vector(std::ostream &os, const circular_vector<_T, _Alloc, _Policies...> &v) {
+  static_assert(std::is_trivially_copyable<_T>::value,
+      "elements are written as raw bytes, use a codec for other types");
+  const circular_io_header header = circular_io_make_header(v.size(), sizeof(_T));
+  os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  os.write(reinterpret_cast<const char *>(v.array_one().first), v.array_one().second * sizeof(_T));
+  os.write(reinterpret_cast<const char *>(v.array_two().first), v.array_two().second * sizeof(_T));
+  if (!os)
+    throw std::runtime_error("circular_vector write failed");
+}
+// @brief  Replaces the contents of @a v with the elements read from @a is, straight
+//         into newly allocated storage
+// @throws  std::runtime_error  If the data is not a serialized %circular_vector of
+//                              this element size, its size exceeds max_size() or the
+//                              rest of a seekable stream, or it ends early
+template <typename _T, typename _Alloc, typename... _Policies>
+void read_circular_vector(std::istream &is, circular_vector<_T, _Alloc, _Policies...> &v) {
+  static_assert(std::is_trivially_copyable<_T>::value,
+      "elements are read as raw bytes, use a codec for other types");
+  typedef circular_vector<_T, _Alloc, _Policies...> vector_type;
+  circular_io_header header;
+  if (!is.read(reinterpret_cast<char *>(&header), sizeof(header)))
+    throw std::runtime_error("circular_vector data truncated");
+  circular_io_validate(header, sizeof(_T));
+  circular_io_validate_size(header, sizeof(_T), v.max_size(), circular_io_remaining(is));
+
+  const std::size_t n = std::size_t(header.size);
+  vector_type temp(n ? n : 1, v.get_allocator());
+  const std::pair<typename vector_type::array_range, typename vector_type::array_range> room = temp.prepare_back(n);
+  if (!is.read(reinterpret_cast<char *>(room.first.first), room.first.second * sizeof(_T)) ||
+      !is.read(reinterpret_cast<char *>(room.second.first), room.second.second * sizeof(_T)))
+    throw std::runtime_error("circular_vector data truncated");
+  temp.commit_back(n);
+  v = std::move(temp);
+}
+
+// CODECS:
+//   Any element type can be serialized one element at a time by a codec providing
+//     void encode(std::ostream &os, const T &val)  - Writes @a val to @a os
+//     T decode(std::istream &is)                   - Reads an element from @a is
+//   The header records an element size of 0 for codec encoded data.
+
+// @brief  Writes the header and each element of @a v to @a os with @a codec
+// @throws  std::runtime_error  If the stream fails
+template <typename _T, typename _Alloc, typename... _Policies, typename _Codec>
+void write_circular_vector(std::ostream &os, const circular_vector<_T, _Alloc, _Policies...> &v, _Codec &codec) {
+  const circular_io_header header = circular_io_make_header(v.size(), 0);
+  os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  for (std::size_t x = 0; x < v.size() && os; ++x)
+    codec.encode(os, v[x]);
+  if (!os)
+    throw std::runtime_error("circular_vector write failed");
+}
+// @brief  Replaces the contents of @a v with the elements read from @a is with @a codec
+// @throws  std::runtime_error  If the data was not written with a codec, its size exceeds
+//                              max_size(), or it ends early
+template <typename _T, typename _Alloc, typename... _Policies, typename _Codec>
+void read_circular_vector(std::istream &is, circular_vector<_T, _Alloc, _Policies...> &v, _Codec &codec) {
+  circular_io_header header;
+  if (!is.read(reinterpret_cast<char *>(&header), sizeof(header)))
+    throw std::runtime_error("circular_vector data truncated");
+  circular_io_validate(header, 0);
+  circular_io_validate_size(header, 0, v.max_size(), circular_io_remaining(is));
+
+  const std::size_t n = std::size_t(header.size);
+  circular_vector<_T, _Alloc, _Policies...> temp(n == 0 ? 1 : n < kCircularIoCodecReserve ? n : kCircularIoCodecReserve,
+      v.get_allocator());
+  for (std::size_t x = 0; x < n; ++x) {
+    // Grown before it fills, a circular_overwrite vector would drop the first elements
+    if (temp.full())
+      temp.reserve(temp.capacity() + std::min(temp.capacity(), n - x));
+    temp.push_back(codec.decode(is));
+    if (!is)
+      throw std::runtime_error("circular_vector data truncated");
+  }
+  v = std::move(temp);
+}
+
+#endif
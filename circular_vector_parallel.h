@@ -0,0 +1,365 @@
+/* ---------------------------------------------------------------------------
+** This software is in the public domain, furnished "as is", without technical
+** support, and with no warranty, express or implied, as to its usefulness for
+** any purpose.
+**
+** circular_vector_parallel.h
+** Parallel for_each, transform, reduce and sort over a %circular_vector. The
+** two contiguous runs, array_one() and array_two(), are cut into equal
+** pieces of plain pointers which a fork join thread pool works through.
+** An execution policy selects the pool. Define CIRCULAR_VECTOR_STD_EXECUTION
+** to accept the standard policies of <execution> from C++17.
+**
+**
+** Author: Konrad Janica
+** -------------------------------------------------------------------------*/
+
+#ifndef CIRCULAR_VECTOR_PARALLEL_HPP_
+#define CIRCULAR_VECTOR_PARALLEL_HPP_
+
+#include "circular_vector.h"
+
+#include <algorithm>          // std::sort, std::inplace_merge, std::min, std::max
+#include <atomic>             // std::atomic, std::memory_order
+#include <condition_variable> // std::condition_variable
+#include <cstddef>            // std::size_t
+#include <exception>          // std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <functional>         // std::less
+#include <mutex>              // std::mutex, std::unique_lock, std::lock_guard
+#include <thread>             // std::thread
+#include <vector>             // std::vector
+
+// <execution> may need linking with a parallel backend such as TBB, so the standard
+//   policies are only accepted with CIRCULAR_VECTOR_STD_EXECUTION defined
+#if defined(CIRCULAR_VECTOR_STD_EXECUTION) && __cplusplus >= 201703L
+#include <execution>          // std::execution::sequenced_policy, std::execution::parallel_policy
+#define CIRCULAR_VECTOR_HAS_EXECUTION 1
+#endif
+
+// A fork join pool of worker threads
+//   run() hands out the tasks of one job through a shared atomic counter to the
+//   workers and the calling thread, and returns when all of them have finished.
+//   One job runs at a time, concurrent callers wait their turn. A job started from
+//   inside a task runs on the calling thread alone, so tasks may nest.
+class circular_thread_pool {
+  public:
+    // @param  threads  The threads working on a job including the caller, all the
+    //                  hardware threads by default
+    explicit circular_thread_pool(std::size_t threads = std::thread::hardware_concurrency())
+      : threads_(threads ? threads : 1), job_(nullptr), context_(nullptr), tasks_(0),
+        busy_(0), generation_(0), stop_(false) {
+        next_.store(0, std::memory_order_relaxed);
+        workers_.reserve(threads_ - 1);
+        for (std::size_t x = 1; x < threads_; ++x)
+          workers_.push_back(std::thread(&circular_thread_pool::work, this));
+      }
+    circular_thread_pool(const circular_thread_pool &) = delete;
+    circular_thread_pool &operator = (const circular_thread_pool &) = delete;
+    // @warn  No job may be running
+    ~circular_thread_pool() {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+      }
+      wake_.notify_all();
+      for (std::size_t x = 0; x < workers_.size(); ++x)
+        workers_[x].join();
+    }
+
+    // @return  The pool shared by the default policies, sized to the hardware
+    static circular_thread_pool &instance() {
+      static circular_thread_pool pool;
+      return pool;
+    }
+
+    // @return  The threads working on a job, including the caller
+    std::size_t size() const { return threads_; }
+
+    // @brief  Calls @a task(x) for every x in [0, @a tasks) across the pool and waits
+    //         for all of them
+    // @throws  The first exception thrown by a task, the remaining tasks are skipped
+    template <typename _Task>
+    void run(std::size_t tasks, _Task &task) {
+      if (tasks == 0)
+        return;
+      if (tasks == 1 || workers_.empty() || in_pool()) {
+        for (std::size_t x = 0; x < tasks; ++x)
+          task(x);
+        return;
+      }
+      std::lock_guard<std::mutex> serial(run_mutex_);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &invoke<_Task>;
+        context_ = &task;
+        tasks_ = tasks;
+        next_.store(0, std::memory_order_relaxed);
+        busy_ = workers_.size();
+        error_ = std::exception_ptr();
+        ++generation_;
+      }
+      wake_.notify_all();
+      in_pool() = true;
+      drain();
+      in_pool() = false;
+      std::unique_lock<std::mutex> lock(mutex_);
+      done_.wait(lock, [this] { return busy_ == 0; });
+      job_ = nullptr;
+      if (error_) {
+        std::exception_ptr error = error_;
+        error_ = std::exception_ptr();
+        std::rethrow_exception(error);
+      }
+    }
+
+  private:
+    template <typename _Task>
+    static void invoke(void *context, std::size_t x) { (*static_cast<_Task *>(context))(x); }
+
+    // True on a thread working on a job
+    static bool &in_pool() {
+      static thread_local bool flag = false;
+      return flag;
+    }
+
+    // @brief  Claims and runs tasks of the current job until none are left
+    void drain() {
+      for (;;) {
+        const std::size_t x = next_.fetch_add(1, std::memory_order_relaxed);
+        if (x >= tasks_)
+          return;
+        try {
+          job_(context_, x);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (!error_)
+            error_ = std::current_exception();
+          next_.store(tasks_, std::memory_order_relaxed);
+        }
+      }
+    }
+
+    void work() {
+      in_pool() = true;
+      std::size_t seen = 0;
+      for (;;) {
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+          if (stop_)
+            return;
+          seen = generation_;
+        }
+        drain();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--busy_ == 0)
+          done_.notify_one();
+      }
+    }
+
+    const std::size_t threads_;
+    std::vector<std::thread> workers_;
+    // Serializes run() between callers
+    std::mutex run_mutex_;
+    // Guards the job and the worker state below
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    // The job, read by the workers once they see the new generation
+    void (*job_)(void *, std::size_t);
+    void *context_;
+    std::size_t tasks_;
+    std::atomic<std::size_t> next_;
+    // Workers still in the current job
+    std::size_t busy_;
+    std::size_t generation_;
+    std::exception_ptr error_;
+    bool stop_;
+};
+
+// EXECUTION POLICIES:
+// Runs on @a pool, in pieces of at least @a grain elements
+struct circular_parallel_policy {
+  circular_thread_pool *pool;
+  std::size_t grain;
+};
+
+// Pieces smaller than this are not worth handing to another thread
+static const std::size_t kCircularParallelGrain = 1 << 14;
+
+// @return  A policy running on @a pool, the shared pool by default
+inline circular_parallel_policy circular_par(circular_thread_pool &pool = circular_thread_pool::instance(),
+    std::size_t grain = kCircularParallelGrain) {
+  circular_parallel_policy policy = {&pool, grain ? grain : 1};
+  return policy;
+}
+// @return  A policy running on the calling thread alone
+inline circular_parallel_policy circular_seq() {
+  circular_parallel_policy policy = {nullptr, 1};
+  return policy;
+}
+
+inline circular_parallel_policy circular_execution(const circular_parallel_policy &policy) { return policy; }
+#ifdef CIRCULAR_VECTOR_HAS_EXECUTION
+inline circular_parallel_policy circular_execution(const std::execution::sequenced_policy &) { return circular_seq(); }
+inline circular_parallel_policy circular_execution(const std::execution::parallel_policy &) { return circular_par(); }
+inline circular_parallel_policy circular_execution(const std::execution::parallel_unsequenced_policy &) {
+  return circular_par();
+}
+#endif
+
+// HELPERS:
+// A contiguous piece of a run
+template <typename _Pointer>
+struct circular_parallel_piece {
+  _Pointer first;
+  std::size_t n;
+  // The logical index of first in the %circular_vector
+  std::size_t index;
+};
+
+// @return  The runs of @a v cut into pieces of at most ceil(size / tasks) elements,
+//          tasks being the pool size unless pieces would fall below the grain
+template <typename _Vector>
+auto circular_parallel_split(_Vector &v, const circular_parallel_policy &policy)
+    -> std::vector<circular_parallel_piece<decltype(v.array_one().first)> > {
+  typedef decltype(v.array_one().first) pointer;
+  std::vector<circular_parallel_piece<pointer> > pieces;
+  const std::size_t n = v.size();
+  std::size_t tasks = policy.pool ? std::min(policy.pool->size(), n / policy.grain) : 1;
+  tasks = std::max<std::size_t>(tasks, 1);
+  const std::size_t chunk = (n + tasks - 1) / tasks;
+  pointer first[2] = {v.array_one().first, v.array_two().first};
+  const std::size_t size[2] = {v.array_one().second, v.array_two().second};
+  std::size_t index = 0;
+  for (int run = 0; run < 2; ++run) {
+    for (std::size_t done = 0; done < size[run]; ) {
+      const circular_parallel_piece<pointer> piece = {first[run] + done, std::min(chunk, size[run] - done), index};
+      pieces.push_back(piece);
+      done += piece.n;
+      index += piece.n;
+    }
+  }
+  return pieces;
+}
+
+// @brief  Calls @a task(x) for each piece x on the pool of @a policy
+template <typename _Task>
+void circular_parallel_run(const circular_parallel_policy &policy, std::size_t pieces, _Task &task) {
+  if (policy.pool)
+    policy.pool->run(pieces, task);
+  else
+    for (std::size_t x = 0; x < pieces; ++x)
+      task(x);
+}
+
+// ALGORITHMS:
+//   Each takes an execution policy first: circular_par(), circular_seq(), or with
+//   CIRCULAR_VECTOR_STD_EXECUTION std::execution::seq, par and par_unseq.
+//   Like the standard parallel algorithms the elements are visited in no particular
+//   order and the functions must not race with each other.
+
+// @brief  Calls @a f on every element of @a v
+template <typename _Policy, typename _Vector, typename _Function>
+void circular_for_each(const _Policy &policy, _Vector &v, _Function f) {
+  const circular_parallel_policy exec = circular_execution(policy);
+  const auto pieces = circular_parallel_split(v, exec);
+  auto task = [&](std::size_t x) {
+    const auto first = pieces[x].first;
+    for (std::size_t y = 0, n = pieces[x].n; y < n; ++y)
+      f(first[y]);
+  };
+  circular_parallel_run(exec, pieces.size(), task);
+}
+
+// @brief  Writes @a op of every element of @a v to the same position from @a out
+// @param  out  A random access iterator to room for v.size() elements
+// @return  @a out advanced past the last element written
+template <typename _Policy, typename _Vector, typename _OutputIterator, typename _Operation>
+_OutputIterator circular_transform(const _Policy &policy, const _Vector &v, _OutputIterator out, _Operation op) {
+  const circular_parallel_policy exec = circular_execution(policy);
+  const auto pieces = circular_parallel_split(v, exec);
+  auto task = [&](std::size_t x) {
+    const auto first = pieces[x].first;
+    _OutputIterator dest = out + pieces[x].index;
+    for (std::size_t y = 0, n = pieces[x].n; y < n; ++y, ++dest)
+      *dest = op(first[y]);
+  };
+  circular_parallel_run(exec, pieces.size(), task);
+  return out + v.size();
+}
+
+// @return  @a init combined with every element of @a v by @a op, as std::reduce.
+//          Each piece is folded from its first element and the pieces are then folded
+//          in order, so @a op must be associative
+template <typename _Policy, typename _Vector, typename _Acc, typename _BinaryOperation>
+_Acc circular_reduce(const _Policy &policy, const _Vector &v, _Acc init, _BinaryOperation op) {
+  const circular_parallel_policy exec = circular_execution(policy);
+  const auto pieces = circular_parallel_split(v, exec);
+  std::vector<_Acc> partials(pieces.size(), init);
+  auto task = [&](std::size_t x) {
+    const auto first = pieces[x].first;
+    _Acc acc = _Acc(first[0]);
+    for (std::size_t y = 1, n = pieces[x].n; y < n; ++y)
+      acc = op(acc, first[y]);
+    partials[x] = acc;
+  };
+  circular_parallel_run(exec, pieces.size(), task);
+  for (std::size_t x = 0; x < partials.size(); ++x)
+    init = op(init, partials[x]);
+  return init;
+}
+// @return  The sum of @a init and the elements of @a v
+template <typename _Policy, typename _Vector, typename _Acc>
+_Acc circular_reduce(const _Policy &policy, const _Vector &v, _Acc init) {
+  return circular_reduce(policy, v, init, [](const _Acc &a, const _Acc &b) { return a + b; });
+}
+
+// @brief  Sorts @a v by @a comp, not stably. Every piece is sorted on its own, then
+//         neighbouring sorted ranges are merged in pairs, each round in parallel,
+//         until one range is left. Ranges within a run are merged on plain pointers,
+//         a range across the wrap through the iterators
+template <typename _Policy, typename _Vector, typename _Compare>
+void circular_sort(const _Policy &policy, _Vector &v, _Compare comp) {
+  const circular_parallel_policy exec = circular_execution(policy);
+  const auto pieces = circular_parallel_split(v, exec);
+  auto sort = [&](std::size_t x) {
+    std::sort(pieces[x].first, pieces[x].first + pieces[x].n, comp);
+  };
+  circular_parallel_run(exec, pieces.size(), sort);
+
+  // bounds[x] is the logical index at which sorted range x starts
+  std::vector<std::size_t> bounds;
+  for (std::size_t x = 0; x < pieces.size(); ++x)
+    bounds.push_back(pieces[x].index);
+  bounds.push_back(v.size());
+  const std::size_t wrap = v.array_one().second;
+  while (bounds.size() > 2) {
+    const std::size_t ranges = bounds.size() - 1;
+    auto merge = [&](std::size_t x) {
+      const std::size_t first = bounds[2 * x], middle = bounds[2 * x + 1], last = bounds[2 * x + 2];
+      if (last <= wrap) {
+        auto run = v.array_one().first;
+        std::inplace_merge(run + first, run + middle, run + last, comp);
+      } else if (first >= wrap) {
+        auto run = v.array_two().first;
+        std::inplace_merge(run + (first - wrap), run + (middle - wrap), run + (last - wrap), comp);
+      } else {
+        std::inplace_merge(v.begin() + first, v.begin() + middle, v.begin() + last, comp);
+      }
+    };
+    circular_parallel_run(exec, ranges / 2, merge);
+    std::vector<std::size_t> merged;
+    for (std::size_t x = 0; x < ranges; x += 2)
+      merged.push_back(bounds[x]);
+    merged.push_back(v.size());
+    bounds.swap(merged);
+  }
+}
+// @brief  Sorts @a v in ascending order, not stably
+template <typename _Policy, typename _Vector>
+void circular_sort(const _Policy &policy, _Vector &v) {
+  circular_sort(policy, v, std::less<typename _Vector::value_type>());
+}
+
+#endif
@@ -0,0 +1,216 @@
+/* ---------------------------------------------------------------------------
+** This software is in the public domain, furnished "as is", without technical
+** support, and with no warranty, express or implied, as to its usefulness for
+** any purpose.
+**
+** circular_vector_pool.h
+** A recycling block pool for the storage of many short lived %circular_vectors,
+** with a stateful allocator and, under C++17, a std::pmr::memory_resource
+** built on it.
+**
+**
+** Author: Konrad Janica
+** -------------------------------------------------------------------------*/
+
+#ifndef CIRCULAR_VECTOR_POOL_HPP_
+#define CIRCULAR_VECTOR_POOL_HPP_
+
+#include <cstddef>     // std::size_t, std::max_align_t
+#include <new>         // ::operator new, ::operator delete
+#include <type_traits> // std::true_type, std::false_type
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource> // std::pmr::memory_resource
+#define CIRCULAR_VECTOR_POOL_HAS_PMR 1
+#endif
+#endif
+
+// A pool of recycled storage blocks in power of two size classes
+//   A %circular_vector grows and shrinks through the same few capacities, and many
+//   short lived %circular_vectors repeat the same sizes again. A freed block is kept
+//   on the free list of its size class and handed out by the next allocation of that
+//   class instead of going back to the global heap.
+//   Requests are rounded up to a power of two of at least kMinBlock bytes, so the
+//   pool suits circular_pow2_index best. At most @a max_cached bytes are kept on the
+//   free lists, blocks freed beyond that are returned to the heap.
+//   Not thread safe: give each thread its own pool for per-thread arenas.
+class circular_block_pool {
+  public:
+    // CONSTANTS:
+    // The smallest block handed out, in bytes
+    static const std::size_t kMinBlock = 64;
+    // The default limit on the bytes kept on the free lists
+    static const std::size_t kDefaultMaxCached = std::size_t(64) << 20;
+
+    // CONSTRUCTORS:
+    // @param  max_cached  The limit on the bytes kept on the free lists
+    explicit circular_block_pool(std::size_t max_cached = kDefaultMaxCached)
+      : max_cached_(max_cached), cached_bytes_(0), upstream_allocations_(0),
+      recycled_allocations_(0) {
+        for (int x = 0; x < kClasses; ++x)
+          free_[x] = nullptr;
+      }
+    circular_block_pool(const circular_block_pool &) = delete;
+    circular_block_pool &operator = (const circular_block_pool &) = delete;
+
+    // DECONSTRUCTORS:
+    // @warn  Blocks still allocated from the pool must not be deallocated after this
+    ~circular_block_pool() { release(); }
+
+    // @brief  Returns a block of at least @a bytes bytes, recycled if one of its size
+    //         class is cached
+    // @throws  std::bad_alloc  If a new block cannot be allocated
+    void *allocate(std::size_t bytes) {
+      const int size_class = class_of(bytes);
+      free_block *block = free_[size_class];
+      if (block) {
+        free_[size_class] = block->next;
+        cached_bytes_ -= class_bytes(size_class);
+        ++recycled_allocations_;
+        return block;
+      }
+      ++upstream_allocations_;
+      return ::operator new(class_bytes(size_class));
+    }
+    // @brief  Returns the block @a p of @a bytes bytes, as passed to allocate(), to
+    //         the free list of its size class, or to the heap if the cache is full
+    void deallocate(void *p, std::size_t bytes) noexcept {
+      if (!p)
+        return;
+      const int size_class = class_of(bytes);
+      if (cached_bytes_ + class_bytes(size_class) > max_cached_) {
+        ::operator delete(p);
+        return;
+      }
+      free_block *block = static_cast<free_block *>(p);
+      block->next = free_[size_class];
+      free_[size_class] = block;
+      cached_bytes_ += class_bytes(size_class);
+    }
+    // @brief  Returns every cached block to the heap
+    void release() noexcept {
+      for (int x = 0; x < kClasses; ++x) {
+        while (free_[x]) {
+          free_block *next = free_[x]->next;
+          ::operator delete(free_[x]);
+          free_[x] = next;
+        }
+      }
+      cached_bytes_ = 0;
+    }
+
+    // STATISTICS:
+    // @return  The bytes currently kept on the free lists
+    std::size_t cached_bytes() const          { return cached_bytes_; }
+    // @return  The allocations that needed a new block from the heap
+    std::size_t upstream_allocations() const  { return upstream_allocations_; }
+    // @return  The allocations served by a recycled block
+    std::size_t recycled_allocations() const  { return recycled_allocations_; }
+
+  private:
+    // A cached block, linked through its own storage
+    struct free_block {
+      free_block *next;
+    };
+    // Size classes from kMinBlock (2^6) up to the largest power of two size_t holds
+    static const int kMinShift = 6;
+    static const int kClasses = int(sizeof(std::size_t) * 8) - kMinShift;
+
+    // The limit on cached_bytes_
+    std::size_t max_cached_;
+    // The bytes kept on the free lists
+    std::size_t cached_bytes_;
+    std::size_t upstream_allocations_;
+    std::size_t recycled_allocations_;
+    // The free list of each size class
+    free_block *free_[kClasses];
+
+    // HELPER FUNCTIONS:
+    // @brief  Returns the size class of a request of @a bytes bytes
+    static int class_of(std::size_t bytes) {
+      if (bytes > class_bytes(kClasses - 1))
+        throw std::bad_alloc();
+      int size_class = 0;
+      while (class_bytes(size_class) < bytes)
+        ++size_class;
+      return size_class;
+    }
+    // @brief  Returns the block size of @a size_class
+    static std::size_t class_bytes(int size_class) { return kMinBlock << size_class; }
+};
+
+// A stateful allocator drawing from a circular_block_pool
+//   The allocator follows the elements: it propagates on copy assignment, move
+//   assignment and swap, so moving a %circular_vector is always O(1) and storage is
+//   always returned to the pool it came from. Allocators compare equal iff they
+//   share a pool.
+template <typename _T>
+class circular_pool_allocator {
+  public:
+    static_assert(alignof(_T) <= alignof(std::max_align_t), "over-aligned types need their own pool");
+    typedef _T                value_type;
+    typedef std::true_type    propagate_on_container_copy_assignment;
+    typedef std::true_type    propagate_on_container_move_assignment;
+    typedef std::true_type    propagate_on_container_swap;
+    typedef std::false_type   is_always_equal;
+
+    explicit circular_pool_allocator(circular_block_pool &pool) noexcept : pool_(&pool) {}
+    template <typename _U>
+    circular_pool_allocator(const circular_pool_allocator<_U> &other) noexcept : pool_(other.pool_) {}
+
+    _T *allocate(std::size_t n)            { return static_cast<_T *>(pool_->allocate(n * sizeof(_T))); }
+    void deallocate(_T *p, std::size_t n)  { pool_->deallocate(p, n * sizeof(_T)); }
+
+    // @return  The pool allocated from
+    circular_block_pool &pool() const      { return *pool_; }
+
+  private:
+    template <typename _U>
+    friend class circular_pool_allocator;
+    circular_block_pool *pool_;
+};
+
+template <typename _T, typename _U>
+bool operator == (const circular_pool_allocator<_T> &a, const circular_pool_allocator<_U> &b) {
+  return &a.pool() == &b.pool();
+}
+template <typename _T, typename _U>
+bool operator != (const circular_pool_allocator<_T> &a, const circular_pool_allocator<_U> &b) {
+  return !(a == b);
+}
+
+#ifdef CIRCULAR_VECTOR_POOL_HAS_PMR
+// A std::pmr::memory_resource over a circular_block_pool, for pmr_circular_vector
+//   Requests aligned beyond std::max_align_t bypass the pool.
+class circular_pool_resource : public std::pmr::memory_resource {
+  public:
+    // @param  max_cached  The limit on the bytes kept on the free lists
+    explicit circular_pool_resource(std::size_t max_cached = circular_block_pool::kDefaultMaxCached)
+      : pool_(max_cached) {}
+
+    // @return  The underlying pool, e.g. for its statistics
+    circular_block_pool &pool()             { return pool_; }
+    const circular_block_pool &pool() const { return pool_; }
+
+  private:
+    circular_block_pool pool_;
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+      if (alignment > alignof(std::max_align_t))
+        return ::operator new(bytes, std::align_val_t(alignment));
+      return pool_.allocate(bytes);
+    }
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override {
+      if (alignment > alignof(std::max_align_t))
+        ::operator delete(p, std::align_val_t(alignment));
+      else
+        pool_.deallocate(p, bytes);
+    }
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+      return this == &other;
+    }
+};
+#endif
+
+#endif
@@ -0,0 +1,472 @@
+/* ---------------------------------------------------------------------------
+** This software is in the public domain, furnished "as is", without technical
+** support, and with no warranty, express or implied, as to its usefulness for
+** any purpose.
+**
+** circular_vector_simd.h
+** Reductions and searches over the at most two contiguous runs of a
+** %circular_vector: accumulate, minmax, find, count, equal and lexicographical
+** compare. Arithmetic elements are processed 32 bytes at a time with vector
+** extensions, compiled for AVX2 and for the baseline (SSE2 on x86-64) and
+** selected at run time. Other elements use the standard algorithms run by run.
+** Define CIRCULAR_VECTOR_NO_SIMD for the scalar loops only.
+**
+**
+** Author: Konrad Janica
+** -------------------------------------------------------------------------*/
+
+#ifndef CIRCULAR_VECTOR_SIMD_HPP_
+#define CIRCULAR_VECTOR_SIMD_HPP_
+
+#include <algorithm>   // std::min, std::minmax_element, std::find, std::count, std::equal, std::lexicographical_compare
+#include <cstddef>     // std::size_t
+#include <cstring>     // std::memcpy
+#include <numeric>     // std::accumulate
+#include <type_traits> // std::integral_constant, std::is_integral, std::is_same, std::make_unsigned
+#include <utility>     // std::pair
+
+#if defined(__GNUC__) && !defined(CIRCULAR_VECTOR_NO_SIMD)
+#define CIRCULAR_VECTOR_HAS_SIMD 1
+#define CIRCULAR_SIMD_INLINE inline __attribute__((always_inline))
+#if defined(__x86_64__) || defined(__i386__)
+#define CIRCULAR_VECTOR_HAS_AVX2_DISPATCH 1
+#endif
+#endif
+
+// True iff @a _T is processed with vector instructions: the integers but bool,
+//   float and double
+template <typename _T>
+struct circular_simd_supported : std::integral_constant<bool,
+#ifdef CIRCULAR_VECTOR_HAS_SIMD
+  (std::is_integral<_T>::value && !std::is_same<_T, bool>::value) ||
+  std::is_same<_T, float>::value || std::is_same<_T, double>::value
+#else
+  false
+#endif
+  > {};
+
+// The elements of a %circular_vector as its two runs, array_one() then array_two()
+template <typename _T>
+struct circular_simd_runs {
+  const _T *first[2];
+  std::size_t n[2];
+
+  template <typename _Vector>
+  explicit circular_simd_runs(const _Vector &v) {
+    first[0] = v.array_one().first;
+    n[0] = v.array_one().second;
+    first[1] = v.array_two().first;
+    n[1] = v.array_two().second;
+  }
+  std::size_t size() const { return n[0] + n[1]; }
+  const _T &operator [] (std::size_t i) const { return i < n[0] ? first[0][i] : first[1][i - n[0]]; }
+};
+
+#ifdef CIRCULAR_VECTOR_HAS_SIMD
+// The 32 byte vector of @a _T, 8 floats or 32 chars. On a target without 32 byte
+//   registers each operation is split in two 16 byte operations. Vectors are never
+//   passed by value, whose ABI differs between the targets.
+template <typename _T>
+struct circular_simd_vec {
+  static const std::size_t kLanes = 32 / sizeof(_T);
+  typedef _T type __attribute__((vector_size(32)));
+
+  static CIRCULAR_SIMD_INLINE void load(type &v, const _T *p) { std::memcpy(&v, p, sizeof(v)); }
+  static CIRCULAR_SIMD_INLINE void broadcast(type &v, _T val) { v = type() + val; }
+};
+
+// @return  True iff any lane of the comparison result @a m is set
+template <typename _Mask>
+CIRCULAR_SIMD_INLINE bool circular_simd_any(const _Mask &m) {
+  typedef long long words __attribute__((vector_size(32)));
+  const words w = (words)m;
+  return (w[0] | w[1] | w[2] | w[3]) != 0;
+}
+
+// True iff the CPU supports AVX2, checked once
+inline bool circular_simd_has_avx2() {
+#ifdef CIRCULAR_VECTOR_HAS_AVX2_DISPATCH
+  static const bool avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0);
+  return avx2;
+#else
+  return false;
+#endif
+}
+
+#ifdef CIRCULAR_VECTOR_HAS_AVX2_DISPATCH
+// @brief  Runs @a kernel compiled for AVX2, its inlined body uses 32 byte registers
+template <typename _Kernel>
+__attribute__((target("avx2"))) typename _Kernel::result_type circular_simd_run_avx2(const _Kernel &kernel) {
+  return kernel();
+}
+#endif
+
+// @brief  Runs @a kernel compiled for AVX2 if the CPU supports it, otherwise for the
+//         baseline target
+template <typename _Kernel>
+typename _Kernel::result_type circular_simd_dispatch(const _Kernel &kernel) {
+#ifdef CIRCULAR_VECTOR_HAS_AVX2_DISPATCH
+  if (circular_simd_has_avx2())
+    return circular_simd_run_avx2(kernel);
+#endif
+  return kernel();
+}
+
+// KERNELS:
+//   Each kernel is a function object whose always inlined operator() is compiled
+//   once per target by circular_simd_dispatch.
+
+// The sum of the elements added to @a init. Integers only, the lanes are widened to
+//   the type of @a init and added without sign, so the result is that of
+//   std::accumulate whenever it is defined, whatever the order of the additions.
+template <typename _T, typename _Acc>
+struct circular_simd_accumulate_kernel {
+  typedef _Acc result_type;
+  circular_simd_runs<_T> runs;
+  _Acc init;
+
+  CIRCULAR_SIMD_INLINE _Acc operator () () const {
+    typedef circular_simd_vec<_T> vec;
+    typedef typename std::make_unsigned<_Acc>::type sum_type;
+    typedef sum_type sum_vec __attribute__((vector_size(sizeof(_Acc) * vec::kLanes)));
+    sum_vec sum = sum_vec();
+    sum_type total = sum_type(init);
+    for (int r = 0; r < 2; ++r) {
+      const _T *p = runs.first[r];
+      std::size_t n = runs.n[r];
+      for (; n >= vec::kLanes; p += vec::kLanes, n -= vec::kLanes) {
+        typename vec::type v;
+        vec::load(v, p);
+        sum += __builtin_convertvector(v, sum_vec);
+      }
+      for (; n != 0; --n, ++p)
+        total = sum_type(total + sum_type(*p));
+    }
+    for (std::size_t lane = 0; lane < vec::kLanes; ++lane)
+      total = sum_type(total + sum[lane]);
+    return _Acc(total);
+  }
+};
+
+// The smallest and largest element, of a non empty %circular_vector
+template <typename _T>
+struct circular_simd_minmax_kernel {
+  typedef std::pair<_T, _T> result_type;
+  circular_simd_runs<_T> runs;
+
+  CIRCULAR_SIMD_INLINE result_type operator () () const {
+    typedef circular_simd_vec<_T> vec;
+    const _T front = runs[0];
+    typename vec::type lo, hi;
+    vec::broadcast(lo, front);
+    hi = lo;
+    _T min = front, max = front;
+    for (int r = 0; r < 2; ++r) {
+      const _T *p = runs.first[r];
+      std::size_t n = runs.n[r];
+      for (; n >= vec::kLanes; p += vec::kLanes, n -= vec::kLanes) {
+        typename vec::type v;
+        vec::load(v, p);
+        lo = v < lo ? v : lo;
+        hi = hi < v ? v : hi;
+      }
+      for (; n != 0; --n, ++p) {
+        if (*p < min)
+          min = *p;
+        if (max < *p)
+          max = *p;
+      }
+    }
+    for (std::size_t lane = 0; lane < vec::kLanes; ++lane) {
+      if (lo[lane] < min)
+        min = lo[lane];
+      if (max < hi[lane])
+        max = hi[lane];
+    }
+    return result_type(min, max);
+  }
+};
+
+// The index of the first element equal to @a val, size() if there is none
+template <typename _T>
+struct circular_simd_find_kernel {
+  typedef std::size_t result_type;
+  circular_simd_runs<_T> runs;
+  _T val;
+
+  CIRCULAR_SIMD_INLINE std::size_t operator () () const {
+    typedef circular_simd_vec<_T> vec;
+    static const std::size_t kBlock = 4 * vec::kLanes;
+    typename vec::type key, v0, v1, v2, v3;
+    vec::broadcast(key, val);
+    std::size_t base = 0;
+    for (int r = 0; r < 2; ++r) {
+      const _T *p = runs.first[r];
+      std::size_t x = 0, n = runs.n[r];
+      // Four vectors are compared per test of the result, the block is searched
+      // again element by element only when it holds a match
+      for (; x + kBlock <= n; x += kBlock) {
+        vec::load(v0, p + x);
+        vec::load(v1, p + x + vec::kLanes);
+        vec::load(v2, p + x + 2 * vec::kLanes);
+        vec::load(v3, p + x + 3 * vec::kLanes);
+        if (circular_simd_any((v0 == key) | (v1 == key) | (v2 == key) | (v3 == key)))
+          break;
+      }
+      for (; x < n; ++x)
+        if (p[x] == val)
+          return base + x;
+      base += n;
+    }
+    return base;
+  }
+};
+
+// The number of elements equal to @a val
+template <typename _T>
+struct circular_simd_count_kernel {
+  typedef std::size_t result_type;
+  circular_simd_runs<_T> runs;
+  _T val;
+
+  CIRCULAR_SIMD_INLINE std::size_t operator () () const {
+    typedef circular_simd_vec<_T> vec;
+    typedef decltype(typename vec::type() == typename vec::type()) mask_type;
+    // A matching lane is -1, the lane counts are added up before they can overflow
+    static const std::size_t kFlush = sizeof(_T) == 1 ? 127 : sizeof(_T) == 2 ? 32767 : std::size_t(1) << 30;
+    typename vec::type key, v;
+    vec::broadcast(key, val);
+    std::size_t count = 0;
+    for (int r = 0; r < 2; ++r) {
+      const _T *p = runs.first[r];
+      std::size_t n = runs.n[r];
+      while (n >= vec::kLanes) {
+        mask_type lanes = mask_type();
+        for (std::size_t x = 0; x < kFlush && n >= vec::kLanes; ++x, p += vec::kLanes, n -= vec::kLanes) {
+          vec::load(v, p);
+          lanes += v == key;
+        }
+        for (std::size_t lane = 0; lane < vec::kLanes; ++lane)
+          count -= std::size_t(lanes[lane]);
+      }
+      for (; n != 0; --n, ++p)
+        count += *p == val;
+    }
+    return count;
+  }
+};
+
+// The first index from @a start below @a limit where the elements of @a a and @a b
+//   compare unequal, @a limit if there is none
+template <typename _T>
+struct circular_simd_mismatch_kernel {
+  typedef std::size_t result_type;
+  circular_simd_runs<_T> a;
+  circular_simd_runs<_T> b;
+  std::size_t start;
+  std::size_t limit;
+
+  CIRCULAR_SIMD_INLINE std::size_t operator () () const {
+    typedef circular_simd_vec<_T> vec;
+    typename vec::type va, vb;
+    std::size_t i = start;
+    while (i < limit) {
+      // The longest piece from i that is contiguous in both
+      const _T *pa = i < a.n[0] ? a.first[0] + i : a.first[1] + (i - a.n[0]);
+      const _T *pb = i < b.n[0] ? b.first[0] + i : b.first[1] + (i - b.n[0]);
+      std::size_t n = limit - i;
+      if (i < a.n[0])
+        n = std::min(n, a.n[0] - i);
+      if (i < b.n[0])
+        n = std::min(n, b.n[0] - i);
+      std::size_t x = 0;
+      for (; x + vec::kLanes <= n; x += vec::kLanes) {
+        vec::load(va, pa + x);
+        vec::load(vb, pb + x);
+        if (circular_simd_any(va != vb))
+          break;
+      }
+      for (; x < n; ++x)
+        if (!(pa[x] == pb[x]))
+          return i + x;
+      i += n;
+    }
+    return limit;
+  }
+};
+#endif
+
+// HELPERS:
+//   The algorithms over the runs, with the vector kernels selected by the last
+//   argument.
+
+template <typename _T, typename _Acc>
+_Acc circular_accumulate_runs(const circular_simd_runs<_T> &runs, _Acc init, std::false_type) {
+  init = std::accumulate(runs.first[0], runs.first[0] + runs.n[0], init);
+  return std::accumulate(runs.first[1], runs.first[1] + runs.n[1], init);
+}
+template <typename _T, typename _Acc>
+_Acc circular_accumulate_runs(const circular_simd_runs<_T> &runs, _Acc init, std::true_type) {
+#ifdef CIRCULAR_VECTOR_HAS_SIMD
+  const circular_simd_accumulate_kernel<_T, _Acc> kernel = {runs, init};
+  return circular_simd_dispatch(kernel);
+#else
+  return circular_accumulate_runs(runs, init, std::false_type());
+#endif
+}
+
+template <typename _T>
+std::pair<_T, _T> circular_minmax_runs(const circular_simd_runs<_T> &runs, std::false_type) {
+  std::pair<const _T *, const _T *> one = std::minmax_element(runs.first[0], runs.first[0] + runs.n[0]);
+  std::pair<_T, _T> result(*one.first, *one.second);
+  if (runs.n[1] != 0) {
+    std::pair<const _T *, const _T *> two = std::minmax_element(runs.first[1], runs.first[1] + runs.n[1]);
+    if (*two.first < result.first)
+      result.first = *two.first;
+    if (!(*two.second < result.second))
+      result.second = *two.second;
+  }
+  return result;
+}
+template <typename _T>
+std::pair<_T, _T> circular_minmax_runs(const circular_simd_runs<_T> &runs, std::true_type) {
+#ifdef CIRCULAR_VECTOR_HAS_SIMD
+  const circular_simd_minmax_kernel<_T> kernel = {runs};
+  return circular_simd_dispatch(kernel);
+#else
+  return circular_minmax_runs(runs, std::false_type());
+#endif
+}
+
+template <typename _T>
+std::size_t circular_find_runs(const circular_simd_runs<_T> &runs, const _T &val, std::false_type) {
+  const _T *found = std::find(runs.first[0], runs.first[0] + runs.n[0], val);
+  if (found != runs.first[0] + runs.n[0])
+    return std::size_t(found - runs.first[0]);
+  return runs.n[0] + std::size_t(std::find(runs.first[1], runs.first[1] + runs.n[1], val) - runs.first[1]);
+}
+template <typename _T>
+std::size_t circular_find_runs(const circular_simd_runs<_T> &runs, const _T &val, std::true_type) {
+#ifdef CIRCULAR_VECTOR_HAS_SIMD
+  const circular_simd_find_kernel<_T> kernel = {runs, val};
+  return circular_simd_dispatch(kernel);
+#else
+  return circular_find_runs(runs, val, std::false_type());
+#endif
+}
+
+template <typename _T>
+std::size_t circular_count_runs(const circular_simd_runs<_T> &runs, const _T &val, std::false_type) {
+  return std::size_t(std::count(runs.first[0], runs.first[0] + runs.n[0], val) +
+                     std::count(runs.first[1], runs.first[1] + runs.n[1], val));
+}
+template <typename _T>
+std::size_t circular_count_runs(const circular_simd_runs<_T> &runs, const _T &val, std::true_type) {
+#ifdef CIRCULAR_VECTOR_HAS_SIMD
+  const circular_simd_count_kernel<_T> kernel = {runs, val};
+  return circular_simd_dispatch(kernel);
+#else
+  return circular_count_runs(runs, val, std::false_type());
+#endif
+}
+
+// @return  The first index from @a start below @a limit where @a a and @a b differ
+template <typename _T>
+std::size_t circular_mismatch_runs(const circular_simd_runs<_T> &a, const circular_simd_runs<_T> &b,
+    std::size_t start, std::size_t limit) {
+#ifdef CIRCULAR_VECTOR_HAS_SIMD
+  const circular_simd_mismatch_kernel<_T> kernel = {a, b, start, limit};
+  return circular_simd_dispatch(kernel);
+#else
+  while (start < limit && a[start] == b[start])
+    ++start;
+  return start;
+#endif
+}
+
+template <typename _Vector>
+bool circular_equal_runs(const _Vector &a, const _Vector &b, std::false_type) {
+  return std::equal(a.begin(), a.end(), b.begin());
+}
+template <typename _Vector>
+bool circular_equal_runs(const _Vector &a, const _Vector &b, std::true_type) {
+  typedef typename _Vector::value_type value_type;
+  const circular_simd_runs<value_type> runs_a(a), runs_b(b);
+  return circular_mismatch_runs(runs_a, runs_b, 0, a.size()) == a.size();
+}
+
+template <typename _Vector>
+bool circular_lexicographical_runs(const _Vector &a, const _Vector &b, std::false_type) {
+  return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+}
+template <typename _Vector>
+bool circular_lexicographical_runs(const _Vector &a, const _Vector &b, std::true_type) {
+  typedef typename _Vector::value_type value_type;
+  const circular_simd_runs<value_type> runs_a(a), runs_b(b);
+  const std::size_t limit = std::min(a.size(), b.size());
+  // Elements that are neither less nor greater, NaNs, do not decide the order
+  for (std::size_t i = circular_mismatch_runs(runs_a, runs_b, 0, limit); i < limit;
+       i = circular_mismatch_runs(runs_a, runs_b, i + 1, limit)) {
+    if (runs_a[i] < runs_b[i])
+      return true;
+    if (runs_b[i] < runs_a[i])
+      return false;
+  }
+  return a.size() < b.size();
+}
+
+// ALGORITHMS:
+//   Each takes any %circular_vector, or a container with the same array_one() and
+//   array_two(), and returns what the standard algorithm of the same name would
+//   over [begin(), end()).
+
+// @return  @a init plus the sum of the elements, as std::accumulate. Integers are summed
+//          in vector lanes of the type of @a init. Floating point elements are summed
+//          in order, so the rounding is that of std::accumulate
+template <typename _Vector, typename _Acc>
+_Acc circular_accumulate(const _Vector &v, _Acc init) {
+  typedef typename _Vector::value_type value_type;
+  return circular_accumulate_runs(circular_simd_runs<value_type>(v), init,
+      std::integral_constant<bool, circular_simd_supported<value_type>::value &&
+        std::is_integral<value_type>::value && std::is_integral<_Acc>::value &&
+        !std::is_same<_Acc, bool>::value>());
+}
+
+// @return  The smallest and the largest element
+// @warn  Undefined behaviour on an empty %circular_vector. With NaNs, or zeros of both
+//        signs, which of the unordered values is returned is unspecified
+template <typename _Vector>
+std::pair<typename _Vector::value_type, typename _Vector::value_type> circular_minmax(const _Vector &v) {
+  typedef typename _Vector::value_type value_type;
+  return circular_minmax_runs(circular_simd_runs<value_type>(v), circular_simd_supported<value_type>());
+}
+
+// @return  An iterator to the first element equal to @a val, end() if there is none
+template <typename _Vector>
+auto circular_find(_Vector &v, const typename _Vector::value_type &val) -> decltype(v.begin()) {
+  typedef typename _Vector::value_type value_type;
+  return v.begin() + circular_find_runs(circular_simd_runs<value_type>(v), val,
+      circular_simd_supported<value_type>());
+}
+
+// @return  The number of elements equal to @a val
+template <typename _Vector>
+std::size_t circular_count(const _Vector &v, const typename _Vector::value_type &val) {
+  typedef typename _Vector::value_type value_type;
+  return circular_count_runs(circular_simd_runs<value_type>(v), val, circular_simd_supported<value_type>());
+}
+
+// @return  True iff @a a and @a b have the same size and equal elements
+template <typename _Vector>
+bool circular_equal(const _Vector &a, const _Vector &b) {
+  return a.size() == b.size() &&
+    circular_equal_runs(a, b, circular_simd_supported<typename _Vector::value_type>());
+}
+
+// @return  True iff @a a compares lexicographically less than @a b
+template <typename _Vector>
+bool circular_lexicographical_compare(const _Vector &a, const _Vector &b) {
+  return circular_lexicographical_runs(a, b, circular_simd_supported<typename _Vector::value_type>());
+}
+
+#endif
@@ -0,0 +1,227 @@
+/* ---------------------------------------------------------------------------
+** This software is in the public domain, furnished "as is", without technical
+** support, and with no warranty, express or implied, as to its usefulness for
+** any purpose.
+**
+** circular_vector_stats.h
+** A statistics policy for %circular_vector counting reallocations, relocated
+** elements, pushes, pops and wraps at each end, and the peak size and capacity,
+** with a process wide registry of the live counters that can be dumped from
+** any thread.
+**
+**
+** Author: Konrad Janica
+** -------------------------------------------------------------------------*/
+
+#ifndef CIRCULAR_VECTOR_STATS_HPP_
+#define CIRCULAR_VECTOR_STATS_HPP_
+
+#include <atomic>   // std::atomic, std::memory_order_relaxed
+#include <cstddef>  // std::size_t
+#include <mutex>    // std::mutex, std::lock_guard
+#include <ostream>  // std::ostream
+#include <vector>   // std::vector
+
+class circular_stats;
+
+// The registry of every live circular_stats
+//   Each circular_stats adds itself on construction and removes itself on destruction,
+//   so a monitoring thread can dump the counters of every instrumented %circular_vector
+//   periodically. Thread safe.
+class circular_stats_registry {
+  public:
+    // A copy of the counters of one %circular_vector
+    struct entry {
+      const char *label;
+      std::size_t reallocations;
+      std::size_t elements_relocated;
+      std::size_t peak_size;
+      std::size_t peak_capacity;
+      std::size_t push_front;
+      std::size_t push_back;
+      std::size_t pop_front;
+      std::size_t pop_back;
+      std::size_t wraps;
+    };
+
+    // @return  The registry of the process
+    static circular_stats_registry &instance() {
+      static circular_stats_registry registry;
+      return registry;
+    }
+    circular_stats_registry(const circular_stats_registry &) = delete;
+    circular_stats_registry &operator = (const circular_stats_registry &) = delete;
+
+    // @return  The number of live circular_stats
+    std::size_t size() const {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return size_;
+    }
+    // @return  The counters of every live circular_stats, most recently created first
+    inline std::vector<entry> snapshot() const;
+    // @brief  Writes the counters of every live circular_stats to @a os, one line each
+    inline void dump(std::ostream &os) const;
+
+  private:
+    friend class circular_stats;
+    circular_stats_registry() : head_(nullptr), size_(0) {}
+    inline void add(circular_stats *stats);
+    inline void remove(circular_stats *stats);
+
+    mutable std::mutex mutex_;
+    // An intrusive list through circular_stats, so removal is O(1)
+    circular_stats *head_;
+    std::size_t size_;
+};
+
+// Counts what a %circular_vector does, selected with the _Stats template parameter
+//   e.g. circular_vector<int, std::allocator<int>, circular_modulo_index, circular_grow,
+//        circular_never_shrink, circular_growth_geometric<>, circular_stats>
+//   The counters are relaxed atomics written only by the thread using the
+//   %circular_vector, each update is a plain load and store, so they may be read from
+//   any thread without a data race, through the registry or directly. A copied or
+//   moved %circular_vector starts with counters of its own.
+class circular_stats {
+  public:
+    circular_stats() : label_("circular_vector"), prev_(nullptr), next_(nullptr) {
+      reset();
+      circular_stats_registry::instance().add(this);
+    }
+    circular_stats(const circular_stats &) = delete;
+    circular_stats &operator = (const circular_stats &) = delete;
+    ~circular_stats() { circular_stats_registry::instance().remove(this); }
+
+    // @brief  Names the %circular_vector in dumps, @a label must outlive it
+    void label(const char *label) { label_.store(label, std::memory_order_relaxed); }
+    const char *label() const     { return label_.load(std::memory_order_relaxed); }
+
+    // @return  The number of times the storage was replaced or grown in place
+    std::size_t reallocations() const      { return get(reallocations_); }
+    // @return  The elements moved by those reallocations
+    std::size_t elements_relocated() const { return get(elements_relocated_); }
+    // @return  The largest size() and capacity() reached
+    std::size_t peak_size() const          { return get(peak_size_); }
+    std::size_t peak_capacity() const      { return get(peak_capacity_); }
+    // @return  The elements added and removed at each end, bulk operations count
+    //          every element and an overwrite counts as a push and a pop
+    std::size_t push_front_count() const   { return get(push_front_); }
+    std::size_t push_back_count() const    { return get(push_back_); }
+    std::size_t pop_front_count() const    { return get(pop_front_); }
+    std::size_t pop_back_count() const     { return get(pop_back_); }
+    // @return  The number of times the start or end index crossed the end of the
+    //          storage array
+    std::size_t wraps() const              { return get(wraps_); }
+
+    // @brief  Sets every counter to 0, e.g. at the start of a reporting interval
+    void reset() {
+      set(reallocations_, 0);
+      set(elements_relocated_, 0);
+      set(peak_size_, 0);
+      set(peak_capacity_, 0);
+      set(push_front_, 0);
+      set(push_back_, 0);
+      set(pop_front_, 0);
+      set(pop_back_, 0);
+      set(wraps_, 0);
+    }
+    // @return  A copy of the counters
+    circular_stats_registry::entry snapshot() const {
+      circular_stats_registry::entry e = {label(), reallocations(), elements_relocated(),
+        peak_size(), peak_capacity(), push_front_count(), push_back_count(),
+        pop_front_count(), pop_back_count(), wraps()};
+      return e;
+    }
+
+    // POLICY:
+    template <typename size_type>
+    void pushed(bool back, size_type n, bool wrapped, size_type size, size_type capacity) {
+      add(back ? push_back_ : push_front_, n);
+      if (wrapped)
+        add(wraps_, 1);
+      raise(peak_size_, size);
+      raise(peak_capacity_, capacity);
+    }
+    template <typename size_type>
+    void popped(bool back, size_type n, bool wrapped) {
+      add(back ? pop_back_ : pop_front_, n);
+      if (wrapped)
+        add(wraps_, 1);
+    }
+    template <typename size_type>
+    void reallocated(size_type, size_type new_capacity, size_type relocated) {
+      add(reallocations_, 1);
+      add(elements_relocated_, relocated);
+      raise(peak_capacity_, new_capacity);
+    }
+
+  private:
+    friend class circular_stats_registry;
+    typedef std::atomic<std::size_t> counter;
+
+    static std::size_t get(const counter &c) { return c.load(std::memory_order_relaxed); }
+    static void set(counter &c, std::size_t n) { c.store(n, std::memory_order_relaxed); }
+    // A single writer, so no read-modify-write instruction is needed
+    static void add(counter &c, std::size_t n) { set(c, get(c) + n); }
+    static void raise(counter &c, std::size_t n) {
+      if (n > get(c))
+        set(c, n);
+    }
+
+    std::atomic<const char *> label_;
+    counter reallocations_;
+    counter elements_relocated_;
+    counter peak_size_;
+    counter peak_capacity_;
+    counter push_front_;
+    counter push_back_;
+    counter pop_front_;
+    counter pop_back_;
+    counter wraps_;
+    // Links of the registry, guarded by its mutex
+    circular_stats *prev_;
+    circular_stats *next_;
+};
+
+void circular_stats_registry::add(circular_stats *stats) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats->next_ = head_;
+  if (head_)
+    head_->prev_ = stats;
+  head_ = stats;
+  ++size_;
+}
+
+void circular_stats_registry::remove(circular_stats *stats) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stats->prev_)
+    stats->prev_->next_ = stats->next_;
+  else
+    head_ = stats->next_;
+  if (stats->next_)
+    stats->next_->prev_ = stats->prev_;
+  --size_;
+}
+
+std::vector<circular_stats_registry::entry> circular_stats_registry::snapshot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<entry> entries;
+  entries.reserve(size_);
+  for (const circular_stats *stats = head_; stats; stats = stats->next_)
+    entries.push_back(stats->snapshot());
+  return entries;
+}
+
+void circular_stats_registry::dump(std::ostream &os) const {
+  const std::vector<entry> entries = snapshot();
+  for (std::size_t x = 0; x < entries.size(); ++x) {
+    const entry &e = entries[x];
+    os << e.label << ": reallocations " << e.reallocations << ", relocated " << e.elements_relocated
+      << ", peak size " << e.peak_size << ", peak capacity " << e.peak_capacity
+      << ", push_front " << e.push_front << ", push_back " << e.push_back
+      << ", pop_front " << e.pop_front << ", pop_back " << e.pop_back
+      << ", wraps " << e.wraps << "\n";
+  }
+  os.flush();
+}
+
+#endif
@@ -0,0 +1,360 @@
+/* ---------------------------------------------------------------------------
+** This software is in the public domain, furnished "as is", without technical
+** support, and with no warranty, express or implied, as to its usefulness for
+** any purpose.
+**
+** circular_vector_window.h
+** Sliding window aggregates over a %circular_vector, kept up to date as
+** elements enter and leave at either end. Any associative monoid is folded
+** over the window with two stacks of partial aggregates, and
+** circular_window_stats adds a running sum and sum of squares for the mean
+** and variance. Every query is O(1).
+**
+**
+** Author: Konrad Janica
+** -------------------------------------------------------------------------*/
+
+#ifndef CIRCULAR_VECTOR_WINDOW_HPP_
+#define CIRCULAR_VECTOR_WINDOW_HPP_
+
+#include "circular_vector.h"
+
+#include <algorithm>   // std::min, std::max
+#include <cstddef>     // std::size_t
+#include <limits>      // std::numeric_limits
+#include <memory>      // std::allocator, std::allocator_traits
+#include <stdexcept>   // std::invalid_argument
+#include <utility>     // std::pair
+
+// MONOIDS:
+//   A monoid folded over a circular_window provides
+//     typedef ... value_type;                                  - The aggregate type
+//     value_type identity() const;                             - The aggregate of no elements
+//     value_type lift(const T &x) const;                       - The aggregate of @a x alone
+//     value_type combine(const value_type &a, const value_type &b) const;
+//                                                              - The aggregate of the elements of
+//                                                                @a a followed by those of @a b
+//   combine must be associative, it need not be commutative.
+
+// The sum of the elements in @a _Acc
+template <typename _T, typename _Acc = _T>
+struct circular_sum_monoid {
+  typedef _Acc value_type;
+  value_type identity() const                                        { return value_type(); }
+  value_type lift(const _T &x) const                                 { return value_type(x); }
+  value_type combine(const value_type &a, const value_type &b) const { return a + b; }
+};
+
+// The smallest element, the identity is the largest value of an arithmetic _T
+template <typename _T>
+struct circular_min_monoid {
+  typedef _T value_type;
+  value_type identity() const {
+    return std::numeric_limits<_T>::has_infinity ? std::numeric_limits<_T>::infinity()
+                                                 : std::numeric_limits<_T>::max();
+  }
+  value_type lift(const _T &x) const                                 { return x; }
+  value_type combine(const value_type &a, const value_type &b) const { return std::min(a, b); }
+};
+
+// The largest element, the identity is the smallest value of an arithmetic _T
+template <typename _T>
+struct circular_max_monoid {
+  typedef _T value_type;
+  value_type identity() const {
+    return std::numeric_limits<_T>::has_infinity ? -std::numeric_limits<_T>::infinity()
+                                                 : std::numeric_limits<_T>::lowest();
+  }
+  value_type lift(const _T &x) const                                 { return x; }
+  value_type combine(const value_type &a, const value_type &b) const { return std::max(a, b); }
+};
+
+// The smallest and the largest element, with one stack entry for both
+template <typename _T>
+struct circular_minmax_monoid {
+  typedef std::pair<_T, _T> value_type;
+  value_type identity() const {
+    return value_type(circular_min_monoid<_T>().identity(), circular_max_monoid<_T>().identity());
+  }
+  value_type lift(const _T &x) const { return value_type(x, x); }
+  value_type combine(const value_type &a, const value_type &b) const {
+    return value_type(std::min(a.first, b.first), std::max(a.second, b.second));
+  }
+};
+
+// A window of at most max_size() elements with the fold of _Monoid over them
+//   The elements live in a %circular_vector. The window is split in two, a front part
+//   and a back part, each with a stack of partial aggregates: the front stack holds the
+//   fold of each suffix of the front part and the back stack the fold of each prefix of
+//   the back part, so the whole window is the combine of the two tops. A push or a pop
+//   at either end is a push or a pop of one stack. Popping from an end whose stack is
+//   empty first splits the window in half again and rebuilds both stacks, which is
+//   O(n) but happens at most once every n / 2 pops, O(1) amortized.
+//   Pushing to a full window evicts the element at the other end first.
+template <typename _T, typename _Monoid, typename _Alloc = std::allocator<_T> >
+class circular_window {
+  public:
+    // TYPEDEFS:
+    typedef circular_window<_T, _Monoid, _Alloc>  self_type;
+    typedef _T                                    value_type;
+    typedef _Monoid                               monoid_type;
+    typedef typename _Monoid::value_type          aggregate_type;
+    typedef circular_vector<_T, _Alloc>           container_type;
+    typedef typename container_type::size_type    size_type;
+    typedef typename container_type::const_reference const_reference;
+    typedef typename std::allocator_traits<_Alloc>::template rebind_alloc<aggregate_type> aggregate_allocator;
+    typedef circular_vector<aggregate_type, aggregate_allocator> stack_type;
+
+    // CONSTRUCTORS:
+    // @brief  Constructs an empty window
+    // @param  max_size  The largest number of elements held before a push evicts one
+    // @throws  std::invalid_argument  With a zero @a max_size
+    explicit circular_window(size_type max_size, const _Monoid &monoid = _Monoid(), const _Alloc &alloc = _Alloc())
+      : max_size_(max_size), monoid_(monoid),
+        elements_(initial_capacity(max_size), alloc),
+        front_(initial_capacity(max_size), aggregate_allocator(alloc)),
+        back_(initial_capacity(max_size), aggregate_allocator(alloc)) {
+          if (max_size == 0)
+            throw std::invalid_argument("circular_window requires a positive max_size");
+        }
+
+    // CAPACITIES:
+    // @brief  Returns the amount of elements in the window
+    size_type size() const     { return elements_.size(); }
+    // @brief  Returns the largest amount of elements in the window
+    size_type max_size() const { return max_size_; }
+    // @brief  Returns true if there are no elements in the window
+    bool empty() const         { return elements_.empty(); }
+    // @brief  Returns true if the next push evicts an element
+    bool full() const          { return elements_.size() == max_size_; }
+
+    // ELEMENT ACCESS:
+    // @brief  Returns the element @a n places from the front, unchecked
+    const_reference operator [] (size_type n) const { return elements_[n]; }
+    const_reference front() const                   { return elements_.front(); }
+    const_reference back() const                    { return elements_.back(); }
+    // @brief  Returns the elements of the window from front to back
+    const container_type &elements() const          { return elements_; }
+    const _Monoid &monoid() const                   { return monoid_; }
+
+    // AGGREGATES:
+    // @return  The fold of the monoid over the window from front to back, the
+    //          identity if it is empty. O(1)
+    aggregate_type aggregate() const {
+      if (front_.empty())
+        return back_.empty() ? monoid_.identity() : back_.back();
+      if (back_.empty())
+        return front_.back();
+      return monoid_.combine(front_.back(), back_.back());
+    }
+
+    // MODIFIERS:
+    // @brief  Adds a copy of @a val to the back, evicting the front if the window is full
+    void push_back(const value_type &val) {
+      if (full()) {
+        // Copied before the eviction, @a val may refer to the element evicted
+        const value_type copy(val);
+        pop_front();
+        push_back(copy);
+        return;
+      }
+      back_.push_back(back_.empty() ? monoid_.lift(val) : monoid_.combine(back_.back(), monoid_.lift(val)));
+      try {
+        elements_.push_back(val);
+      } catch (...) {
+        back_.pop_back();
+        throw;
+      }
+    }
+    // @brief  Adds a copy of @a val to the front, evicting the back if the window is full
+    void push_front(const value_type &val) {
+      if (full()) {
+        const value_type copy(val);
+        pop_back();
+        push_front(copy);
+        return;
+      }
+      front_.push_back(front_.empty() ? monoid_.lift(val) : monoid_.combine(monoid_.lift(val), front_.back()));
+      try {
+        elements_.push_front(val);
+      } catch (...) {
+        front_.pop_back();
+        throw;
+      }
+    }
+    // @brief  Removes the front element
+    // @warn  Undefined behaviour on an empty window
+    void pop_front() {
+      if (front_.empty())
+        rebuild((elements_.size() + 1) / 2);
+      front_.pop_back();
+      elements_.pop_front();
+    }
+    // @brief  Removes the back element
+    // @warn  Undefined behaviour on an empty window
+    void pop_back() {
+      if (back_.empty())
+        rebuild(elements_.size() / 2);
+      back_.pop_back();
+      elements_.pop_back();
+    }
+    // @brief  Removes every element
+    void clear() {
+      elements_.clear();
+      front_.clear();
+      back_.clear();
+    }
+
+  private:
+    // The storage starts small for windows bounded only by memory
+    static size_type initial_capacity(size_type max_size) {
+      return max_size < container_type::kDefaultCapacity ? std::max<size_type>(max_size, 1)
+                                                         : container_type::kDefaultCapacity;
+    }
+
+    // @brief  Moves the split so the first @a split elements form the front part and
+    //         refolds both stacks
+    void rebuild(size_type split) {
+      front_.clear();
+      back_.clear();
+      for (size_type x = split; x-- > 0; )
+        front_.push_back(front_.empty() ? monoid_.lift(elements_[x])
+                                        : monoid_.combine(monoid_.lift(elements_[x]), front_.back()));
+      for (size_type x = split; x < elements_.size(); ++x)
+        back_.push_back(back_.empty() ? monoid_.lift(elements_[x])
+                                      : monoid_.combine(back_.back(), monoid_.lift(elements_[x])));
+    }
+
+    size_type max_size_;
+    _Monoid monoid_;
+    container_type elements_;
+    // The top of front_ is the fold of the whole front part, the top of back_ the fold of
+    // the whole back part
+    stack_type front_;
+    stack_type back_;
+};
+
+// The sum, mean, variance, minimum and maximum of a sliding window
+//   The sum and the sum of squares are updated in O(1) by every push and pop, in _Acc.
+//   They are taken relative to the first element pushed into the empty window, which
+//   keeps the variance accurate for data far from zero. The minimum and maximum are a
+//   circular_window of circular_minmax_monoid, O(1) amortized.
+//   e.g. the statistics of the last 1000 samples
+//     circular_window_stats<double> window(1000);
+//     window.push_back(sample);
+//     double mean = window.mean(), sd = std::sqrt(window.variance());
+template <typename _T, typename _Acc = double, typename _Alloc = std::allocator<_T> >
+class circular_window_stats {
+  public:
+    // TYPEDEFS:
+    typedef circular_window<_T, circular_minmax_monoid<_T>, _Alloc> window_type;
+    typedef _T                                    value_type;
+    typedef _Acc                                  accumulator_type;
+    typedef typename window_type::container_type  container_type;
+    typedef typename window_type::size_type       size_type;
+
+    // CONSTRUCTORS:
+    // @param  max_size  The largest number of elements held before a push evicts one
+    // @throws  std::invalid_argument  With a zero @a max_size
+    explicit circular_window_stats(size_type max_size, const _Alloc &alloc = _Alloc())
+      : window_(max_size, circular_minmax_monoid<_T>(), alloc), shift_(), sum_(), sum_squares_() {}
+
+    // CAPACITIES:
+    size_type size() const     { return window_.size(); }
+    size_type max_size() const { return window_.max_size(); }
+    bool empty() const         { return window_.empty(); }
+    bool full() const          { return window_.full(); }
+
+    // ELEMENT ACCESS:
+    // @brief  Returns the elements of the window from front to back
+    const container_type &elements() const { return window_.elements(); }
+
+    // AGGREGATES:
+    // @return  The sum of the elements
+    _Acc sum() const  { return sum_ + shift_ * _Acc(size()); }
+    // @return  The arithmetic mean of the elements
+    // @warn  Undefined behaviour on an empty window
+    _Acc mean() const { return shift_ + sum_ / _Acc(size()); }
+    // @return  The population variance of the elements, divided by size()
+    // @warn  Undefined behaviour on an empty window
+    _Acc variance() const {
+      const _Acc n = _Acc(size());
+      const _Acc v = (sum_squares_ - sum_ * sum_ / n) / n;
+      return v < _Acc() ? _Acc() : v;
+    }
+    // @return  The sample variance of the elements, divided by size() - 1
+    // @warn  Undefined behaviour with fewer than two elements
+    _Acc sample_variance() const { return variance() * _Acc(size()) / _Acc(size() - 1); }
+    // @return  The smallest and the largest element
+    // @warn  Undefined behaviour on an empty window
+    _T min() const { return window_.aggregate().first; }
+    _T max() const { return window_.aggregate().second; }
+
+    // MODIFIERS:
+    // @brief  Adds @a val to the back, evicting the front if the window is full
+    void push_back(const value_type &val) {
+      if (window_.full()) {
+        // Copied before the eviction, @a val may refer to the element evicted
+        const value_type copy(val);
+        pop_front();
+        push_back(copy);
+        return;
+      }
+      entered(val);
+      window_.push_back(val);
+    }
+    // @brief  Adds @a val to the front, evicting the back if the window is full
+    void push_front(const value_type &val) {
+      if (window_.full()) {
+        const value_type copy(val);
+        pop_back();
+        push_front(copy);
+        return;
+      }
+      entered(val);
+      window_.push_front(val);
+    }
+    // @brief  Removes the front element
+    // @warn  Undefined behaviour on an empty window
+    void pop_front() {
+      left(window_.front());
+      window_.pop_front();
+    }
+    // @brief  Removes the back element
+    // @warn  Undefined behaviour on an empty window
+    void pop_back() {
+      left(window_.back());
+      window_.pop_back();
+    }
+    // @brief  Removes every element
+    void clear() {
+      window_.clear();
+      shift_ = sum_ = sum_squares_ = _Acc();
+    }
+
+  private:
+    void entered(const value_type &val) {
+      if (window_.empty())
+        shift_ = _Acc(val);
+      const _Acc d = _Acc(val) - shift_;
+      sum_ += d;
+      sum_squares_ += d * d;
+    }
+    void left(const value_type &val) {
+      if (window_.size() == 1) {
+        // The last element, start again from exact zeros
+        shift_ = sum_ = sum_squares_ = _Acc();
+        return;
+      }
+      const _Acc d = _Acc(val) - shift_;
+      sum_ -= d;
+      sum_squares_ -= d * d;
+    }
+
+    window_type window_;
+    _Acc shift_;
+    _Acc sum_;
+    _Acc sum_squares_;
+};
+
+#endif
@@ -0,0 +1,445 @@
+/* ---------------------------------------------------------------------------
+** This software is in the public domain, furnished "as is", without technical
+** support, and with no warranty, express or implied, as to its usefulness for
+** any purpose.
+**
+** concurrent_circular_vector.h
+** Thread safe queues built on the %circular_vector storage layout: a single
+** array wrapped by an index policy, with elements constructed and destroyed
+** through the allocator as they are pushed and popped.
+**
+**
+** Author: Konrad Janica
+** -------------------------------------------------------------------------*/
+
+#ifndef CONCURRENT_CIRCULAR_VECTOR_HPP_
+#define CONCURRENT_CIRCULAR_VECTOR_HPP_
+
+#include "circular_vector.h"
+
+#include <atomic>      // std::atomic, std::memory_order
+#include <cstddef>     // std::size_t
+#include <memory>      // std::allocator_traits
+#include <thread>      // std::this_thread::yield
+#include <type_traits> // std::aligned_storage
+
+// A lock free Single Producer Single Consumer %circular_vector
+//   One thread pushes to the tail while another thread pops from the head,
+//   without locks and without a shared size counter.
+//   The producer owns the tail index and the consumer owns the head index. Both are
+//   monotonically increasing counts of pushed and popped elements, wrapped onto
+//   the storage array by the index policy, so size is tail - head and a full
+//   buffer is told apart from an empty one without a spare slot.
+//   Each side keeps a cached copy of the other side's index and only reloads it
+//   (with acquire ordering) when the cached value says full or empty. Publishing
+//   an index uses release ordering, so an element is completely constructed
+//   before the consumer can see it and completely destroyed before the producer
+//   can reuse its slot.
+//   Producer and consumer state live on separate cache lines.
+//   The capacity is fixed at construction. The default power of two index policy
+//   wraps with a mask, circular_modulo_index also accepts the unbounded counts.
+template <typename _T, typename _Alloc = std::allocator<_T>, typename _Index = circular_pow2_index>
+class spsc_circular_vector {
+  public:
+    // TYPEDEFS:
+    typedef spsc_circular_vector<_T, _Alloc, _Index> self_type;
+    typedef _Alloc                                allocator_type;
+    typedef _Index                                index_policy;
+    // Every allocator call goes through std::allocator_traits
+    typedef std::allocator_traits<_Alloc>         alloc_traits;
+    typedef typename alloc_traits::value_type     value_type;
+    typedef typename alloc_traits::pointer        pointer;
+    typedef typename alloc_traits::const_pointer  const_pointer;
+    typedef value_type &                          reference;
+    typedef const value_type &                    const_reference;
+    typedef typename alloc_traits::size_type      size_type;
+    typedef typename alloc_traits::difference_type difference_type;
+
+    // CONSTANTS:
+    static const size_type kDefaultCapacity = 1024;
+    // Assumed size of a cache line
+    static const std::size_t kCacheLine = 64;
+
+    // CONSTRUCTORS:
+    // @brief  Constructs an empty queue
+    // @param  capacity  The fixed allocated storage, rounded by the index policy
+    // @throws  std::invalid_argument  With a zero capacity
+    explicit spsc_circular_vector(size_type capacity = kDefaultCapacity, const _Alloc &alloc = _Alloc())
+      : shared_(capacity, alloc) {
+        producer_.tail.store(0, std::memory_order_relaxed);
+        producer_.cached_head = 0;
+        consumer_.head.store(0, std::memory_order_relaxed);
+        consumer_.cached_tail = 0;
+      }
+    spsc_circular_vector(const spsc_circular_vector &) = delete;
+    spsc_circular_vector &operator = (const spsc_circular_vector &) = delete;
+
+    // DECONSTRUCTORS:
+    // @warn  Neither the producer nor the consumer may be using the queue
+    ~spsc_circular_vector() {
+      size_type head = consumer_.head.load(std::memory_order_relaxed);
+      const size_type tail = producer_.tail.load(std::memory_order_relaxed);
+      for (; head != tail; ++head)
+        alloc_traits::destroy(shared_.alloc, slot(head));
+    }
+
+    // CAPACITIES:
+    // @brief  Returns the fixed storage capacity
+    size_type capacity() const { return shared_.capacity; };
+    // @brief  Returns the amount of elements in the queue. Exact when called by the
+    //         producer or consumer while the other side is idle, a snapshot otherwise
+    size_type size() const {
+      // Loading the head first guarantees tail >= head
+      const size_type head = consumer_.head.load(std::memory_order_acquire);
+      return producer_.tail.load(std::memory_order_acquire) - head;
+    };
+    // @brief  Returns true if there are no elements in the queue, see size()
+    bool empty() const         { return size() == 0; };
+
+    // PRODUCER:
+    // @brief  Adds a copy of @a val to the tail if there is room
+    // @return  True iff the element was added, false if the queue is full
+    // @warn  Only the producer thread may call this function
+    bool try_push(const value_type &val) { return try_emplace(val); }
+    // @brief  Moves @a val to the tail if there is room, @a val is untouched otherwise
+    // @return  True iff the element was added, false if the queue is full
+    // @warn  Only the producer thread may call this function
+    bool try_push(value_type &&val)      { return try_emplace(std::move(val)); }
+    // @brief  Constructs an element in place at the tail if there is room
+    // @param  args  Arguments forwarded to the element's constructor
+    // @return  True iff the element was added, false if the queue is full
+    // @warn  Only the producer thread may call this function
+    template <typename... Args>
+      bool try_emplace(Args&&... args) {
+        const size_type tail = producer_.tail.load(std::memory_order_relaxed);
+        if (free_slots(tail) == 0)
+          return false;
+        alloc_traits::construct(shared_.alloc, slot(tail), std::forward<Args>(args)...);
+        producer_.tail.store(tail + 1, std::memory_order_release);
+        return true;
+      }
+    // @brief  Adds copies of up to @a n elements starting at @a first to the tail,
+    //         publishing them to the consumer at once
+    // @param  first  An input iterator
+    // @param  n      Number of elements available at @a first
+    // @return  The number of elements added, less than @a n if the queue filled up
+    // @warn  Only the producer thread may call this function
+    template <typename iter>
+      size_type try_push_n(iter first, size_type n) {
+        const size_type tail = producer_.tail.load(std::memory_order_relaxed);
+        n = std::min(n, free_slots(tail, n));
+        size_type x = 0;
+        try {
+          for (; x < n; ++x, ++first)
+            alloc_traits::construct(shared_.alloc, slot(tail + x), *first);
+        } catch (...) {
+          // Publish what was constructed, the rest of the batch is not added
+          producer_.tail.store(tail + x, std::memory_order_release);
+          throw;
+        }
+        producer_.tail.store(tail + n, std::memory_order_release);
+        return n;
+      }
+
+    // CONSUMER:
+    // @brief  Moves the first element into @a val and removes it, if there is one
+    // @return  True iff an element was removed, false if the queue is empty
+    // @warn  Only the consumer thread may call this function
+    bool try_pop(value_type &val) {
+      const size_type head = consumer_.head.load(std::memory_order_relaxed);
+      if (used_slots(head) == 0)
+        return false;
+      val = std::move(*slot(head));
+      alloc_traits::destroy(shared_.alloc, slot(head));
+      consumer_.head.store(head + 1, std::memory_order_release);
+      return true;
+    }
+    // @brief  Moves up to @a n elements from the head into @a out and removes them,
+    //         releasing their slots to the producer at once
+    // @param  out  An output iterator
+    // @param  n    Maximum number of elements to remove
+    // @return  The number of elements removed, less than @a n if the queue emptied
+    // @warn  Only the consumer thread may call this function
+    template <typename out_iter>
+      size_type try_pop_n(out_iter out, size_type n) {
+        const size_type head = consumer_.head.load(std::memory_order_relaxed);
+        n = std::min(n, used_slots(head, n));
+        for (size_type x = 0; x < n; ++x, ++out) {
+          *out = std::move(*slot(head + x));
+          alloc_traits::destroy(shared_.alloc, slot(head + x));
+        }
+        consumer_.head.store(head + n, std::memory_order_release);
+        return n;
+      }
+    // @return  A pointer to the first element, or nullptr if the queue is empty.
+    //          The element stays valid until pop_front()
+    // @warn  Only the consumer thread may call this function
+    pointer front() {
+      const size_type head = consumer_.head.load(std::memory_order_relaxed);
+      return used_slots(head) == 0 ? nullptr : slot(head);
+    }
+    // @brief  Removes the first element
+    // @warn  Only the consumer thread may call this function.
+    //        Undefined behaviour unless front() returned an element
+    void pop_front() {
+      const size_type head = consumer_.head.load(std::memory_order_relaxed);
+      alloc_traits::destroy(shared_.alloc, slot(head));
+      consumer_.head.store(head + 1, std::memory_order_release);
+    }
+
+  private:
+    // State written only at construction, read by both threads
+    struct alignas(kCacheLine) shared_state {
+      shared_state(size_type n, const _Alloc &a)
+        : capacity(_Index::round_capacity(n)), alloc(a), array(alloc_traits::allocate(alloc, capacity)) {
+          if (n == 0) {
+            alloc_traits::deallocate(alloc, array, capacity);
+            throw std::invalid_argument("invalid capacity");
+          }
+        }
+      ~shared_state() { alloc_traits::deallocate(alloc, array, capacity); }
+      // Fixed allocated memory of the queue
+      size_type capacity;
+      // Defined Memory Allocator
+      _Alloc alloc;
+      // The Data Storage Array
+      value_type *array;
+    };
+    // State written by the producer
+    struct alignas(kCacheLine) producer_state {
+      // Count of pushed elements
+      std::atomic<size_type> tail;
+      // Last head seen by the producer
+      size_type cached_head;
+    };
+    // State written by the consumer
+    struct alignas(kCacheLine) consumer_state {
+      // Count of popped elements
+      std::atomic<size_type> head;
+      // Last tail seen by the consumer
+      size_type cached_tail;
+    };
+
+    shared_state shared_;
+    producer_state producer_;
+    consumer_state consumer_;
+
+    // HELPER FUNCTIONS:
+    // @brief  Returns the storage slot of the element with count @a n
+    value_type *slot(size_type n) const { return shared_.array + _Index::wrap(n, shared_.capacity); }
+    // @brief  Producer side number of free slots, reloading the head only when the
+    //         cached value shows fewer than @a wanted
+    size_type free_slots(size_type tail, size_type wanted = 1) {
+      size_type free = shared_.capacity - (tail - producer_.cached_head);
+      if (free < wanted) {
+        producer_.cached_head = consumer_.head.load(std::memory_order_acquire);
+        free = shared_.capacity - (tail - producer_.cached_head);
+      }
+      return free;
+    }
+    // @brief  Consumer side number of elements, reloading the tail only when the
+    //         cached value shows fewer than @a wanted
+    size_type used_slots(size_type head, size_type wanted = 1) {
+      size_type used = consumer_.cached_tail - head;
+      if (used < wanted) {
+        consumer_.cached_tail = producer_.tail.load(std::memory_order_acquire);
+        used = consumer_.cached_tail - head;
+      }
+      return used;
+    }
+};
+
+// A bounded lock free Multi Producer Multi Consumer %circular_vector
+//   Any number of threads push to the tail and pop from the head (D. Vyukov's bounded
+//   MPMC queue). Every slot of the storage array carries a sequence number telling
+//   which lap of the ring it is ready for:
+//     sequence == n      - The slot is free for the element with count n
+//     sequence == n + 1  - The slot holds the element with count n
+//   A producer claims count n of the tail by compare and swap once the slot's sequence
+//   is n, constructs the element and publishes it by storing n + 1 with release
+//   ordering. A consumer claims count n of the head once the sequence is n + 1, moves
+//   the element out, destroys it and frees the slot for the next lap by storing
+//   n + capacity. Producers only contend with producers and consumers with consumers,
+//   on the tail and head counts which live on separate cache lines.
+//   Elements are constructed and destroyed through @a _Alloc, the slots are
+//   allocated through @a _Alloc rebound to the slot type.
+//   The capacity is fixed at construction.
+template <typename _T, typename _Alloc = std::allocator<_T>, typename _Index = circular_pow2_index>
+class mpmc_circular_vector {
+  public:
+    // TYPEDEFS:
+    typedef mpmc_circular_vector<_T, _Alloc, _Index> self_type;
+    typedef _Alloc                                allocator_type;
+    typedef _Index                                index_policy;
+    // Every allocator call goes through std::allocator_traits
+    typedef std::allocator_traits<_Alloc>         alloc_traits;
+    typedef typename alloc_traits::value_type     value_type;
+    typedef typename alloc_traits::pointer        pointer;
+    typedef typename alloc_traits::const_pointer  const_pointer;
+    typedef value_type &                          reference;
+    typedef const value_type &                    const_reference;
+    typedef typename alloc_traits::size_type      size_type;
+    typedef typename alloc_traits::difference_type difference_type;
+
+    // CONSTANTS:
+    static const size_type kDefaultCapacity = 1024;
+    // Assumed size of a cache line
+    static const std::size_t kCacheLine = 64;
+    // Failed attempts a blocking push or pop spins for before yielding the thread
+    static const int kSpinCount = 64;
+
+    // CONSTRUCTORS:
+    // @brief  Constructs an empty queue
+    // @param  capacity  The fixed allocated storage, rounded by the index policy
+    // @throws  std::invalid_argument  With a zero capacity
+    explicit mpmc_circular_vector(size_type capacity = kDefaultCapacity, const _Alloc &alloc = _Alloc())
+      : capacity_(_Index::round_capacity(capacity)), alloc_(alloc), slot_alloc_(alloc),
+      slots_(nullptr) {
+        if (capacity == 0)
+          throw std::invalid_argument("invalid capacity");
+        slots_ = cell_traits::allocate(slot_alloc_, capacity_);
+        for (size_type x = 0; x < capacity_; ++x)
+          new (&slots_[x].sequence) std::atomic<size_type>(x);
+        tail_.count.store(0, std::memory_order_relaxed);
+        head_.count.store(0, std::memory_order_relaxed);
+      }
+    mpmc_circular_vector(const mpmc_circular_vector &) = delete;
+    mpmc_circular_vector &operator = (const mpmc_circular_vector &) = delete;
+
+    // DECONSTRUCTORS:
+    // @warn  No thread may be using the queue
+    ~mpmc_circular_vector() {
+      const size_type tail = tail_.count.load(std::memory_order_relaxed);
+      for (size_type head = head_.count.load(std::memory_order_relaxed); head != tail; ++head)
+        alloc_traits::destroy(alloc_, slot(head).element());
+      cell_traits::deallocate(slot_alloc_, slots_, capacity_);
+    }
+
+    // CAPACITIES:
+    // @brief  Returns the fixed storage capacity
+    size_type capacity() const { return capacity_; };
+    // @brief  Returns a snapshot of the amount of elements in the queue, elements
+    //         being pushed or popped concurrently may or may not be counted
+    size_type size() const {
+      const size_type head = head_.count.load(std::memory_order_acquire);
+      const size_type tail = tail_.count.load(std::memory_order_acquire);
+      return tail > head ? tail - head : 0;
+    };
+    // @brief  Returns true if there are no elements in the queue, see size()
+    bool empty() const         { return size() == 0; };
+
+    // NON-BLOCKING:
+    // @brief  Adds a copy of @a val to the tail if there is room
+    // @return  True iff the element was added, false if the queue is full
+    bool try_push(const value_type &val) { return try_emplace(val); }
+    // @brief  Moves @a val to the tail if there is room, @a val is untouched otherwise
+    // @return  True iff the element was added, false if the queue is full
+    bool try_push(value_type &&val)      { return try_emplace(std::move(val)); }
+    // @brief  Constructs an element in place at the tail if there is room
+    // @param  args  Arguments forwarded to the element's constructor
+    // @return  True iff the element was added, false if the queue is full
+    // @warn  If the element's constructor throws, the claimed slot is never published
+    //        and the queue stops making progress. Use nothrow constructible elements
+    template <typename... Args>
+      bool try_emplace(Args&&... args) {
+        size_type tail = tail_.count.load(std::memory_order_relaxed);
+        for (;;) {
+          cell &c = slot(tail);
+          const difference_type lap = difference_type(c.sequence.load(std::memory_order_acquire) - tail);
+          if (lap == 0) {
+            if (tail_.count.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+              break;
+          } else if (lap < 0) {
+            // The slot still holds the element from the previous lap
+            return false;
+          } else {
+            tail = tail_.count.load(std::memory_order_relaxed);
+          }
+        }
+        cell &c = slot(tail);
+        alloc_traits::construct(alloc_, c.element(), std::forward<Args>(args)...);
+        c.sequence.store(tail + 1, std::memory_order_release);
+        return true;
+      }
+    // @brief  Moves the first element into @a val and removes it, if there is one
+    // @return  True iff an element was removed, false if the queue is empty
+    bool try_pop(value_type &val) {
+      size_type head = head_.count.load(std::memory_order_relaxed);
+      for (;;) {
+        cell &c = slot(head);
+        const difference_type lap = difference_type(c.sequence.load(std::memory_order_acquire) - (head + 1));
+        if (lap == 0) {
+          if (head_.count.compare_exchange_weak(head, head + 1, std::memory_order_relaxed))
+            break;
+        } else if (lap < 0) {
+          // The element for this lap has not been published
+          return false;
+        } else {
+          head = head_.count.load(std::memory_order_relaxed);
+        }
+      }
+      cell &c = slot(head);
+      val = std::move(*c.element());
+      alloc_traits::destroy(alloc_, c.element());
+      c.sequence.store(head + capacity_, std::memory_order_release);
+      return true;
+    }
+
+    // BLOCKING:
+    // @brief  Adds a copy of @a val to the tail, waiting while the queue is full
+    void push(const value_type &val)     { emplace(val); }
+    // @brief  Moves @a val to the tail, waiting while the queue is full
+    void push(value_type &&val)          { emplace(std::move(val)); }
+    // @brief  Constructs an element in place at the tail, waiting while the queue is full.
+    //         Spins for kSpinCount attempts, then yields the thread between attempts
+    template <typename... Args>
+      void emplace(Args&&... args) {
+        for (int spins = 0; !try_emplace(std::forward<Args>(args)...); ++spins)
+          backoff(spins);
+      }
+    // @brief  Moves the first element into @a val and removes it, waiting while the
+    //         queue is empty. Spins for kSpinCount attempts, then yields the thread
+    //         between attempts
+    void pop(value_type &val) {
+      for (int spins = 0; !try_pop(val); ++spins)
+        backoff(spins);
+    }
+
+  private:
+    // A slot of the storage array, the element and the lap it is ready for
+    struct cell {
+      std::atomic<size_type> sequence;
+      typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type storage;
+      value_type *element() { return reinterpret_cast<value_type *>(&storage); }
+    };
+    typedef typename alloc_traits::template rebind_alloc<cell> cell_allocator;
+    typedef std::allocator_traits<cell_allocator> cell_traits;
+    // A count padded to its own cache line
+    struct alignas(kCacheLine) padded_count {
+      std::atomic<size_type> count;
+    };
+
+    // Fixed allocated memory of the queue
+    size_type capacity_;
+    // Defined Memory Allocator, constructs and destroys the elements
+    _Alloc alloc_;
+    // Allocates the slots
+    cell_allocator slot_alloc_;
+    // The Data Storage Array
+    cell *slots_;
+    // Count of claimed pushes
+    padded_count tail_;
+    // Count of claimed pops
+    padded_count head_;
+
+    // HELPER FUNCTIONS:
+    // @brief  Returns the slot of the element with count @a n
+    cell &slot(size_type n) const { return slots_[_Index::wrap(n, capacity_)]; }
+    // @brief  Waits before retrying a blocking push or pop
+    static void backoff(int spins) {
+      if (spins >= kSpinCount)
+        std::this_thread::yield();
+    }
+};
+
+#endif
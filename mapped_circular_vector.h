@@ -0,0 +1,476 @@
+/* ---------------------------------------------------------------------------
+** This software is in the public domain, furnished "as is", without technical
+** support, and with no warranty, express or implied, as to its usefulness for
+** any purpose.
+**
+** mapped_circular_vector.h
+** A persistent Circular Vector whose storage is a memory mapped file. The
+** file holds a small header with the indices followed by the storage array,
+** so reopening it costs no parsing. For trivially copyable types. POSIX.
+**
+**
+** Author: Konrad Janica
+** -------------------------------------------------------------------------*/
+
+#ifndef MAPPED_CIRCULAR_VECTOR_HPP_
+#define MAPPED_CIRCULAR_VECTOR_HPP_
+
+#include "circular_vector.h"
+
+#include <cerrno>       // errno
+#include <cstddef>      // std::size_t, std::ptrdiff_t
+#include <cstdint>      // std::uint32_t, std::uint64_t, std::uintptr_t
+#include <algorithm>    // std::min
+#include <cstring>      // std::memcpy
+#include <functional>   // std::less
+#include <stdexcept>    // std::runtime_error, std::out_of_range
+#include <string>       // std::string
+#include <system_error> // std::system_error, std::system_category
+#include <type_traits>  // std::is_trivially_copyable
+#include <vector>       // std::vector
+
+#include <fcntl.h>      // open
+#include <sys/mman.h>   // mmap, mremap, munmap, msync
+#include <sys/stat.h>   // fstat
+#include <unistd.h>     // close, ftruncate, sysconf
+
+// The header at the start of a mapped_circular_vector file, padded to 64 bytes
+//   The indices live here rather than in the object, every update is a store to
+//   the mapping and a reopened file is ready to use as is. grow_capacity and
+//   grow_start_idx journal a grow in progress, grow_capacity is 0 when none is.
+struct circular_mapped_header {
+  std::uint64_t magic;
+  std::uint32_t version;
+  std::uint32_t element_size;
+  std::uint64_t capacity;
+  std::uint64_t start_idx;
+  std::uint64_t end_idx;
+  std::uint64_t size;
+  std::uint64_t grow_capacity;
+  std::uint64_t grow_start_idx;
+};
+static_assert(sizeof(circular_mapped_header) == 64, "the header layout is part of the file format");
+
+// A Circular Vector of trivially copyable elements stored in a memory mapped file
+//   The elements and indices are written straight to the mapping, the kernel
+//   writes them back to the file. sync() is a flush point: once it returns the
+//   file holds every change made before the call. Only the state at sync() is
+//   durable, after a crash the elements may hold any mix of the writes since.
+//   Growing extends the file with ftruncate and remaps it, the elements keep their
+//   indices unless they wrap, when the shorter run is copied past the old layout.
+//   A grow is journaled in the header and synced step by step, a file written back
+//   part way through opens with its old capacity or completes the grow when
+//   reopened. The behaviour when full and the capacity to grow to are selected with
+//   @a _Overflow and @a _Growth as for %circular_vector, a grow is raised to fit the
+//   shorter wrapped run past the old end of the array.
+//   The file must not be opened by two mapped_circular_vectors at once.
+// @warn  The file format is the in memory representation of @a _T, files do not
+//        move between machines of different endianness or layout
+template <typename _T, typename _Overflow = circular_grow,
+          typename _Growth = circular_growth_geometric<> >
+class mapped_circular_vector {
+  static_assert(std::is_trivially_copyable<_T>::value,
+      "mapped_circular_vector stores elements as raw bytes");
+  static_assert(alignof(_T) <= sizeof(circular_mapped_header),
+      "elements follow the 64 byte header");
+
+  public:
+    // TYPEDEFS:
+    typedef mapped_circular_vector<_T, _Overflow, _Growth> self_type;
+    typedef _T                                        value_type;
+    typedef _T *                                      pointer;
+    typedef const _T *                                const_pointer;
+    typedef _T &                                      reference;
+    typedef const _T &                                const_reference;
+    typedef std::size_t                               size_type;
+    typedef std::ptrdiff_t                            difference_type;
+    typedef circular_vector_iterator<self_type, self_type> iterator;
+    typedef circular_vector_iterator<self_type, const self_type, const value_type> const_iterator;
+    typedef std::reverse_iterator<iterator>           reverse_iterator;
+    typedef std::reverse_iterator<const_iterator>     const_reverse_iterator;
+    typedef std::pair<pointer, size_type>             array_range;
+    typedef std::pair<const_pointer, size_type>       const_array_range;
+
+    // CONSTANTS:
+    static const size_type kDefaultCapacity = 1024;
+    // "CIRCVEC" followed by a zero byte, little endian
+    static const std::uint64_t kMagic = 0x0043455643524943ULL;
+    static const std::uint32_t kVersion = 1;
+
+    // CONSTRUCTORS:
+    // @brief  Opens the %mapped_circular_vector stored in @a path, or creates it
+    //         empty with @a capacity reserved if the file is missing or empty
+    // @param  path      The file backing the storage
+    // @param  capacity  The starting capacity of a new file, ignored when reopening
+    // @throws  std::system_error     If the file cannot be opened, sized or mapped
+    // @throws  std::runtime_error    If the file is not a %mapped_circular_vector of
+    //                                 elements of this size
+    // @throws  std::invalid_argument  With a zero capacity for a new file
+    explicit mapped_circular_vector(const std::string &path, size_type capacity = kDefaultCapacity)
+      : fd_(-1), map_(nullptr), map_bytes_(0), header_(nullptr), array_(nullptr) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0)
+          throw std::system_error(errno, std::system_category(), "open " + path);
+        try {
+          struct stat st;
+          if (::fstat(fd_, &st) != 0)
+            throw std::system_error(errno, std::system_category(), "fstat " + path);
+          if (st.st_size == 0) {
+            if (capacity == 0)
+              throw std::invalid_argument("invalid capacity");
+            resize_file(capacity);
+            map(capacity);
+            header_->magic = kMagic;
+            header_->version = kVersion;
+            header_->element_size = sizeof(value_type);
+            header_->capacity = capacity;
+            header_->start_idx = header_->end_idx = header_->size = 0;
+          } else {
+            if (size_type(st.st_size) < sizeof(circular_mapped_header))
+              throw std::runtime_error(path + " is not a mapped_circular_vector file");
+            map((size_type(st.st_size) - sizeof(circular_mapped_header)) / sizeof(value_type));
+            validate(path);
+          }
+        } catch (...) {
+          unmap();
+          ::close(fd_);
+          throw;
+        }
+      }
+    // @brief  Move constructor, takes over the mapping of x
+    mapped_circular_vector(mapped_circular_vector &&x) noexcept
+      : fd_(x.fd_), map_(x.map_), map_bytes_(x.map_bytes_), header_(x.header_), array_(x.array_) {
+        x.fd_ = -1;
+        x.map_ = nullptr;
+        x.header_ = nullptr;
+        x.array_ = nullptr;
+      }
+    mapped_circular_vector &operator = (mapped_circular_vector &&x) noexcept {
+      if (this != &x) {
+        close();
+        std::swap(fd_, x.fd_);
+        std::swap(map_, x.map_);
+        std::swap(map_bytes_, x.map_bytes_);
+        std::swap(header_, x.header_);
+        std::swap(array_, x.array_);
+      }
+      return *this;
+    }
+    mapped_circular_vector(const mapped_circular_vector &) = delete;
+    mapped_circular_vector &operator = (const mapped_circular_vector &) = delete;
+
+    // DECONSTRUCTORS:
+    // @brief  Unmaps and closes the file without waiting for the write back, call
+    //         sync() first to make the contents durable
+    ~mapped_circular_vector() { close(); }
+
+    // ITERATORS:
+    // @warn  Iterators are invalidated when the storage grows
+    iterator         begin()              { return iterator(array_ + start(), array_, array_ + capacity(), 0); }
+    const_iterator   begin() const        { return const_iterator(array_ + start(), array_, array_ + capacity(), 0); }
+    iterator         end()                { return iterator(array_ + header_->end_idx, array_, array_ + capacity(), size()); }
+    const_iterator   end() const          { return const_iterator(array_ + header_->end_idx, array_, array_ + capacity(), size()); }
+    reverse_iterator rbegin()             { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    reverse_iterator rend()               { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const   { return const_reverse_iterator(begin()); }
+
+    // CAPACITIES:
+    size_type size() const     { return size_type(header_->size); }
+    size_type capacity() const { return size_type(header_->capacity); }
+    bool empty() const         { return header_->size == 0; }
+    bool full() const          { return header_->size == header_->capacity; }
+    // @brief  Grows the file so the capacity is at least @a n, as selected by the
+    //         growth policy
+    // @throws  std::system_error  If the file cannot be extended or remapped
+    void reserve(size_type n) {
+      if (n > capacity())
+        grow(_Growth::grow_capacity(capacity(), n, size_type(sizeof(value_type))));
+    }
+
+    // MODIFIERS:
+    // @brief  Adds an element to the tail
+    // @return  True iff the first element was overwritten to make room (circular_overwrite)
+    // @throws  std::system_error  If the file cannot be grown
+    bool push_back(const value_type &val) {
+      // Copied first, a grow remaps the file and @a val may be one of its elements
+      const value_type copy(val);
+      const bool overwrite = make_room();
+      const size_type index = size_type(header_->end_idx);
+      array_[index] = copy;
+      header_->end_idx = next(index);
+      ++header_->size;
+      return overwrite;
+    }
+    // @brief  Adds an element to the head
+    // @return  True iff the last element was overwritten to make room (circular_overwrite)
+    // @throws  std::system_error  If the file cannot be grown
+    bool push_front(const value_type &val) {
+      // Copied first, a grow remaps the file and @a val may be one of its elements
+      const value_type copy(val);
+      const bool overwrite = make_room(true);
+      const size_type index = prev(start());
+      array_[index] = copy;
+      header_->start_idx = index;
+      ++header_->size;
+      return overwrite;
+    }
+    // @brief  Adds the @a n elements at @a first to the tail, in at most two copies
+    // @throws  std::system_error  If the file cannot be grown
+    void push_back_n(const value_type *first, size_type n) {
+      // Elements of the mapping are copied out first, a grow may remap them
+      if (n != 0 && std::less<const value_type *>()(first, array_ + capacity()) &&
+          std::less<const value_type *>()(array_, first + n)) {
+        const std::vector<value_type> copy(first, first + n);
+        push_back_n(copy.data(), n);
+        return;
+      }
+      if (_Overflow::overwrite && n >= capacity()) {
+        first += n - capacity();
+        n = capacity();
+        clear();
+      } else if (_Overflow::overwrite && size() + n > capacity()) {
+        pop_front_n(size() + n - capacity());
+      } else {
+        reserve(size() + n);
+      }
+      const size_type index = size_type(header_->end_idx);
+      const size_type one = std::min(n, capacity() - index);
+      std::memcpy(array_ + index, first, one * sizeof(value_type));
+      std::memcpy(array_, first + one, (n - one) * sizeof(value_type));
+      header_->end_idx = (index + n) % capacity();
+      header_->size += n;
+    }
+    // @brief  Removes the first element
+    // @warn  Calling this function on an empty container causes undefined behaviour
+    void pop_front() {
+      header_->start_idx = next(start());
+      --header_->size;
+    }
+    // @brief  Removes the last element
+    // @warn  Calling this function on an empty container causes undefined behaviour
+    void pop_back() {
+      header_->end_idx = prev(size_type(header_->end_idx));
+      --header_->size;
+    }
+    // @brief  Removes the first @a n elements
+    // @throws  std::out_of_range  If @a n is larger than size()
+    void pop_front_n(size_type n) {
+      if (n > size())
+        throw std::out_of_range("pop_front_n past the end");
+      header_->start_idx = (start() + n) % capacity();
+      header_->size -= n;
+    }
+    // @brief  Removes the last @a n elements
+    // @throws  std::out_of_range  If @a n is larger than size()
+    void pop_back_n(size_type n) {
+      if (n > size())
+        throw std::out_of_range("pop_back_n past the end");
+      header_->end_idx = (header_->end_idx + capacity() - n) % capacity();
+      header_->size -= n;
+    }
+    // @brief  Removes all elements, the file keeps its size
+    void clear() {
+      header_->start_idx = header_->end_idx = header_->size = 0;
+    }
+    // @brief  Writes the changed pages back to the file
+    // @param  async  Schedule the write back and return without waiting for it
+    // @throws  std::system_error  If msync fails
+    void sync(bool async = false) {
+      if (::msync(map_, map_bytes_, async ? MS_ASYNC : MS_SYNC) != 0)
+        throw std::system_error(errno, std::system_category(), "msync");
+    }
+
+    // ELEMENT ACCESS:
+    // @warn  Calling this function with an argument @a n that is out of range
+    //        causes undefined behaviour
+    reference operator [] (size_type n)             { return array_[(start() + n) % capacity()]; }
+    const_reference operator [] (size_type n) const { return array_[(start() + n) % capacity()]; }
+    // @throw  std::out_of_range  If @a n is an invalid index
+    reference at(size_type n) {
+      if (n >= size())
+        throw std::out_of_range("index larger than last index");
+      return (*this)[n];
+    }
+    const_reference at(size_type n) const {
+      if (n >= size())
+        throw std::out_of_range("index larger than last index");
+      return (*this)[n];
+    }
+    // @warn  Calling these functions on an empty container causes undefined behaviour
+    reference front()               { return array_[start()]; }
+    const_reference front() const   { return array_[start()]; }
+    reference back()                { return array_[prev(size_type(header_->end_idx))]; }
+    const_reference back() const    { return array_[prev(size_type(header_->end_idx))]; }
+
+    // CONTIGUOUS ACCESS:
+    // @return  The first run, starting at front()
+    array_range array_one() {
+      return array_range(array_ + start(), std::min(size(), capacity() - start()));
+    }
+    const_array_range array_one() const {
+      return const_array_range(array_ + start(), std::min(size(), capacity() - start()));
+    }
+    // @return  The second run, starting at the beginning of the storage and ending
+    //          with back(). Its length is 0 unless the elements wrap
+    array_range array_two() {
+      return array_range(array_, size() - array_one().second);
+    }
+    const_array_range array_two() const {
+      return const_array_range(array_, size() - array_one().second);
+    }
+    // @return  True iff the elements occupy a single contiguous run
+    bool is_linearized() const { return start() + size() <= capacity(); }
+
+  private:
+    // The open file, -1 once moved from
+    int fd_;
+    // The mapping of the whole file
+    void *map_;
+    size_type map_bytes_;
+    // The header at the start of the mapping, followed by the storage array
+    circular_mapped_header *header_;
+    value_type *array_;
+
+    // HELPER FUNCTIONS:
+    size_type start() const                { return size_type(header_->start_idx); }
+    size_type next(size_type index) const  { return index + 1 == capacity() ? 0 : index + 1; }
+    size_type prev(size_type index) const  { return index == 0 ? capacity() - 1 : index - 1; }
+    static size_type file_bytes(size_type capacity) {
+      return sizeof(circular_mapped_header) + capacity * sizeof(value_type);
+    }
+    // @brief  Makes room for one element, dropping the element at the other end
+    //         with circular_overwrite or growing the file otherwise
+    // @return  True iff an element was dropped
+    bool make_room(bool front = false) {
+      if (!full())
+        return false;
+      if (_Overflow::overwrite) {
+        if (front)
+          pop_back();
+        else
+          pop_front();
+        return true;
+      }
+      reserve(capacity() + 1);
+      return false;
+    }
+    // @brief  Sets the file size for @a capacity elements
+    void resize_file(size_type capacity) {
+      if (::ftruncate(fd_, off_t(file_bytes(capacity))) != 0)
+        throw std::system_error(errno, std::system_category(), "ftruncate");
+    }
+    // @brief  Maps the file holding @a capacity elements
+    void map(size_type capacity) {
+      void *p = ::mmap(nullptr, file_bytes(capacity), PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+      if (p == MAP_FAILED)
+        throw std::system_error(errno, std::system_category(), "mmap");
+      set_mapping(p, file_bytes(capacity));
+    }
+    void set_mapping(void *p, size_type bytes) {
+      map_ = p;
+      map_bytes_ = bytes;
+      header_ = static_cast<circular_mapped_header *>(p);
+      array_ = reinterpret_cast<value_type *>(static_cast<char *>(p) + sizeof(circular_mapped_header));
+    }
+    void unmap() {
+      if (map_)
+        ::munmap(map_, map_bytes_);
+      map_ = nullptr;
+      header_ = nullptr;
+      array_ = nullptr;
+    }
+    void close() {
+      unmap();
+      if (fd_ >= 0)
+        ::close(fd_);
+      fd_ = -1;
+    }
+    // @brief  Checks a reopened file was written by a %mapped_circular_vector of this
+    //         element size and that its indices are within the file, completing a
+    //         grow that was journaled but not applied
+    void validate(const std::string &path) {
+      const circular_mapped_header &h = *header_;
+      if (h.magic != kMagic || h.version != kVersion)
+        throw std::runtime_error(path + " is not a mapped_circular_vector file");
+      if (h.element_size != sizeof(value_type))
+        throw std::runtime_error(path + " holds elements of a different size");
+      if (h.grow_capacity != 0) {
+        if (file_bytes(size_type(h.grow_capacity)) > map_bytes_ ||
+            h.grow_start_idx >= h.grow_capacity || h.size > h.grow_capacity)
+          throw std::runtime_error(path + " has a corrupt header");
+        commit_grow();
+      }
+      if (h.capacity == 0 || file_bytes(size_type(h.capacity)) > map_bytes_ ||
+          h.start_idx >= h.capacity || h.end_idx >= h.capacity || h.size > h.capacity ||
+          (h.start_idx + h.size) % h.capacity != h.end_idx)
+        throw std::runtime_error(path + " has a corrupt header");
+    }
+    // @brief  Extends the file to @a n elements and remaps it. The elements keep their
+    //         indices unless they wrap: then the shorter run is copied, the run from
+    //         index 0 to just past the old end of the array, or the run from start to
+    //         the new end of the array. Neither copy may overlap the old layout, which
+    //         the file holds until the grow commits, so @a n is raised to fit the
+    //         shorter run past the old end of the array
+    void grow(size_type n) {
+      const size_type old_capacity = capacity();
+      size_type start_idx = start();
+      const size_type size = this->size();
+      const bool wrapped = start_idx + size > old_capacity;
+      const size_type one = wrapped ? old_capacity - start_idx : 0;
+      const size_type two = wrapped ? size - one : 0;
+      if (n < old_capacity + std::min(one, two))
+        n = old_capacity + std::min(one, two);
+      resize_file(n);
+#ifdef MREMAP_MAYMOVE
+      void *p = ::mremap(map_, map_bytes_, file_bytes(n), MREMAP_MAYMOVE);
+      if (p == MAP_FAILED)
+        throw std::system_error(errno, std::system_category(), "mremap");
+      set_mapping(p, file_bytes(n));
+#else
+      unmap();
+      map(n);
+#endif
+      if (wrapped) {
+        if (two <= one) {
+          std::memcpy(array_ + old_capacity, array_, two * sizeof(value_type));
+          sync_range(array_ + old_capacity, two * sizeof(value_type));
+        } else {
+          std::memcpy(array_ + n - one, array_ + start_idx, one * sizeof(value_type));
+          sync_range(array_ + n - one, one * sizeof(value_type));
+          start_idx = n - one;
+        }
+      }
+      // No order of the stores to capacity and the indices is valid at every step,
+      //   so the copied elements and the new start are synced before the new capacity
+      //   commits the grow, and the header is synced before the journal is cleared.
+      //   Only the copied run and the header page are written back
+      header_->grow_start_idx = start_idx;
+      sync_range(header_, sizeof(circular_mapped_header));
+      header_->grow_capacity = n;
+      sync_range(header_, sizeof(circular_mapped_header));
+      commit_grow();
+    }
+    // @brief  Applies the journaled grow to the capacity and indices
+    void commit_grow() {
+      const size_type n = size_type(header_->grow_capacity);
+      header_->start_idx = header_->grow_start_idx;
+      header_->capacity = n;
+      header_->end_idx = (header_->start_idx + header_->size) % n;
+      sync_range(header_, sizeof(circular_mapped_header));
+      header_->grow_capacity = 0;
+    }
+    // @brief  Writes the pages holding the @a bytes at @a p back to the file, waiting
+    //         for them
+    // @throws  std::system_error  If msync fails
+    void sync_range(const void *p, size_type bytes) {
+      if (bytes == 0)
+        return;
+      static const std::uintptr_t page_size = std::uintptr_t(::sysconf(_SC_PAGESIZE));
+      const std::uintptr_t first = std::uintptr_t(p) & ~(page_size - 1);
+      if (::msync(reinterpret_cast<void *>(first), std::uintptr_t(p) + bytes - first, MS_SYNC) != 0)
+        throw std::system_error(errno, std::system_category(), "msync");
+    }
+};
+
+#endif
@@ -0,0 +1,376 @@
+/* ---------------------------------------------------------------------------
+** This software is in the public domain, furnished "as is", without technical
+** support, and with no warranty, express or implied, as to its usefulness for
+** any purpose.
+**
+** mirrored_circular_vector.h
+** A Circular Vector without a wrap seam. The storage pages are mapped twice,
+** back to back, so the elements always occupy one contiguous run of virtual
+** memory. For trivially copyable types. Linux memfd_create, with a fallback
+** that keeps the elements contiguous by sliding them in a double size array.
+**
+**
+** Author: Konrad Janica
+** -------------------------------------------------------------------------*/
+
+#ifndef MIRRORED_CIRCULAR_VECTOR_HPP_
+#define MIRRORED_CIRCULAR_VECTOR_HPP_
+
+#include "circular_vector.h"
+
+#include <cstddef>      // std::size_t, std::ptrdiff_t
+#include <cstdlib>      // std::malloc, std::free
+#include <cstring>      // std::memcpy, std::memmove
+#include <functional>   // std::less
+#include <iterator>     // std::reverse_iterator
+#include <new>          // std::bad_alloc, placement new
+#include <stdexcept>    // std::length_error, std::out_of_range
+#include <type_traits>  // std::is_trivially_copyable
+#include <utility>      // std::pair, std::swap, std::forward
+#include <vector>       // std::vector
+
+#include <sys/mman.h>   // mmap, munmap, memfd_create
+#include <unistd.h>     // sysconf, ftruncate, close
+
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+#define CIRCULAR_VECTOR_HAS_MEMFD 1
+#endif
+
+// A Circular Vector of trivially copyable elements that are always contiguous
+//   The storage array is followed by a second view of itself: with memfd_create the
+//   same physical pages are mapped twice, back to back, so the elements starting
+//   anywhere in the first view run on into the second without a seam. data()
+//   points at size() contiguous elements, operator[] needs no wrap and the
+//   iterators are plain pointers, so memcpy, write and parsers work straight on the
+//   buffer.
+//   The capacity is rounded up so the storage is a whole number of pages, which
+//   suits large containers. When the double mapping is not available the storage is
+//   an ordinary array of twice the capacity instead, and the elements are slid back
+//   to its centre when they reach either end, amortized O(1) per push.
+//   The behaviour when full and the capacity to grow to are selected with
+//   @a _Overflow and @a _Growth as for %circular_vector.
+template <typename _T, typename _Overflow = circular_grow,
+          typename _Growth = circular_growth_geometric<> >
+class mirrored_circular_vector {
+  static_assert(std::is_trivially_copyable<_T>::value,
+      "mirrored_circular_vector moves elements as raw bytes");
+
+  public:
+    // TYPEDEFS:
+    typedef mirrored_circular_vector<_T, _Overflow, _Growth> self_type;
+    typedef _T                                        value_type;
+    typedef _T *                                      pointer;
+    typedef const _T *                                const_pointer;
+    typedef _T &                                      reference;
+    typedef const _T &                                const_reference;
+    typedef std::size_t                               size_type;
+    typedef std::ptrdiff_t                            difference_type;
+    typedef pointer                                   iterator;
+    typedef const_pointer                             const_iterator;
+    typedef std::reverse_iterator<iterator>           reverse_iterator;
+    typedef std::reverse_iterator<const_iterator>     const_reverse_iterator;
+    typedef std::pair<pointer, size_type>             array_range;
+    typedef std::pair<const_pointer, size_type>       const_array_range;
+
+    // CONSTRUCTORS:
+    // @brief  Empty container constructor with at least @a capacity reserved
+    // @param  capacity  The starting capacity, rounded up to whole pages
+    // @param  mirror    False uses the fallback storage, e.g. for testing
+    // @throws  std::invalid_argument  With a zero capacity
+    // @throws  std::bad_alloc  If the storage cannot be allocated
+    explicit mirrored_circular_vector(size_type capacity, bool mirror = true)
+      : array_(nullptr), capacity_(0), start_(0), size_(0), mirrored_(false) {
+        if (capacity == 0)
+          throw std::invalid_argument("invalid capacity");
+        allocate(capacity, mirror);
+        start_ = mirrored_ ? 0 : capacity_;
+      }
+    // @brief  Copy constructor, the copy uses the same kind of storage
+    mirrored_circular_vector(const mirrored_circular_vector &x)
+      : array_(nullptr), capacity_(0), start_(0), size_(0), mirrored_(false) {
+        allocate(x.capacity_, x.mirrored_);
+        start_ = mirrored_ ? 0 : (capacity_ * 2 - x.size_) / 2;
+        std::memcpy(array_ + start_, x.data(), x.size_ * sizeof(value_type));
+        size_ = x.size_;
+      }
+    // @brief  Move constructor, takes over the storage of x, which is left without
+    //         storage and may only be assigned to or destroyed
+    mirrored_circular_vector(mirrored_circular_vector &&x) noexcept
+      : array_(x.array_), capacity_(x.capacity_), start_(x.start_), size_(x.size_),
+      mirrored_(x.mirrored_) {
+        x.array_ = nullptr;
+        x.capacity_ = x.start_ = x.size_ = 0;
+      }
+    mirrored_circular_vector &operator = (mirrored_circular_vector x) noexcept {
+      swap(x);
+      return *this;
+    }
+
+    // DECONSTRUCTORS:
+    ~mirrored_circular_vector() { release(array_, capacity_, mirrored_); }
+
+    // ITERATORS:
+    // @warn  Iterators are invalidated by growth and, without the double mapping,
+    //        by a push that slides the elements
+    iterator         begin()              { return data(); }
+    const_iterator   begin() const        { return data(); }
+    iterator         end()                { return data() + size_; }
+    const_iterator   end() const          { return data() + size_; }
+    reverse_iterator rbegin()             { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    reverse_iterator rend()               { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const   { return const_reverse_iterator(begin()); }
+
+    // CAPACITIES:
+    size_type size() const     { return size_; }
+    size_type capacity() const { return capacity_; }
+    bool empty() const         { return size_ == 0; }
+    bool full() const          { return size_ == capacity_; }
+    // @return  True iff the storage is double mapped, false with the fallback
+    bool is_mirrored() const   { return mirrored_; }
+    // @brief  Grows the storage so the capacity is at least @a n, as selected by the
+    //         growth policy and rounded up to whole pages
+    // @throws  std::bad_alloc  If the storage cannot be allocated
+    void reserve(size_type n) {
+      if (n <= capacity_)
+        return;
+      mirrored_circular_vector temp(_Growth::grow_capacity(capacity_, n, size_type(sizeof(value_type))), mirrored_);
+      temp.start_ = temp.mirrored_ ? 0 : (temp.capacity_ * 2 - size_) / 2;
+      std::memcpy(temp.array_ + temp.start_, data(), size_ * sizeof(value_type));
+      temp.size_ = size_;
+      swap(temp);
+    }
+
+    // MODIFIERS:
+    // @brief  Constructs an element in place at the tail
+    // @return  Reference to the new element
+    // @throws  std::bad_alloc  If the storage cannot grow
+    template <typename... Args>
+      reference emplace_back(Args&&... args) {
+        // Built first, @a args may refer to an element that reserve() frees or
+        //   rebase() slides
+        const value_type temp(std::forward<Args>(args)...);
+        if (full()) {
+          if (_Overflow::overwrite)
+            pop_front();
+          else
+            reserve(capacity_ + 1);
+        }
+        if (start_ + size_ == 2 * capacity_)
+          rebase(1, false);
+        pointer p = ::new (static_cast<void *>(array_ + start_ + size_)) value_type(temp);
+        ++size_;
+        return *p;
+      }
+    // @brief  Constructs an element in place at the head
+    // @return  Reference to the new element
+    // @throws  std::bad_alloc  If the storage cannot grow
+    template <typename... Args>
+      reference emplace_front(Args&&... args) {
+        // Built first, @a args may refer to an element that reserve() frees or
+        //   rebase() slides
+        const value_type temp(std::forward<Args>(args)...);
+        if (full()) {
+          if (_Overflow::overwrite)
+            pop_back();
+          else
+            reserve(capacity_ + 1);
+        }
+        if (start_ == 0)
+          rebase(1, true);
+        pointer p = ::new (static_cast<void *>(array_ + start_ - 1)) value_type(temp);
+        --start_;
+        ++size_;
+        return *p;
+      }
+    // @brief  Adds an element to the tail
+    // @return  True iff the first element was overwritten to make room (circular_overwrite)
+    bool push_back(const value_type &val) {
+      const bool overwrite = _Overflow::overwrite && full();
+      emplace_back(val);
+      return overwrite;
+    }
+    // @brief  Adds an element to the head
+    // @return  True iff the last element was overwritten to make room (circular_overwrite)
+    bool push_front(const value_type &val) {
+      const bool overwrite = _Overflow::overwrite && full();
+      emplace_front(val);
+      return overwrite;
+    }
+    // @brief  Adds the @a n elements at @a first to the tail with a single memcpy
+    // @throws  std::bad_alloc  If the storage cannot grow
+    void push_back_n(const value_type *first, size_type n) {
+      // Elements of this vector are copied out first, the storage may move under them
+      if (n != 0 && !std::less<const value_type *>()(first, data()) &&
+          std::less<const value_type *>()(first, data() + size_)) {
+        const std::vector<value_type> copy(first, first + n);
+        push_back_n(copy.data(), n);
+        return;
+      }
+      if (_Overflow::overwrite && n >= capacity_) {
+        first += n - capacity_;
+        n = capacity_;
+        clear();
+      } else if (_Overflow::overwrite && size_ + n > capacity_) {
+        pop_front_n(size_ + n - capacity_);
+      } else {
+        reserve(size_ + n);
+      }
+      if (start_ + size_ + n > 2 * capacity_)
+        rebase(n, false);
+      std::memcpy(array_ + start_ + size_, first, n * sizeof(value_type));
+      size_ += n;
+    }
+    // @brief  Removes the first element
+    // @warn  Calling this function on an empty container causes undefined behaviour
+    void pop_front() {
+      ++start_;
+      --size_;
+    }
+    // @brief  Removes the last element
+    // @warn  Calling this function on an empty container causes undefined behaviour
+    void pop_back() { --size_; }
+    // @brief  Removes the first @a n elements
+    // @throws  std::out_of_range  If @a n is larger than size()
+    void pop_front_n(size_type n) {
+      if (n > size_)
+        throw std::out_of_range("pop_front_n past the end");
+      start_ += n;
+      size_ -= n;
+    }
+    // @brief  Removes the last @a n elements
+    // @throws  std::out_of_range  If @a n is larger than size()
+    void pop_back_n(size_type n) {
+      if (n > size_)
+        throw std::out_of_range("pop_back_n past the end");
+      size_ -= n;
+    }
+    // @brief  Removes all elements
+    void clear() {
+      size_ = 0;
+      start_ = mirrored_ ? 0 : capacity_;
+    }
+    void swap(mirrored_circular_vector &x) noexcept {
+      std::swap(array_, x.array_);
+      std::swap(capacity_, x.capacity_);
+      std::swap(start_, x.start_);
+      std::swap(size_, x.size_);
+      std::swap(mirrored_, x.mirrored_);
+    }
+
+    // ELEMENT ACCESS:
+    // @warn  Calling this function with an argument @a n that is out of range
+    //        causes undefined behaviour
+    reference operator [] (size_type n)             { return array_[start_ + n]; }
+    const_reference operator [] (size_type n) const { return array_[start_ + n]; }
+    // @throw  std::out_of_range  If @a n is an invalid index
+    reference at(size_type n) {
+      if (n >= size_)
+        throw std::out_of_range("index larger than last index");
+      return array_[start_ + n];
+    }
+    const_reference at(size_type n) const {
+      if (n >= size_)
+        throw std::out_of_range("index larger than last index");
+      return array_[start_ + n];
+    }
+    // @warn  Calling these functions on an empty container causes undefined behaviour
+    reference front()               { return array_[start_]; }
+    const_reference front() const   { return array_[start_]; }
+    reference back()                { return array_[start_ + size_ - 1]; }
+    const_reference back() const    { return array_[start_ + size_ - 1]; }
+
+    // CONTIGUOUS ACCESS:
+    // @return  A pointer to front(), the elements are [data(), data() + size())
+    pointer data()                  { return array_ + start_; }
+    const_pointer data() const      { return array_ + start_; }
+    // @return  All the elements, for the interface of %circular_vector
+    array_range array_one()               { return array_range(data(), size_); }
+    const_array_range array_one() const   { return const_array_range(data(), size_); }
+    // @return  An empty run, the elements never wrap
+    array_range array_two()               { return array_range(data() + size_, 0); }
+    const_array_range array_two() const   { return const_array_range(data() + size_, 0); }
+    bool is_linearized() const            { return true; }
+
+  private:
+    // The first view of the storage, the second view or the fallback's second half
+    // follows it
+    value_type *array_;
+    size_type capacity_;
+    // The elements are [array_ + start_, array_ + start_ + size_), always within the
+    // 2 * capacity_ elements of the two views
+    size_type start_;
+    size_type size_;
+    bool mirrored_;
+
+    // HELPER FUNCTIONS:
+    // @brief  Makes room for @a n elements at the end of the two views the elements
+    //         reached, the front iff @a front. Double mapped, the elements are at the
+    //         same place in the other view, otherwise they are moved so the free space
+    //         is shared evenly between both ends after the @a n elements
+    void rebase(size_type n, bool front) {
+      if (mirrored_) {
+        start_ = front ? start_ + capacity_ : start_ - capacity_;
+      } else {
+        const size_type start = front ? (2 * capacity_ - size_ + n) / 2 : (2 * capacity_ - size_ - n) / 2;
+        std::memmove(array_ + start, array_ + start_, size_ * sizeof(value_type));
+        start_ = start;
+      }
+    }
+    // @brief  Allocates storage for at least @a n elements, double mapped if
+    //         @a mirror and available
+    void allocate(size_type n, bool mirror) {
+      const size_type page = size_type(::sysconf(_SC_PAGESIZE));
+      size_type bytes = (n * sizeof(value_type) + page - 1) / page * page;
+      while (bytes % sizeof(value_type) != 0)
+        bytes += page;
+      if (mirror && map_mirrored(bytes)) {
+        mirrored_ = true;
+      } else {
+        array_ = static_cast<value_type *>(std::malloc(2 * bytes));
+        if (!array_)
+          throw std::bad_alloc();
+        mirrored_ = false;
+      }
+      capacity_ = bytes / sizeof(value_type);
+    }
+    // @brief  Maps @a bytes of a memory file twice, back to back, into array_
+    // @return  False if it cannot, the fallback is used instead
+    bool map_mirrored(size_type bytes) {
+#ifdef CIRCULAR_VECTOR_HAS_MEMFD
+      const int fd = ::memfd_create("circular_vector", MFD_CLOEXEC);
+      if (fd < 0)
+        return false;
+      bool mapped = false;
+      if (::ftruncate(fd, off_t(bytes)) == 0) {
+        // Reserve both views at once so they are adjacent, then map the file over each
+        void *base = ::mmap(nullptr, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base != MAP_FAILED) {
+          char *first = static_cast<char *>(base);
+          mapped = ::mmap(first, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED &&
+                   ::mmap(first + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+          if (mapped)
+            array_ = reinterpret_cast<value_type *>(first);
+          else
+            ::munmap(base, 2 * bytes);
+        }
+      }
+      // The mappings keep the memory file alive
+      ::close(fd);
+      return mapped;
+#else
+      (void)bytes;
+      return false;
+#endif
+    }
+    static void release(value_type *array, size_type capacity, bool mirrored) {
+      if (!array)
+        return;
+      if (mirrored)
+        ::munmap(array, 2 * capacity * sizeof(value_type));
+      else
+        std::free(array);
+    }
+};
+
+#endif
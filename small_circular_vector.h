@@ -0,0 +1,257 @@
+/* ---------------------------------------------------------------------------
+** This software is in the public domain, furnished "as is", without technical
+** support, and with no warranty, express or implied, as to its usefulness for
+** any purpose.
+**
+** small_circular_vector.h
+** A %circular_vector keeping up to N elements inline in the object, with the
+** same wrap logic. The storage only moves to the heap on overflow, so short
+** containers are built without touching the allocator.
+**
+**
+** Author: Konrad Janica
+** -------------------------------------------------------------------------*/
+
+#ifndef SMALL_CIRCULAR_VECTOR_HPP_
+#define SMALL_CIRCULAR_VECTOR_HPP_
+
+#include "circular_vector.h"
+
+#include <cstddef>     // std::size_t
+#include <memory>      // std::allocator, std::allocator_traits
+#include <type_traits> // std::false_type, std::is_trivially_copyable, std::is_nothrow_move_constructible
+#include <utility>     // std::move
+
+// A single block of inline storage
+//   Hands out its buffer to one allocation at a time, any allocation that does not
+//   fit or arrives while the buffer is in use is refused.
+template <std::size_t _Bytes, std::size_t _Align>
+class circular_inline_arena {
+  public:
+    circular_inline_arena() : in_use_(false) {}
+    circular_inline_arena(const circular_inline_arena &) = delete;
+    circular_inline_arena &operator = (const circular_inline_arena &) = delete;
+
+    // @brief  Returns the buffer for a request of @a bytes aligned to @a align, or
+    //         nullptr if it is too large, over-aligned or the buffer is in use
+    void *allocate(std::size_t bytes, std::size_t align) {
+      if (in_use_ || bytes > _Bytes || align > _Align)
+        return nullptr;
+      in_use_ = true;
+      return buffer_;
+    }
+    // @brief  Releases the buffer iff @a p is the buffer
+    // @return  True iff @a p belonged to the arena
+    bool deallocate(void *p) {
+      if (p != static_cast<void *>(buffer_))
+        return false;
+      in_use_ = false;
+      return true;
+    }
+    // @return  True iff the buffer is allocated
+    bool in_use() const { return in_use_; }
+
+  private:
+    alignas(_Align) unsigned char buffer_[_Bytes];
+    bool in_use_;
+};
+
+// Allocates from a circular_inline_arena, falling back to std::allocator
+//   Allocators compare equal iff they share an arena. None of the propagate traits
+//   are set, a container keeps the allocator of its own arena for its whole life.
+template <typename _T, typename _Arena>
+class circular_inline_allocator {
+  public:
+    typedef _T                value_type;
+    typedef std::false_type   propagate_on_container_copy_assignment;
+    typedef std::false_type   propagate_on_container_move_assignment;
+    typedef std::false_type   propagate_on_container_swap;
+    typedef std::false_type   is_always_equal;
+
+    explicit circular_inline_allocator(_Arena &arena) noexcept : arena_(&arena) {}
+    template <typename _U>
+    circular_inline_allocator(const circular_inline_allocator<_U, _Arena> &other) noexcept
+      : arena_(other.arena_) {}
+
+    _T *allocate(std::size_t n) {
+      void *p = arena_->allocate(n * sizeof(_T), alignof(_T));
+      if (p)
+        return static_cast<_T *>(p);
+      return std::allocator<_T>().allocate(n);
+    }
+    void deallocate(_T *p, std::size_t n) {
+      if (!arena_->deallocate(p))
+        std::allocator<_T>().deallocate(p, n);
+    }
+
+    // @return  The arena allocated from
+    _Arena &arena() const { return *arena_; }
+
+  private:
+    template <typename _U, typename _A>
+    friend class circular_inline_allocator;
+    _Arena *arena_;
+};
+
+template <typename _T, typename _U, typename _Arena>
+bool operator == (const circular_inline_allocator<_T, _Arena> &a, const circular_inline_allocator<_U, _Arena> &b) {
+  return &a.arena() == &b.arena();
+}
+template <typename _T, typename _U, typename _Arena>
+bool operator != (const circular_inline_allocator<_T, _Arena> &a, const circular_inline_allocator<_U, _Arena> &b) {
+  return !(a == b);
+}
+
+// Adapts the shrink policy @a _Shrink of a small_circular_vector
+//   A capacity of at most @a _N is the inline storage, which is never given back:
+//   reallocating it while it is in use could only move the elements to the heap.
+//   Heap storage shrinks no further than @a _N, so once the elements fit they move
+//   back inline with the whole inline capacity.
+template <typename _Shrink, std::size_t _N>
+struct circular_inline_shrink : _Shrink {
+  template <typename size_type>
+  size_type shrink_capacity(size_type size, size_type capacity) {
+    if (capacity <= _N)
+      return capacity;
+    const size_type n = _Shrink::shrink_capacity(size, capacity);
+    return n < _N ? size_type(_N) : n;
+  }
+};
+
+// A %circular_vector with inline storage for @a _N elements
+//   Everything but the allocator is a %circular_vector: the elements wrap the same
+//   way, the policies are the same and all the member functions are inherited. The
+//   storage is inline while the capacity is at most @a _N, and moves to the heap
+//   when a push grows it beyond. shrink_to_fit() brings it back inline once the
+//   elements fit again, and neither it nor the shrink policy moves inline storage to
+//   the heap.
+//   With circular_pow2_index, @a _N should be a power of two.
+// @warn  Moving or swapping inline storage is O(n): inline elements cannot change
+//        owner, each one is moved. Heap storage is handed over in O(1). Do not swap
+//        through a reference to the %circular_vector base.
+template <typename _T, std::size_t _N, typename _Index = circular_modulo_index,
+          typename _Overflow = circular_grow, typename _Shrink = circular_never_shrink,
+          typename _Growth = circular_growth_geometric<>, typename _Stats = circular_no_stats>
+class small_circular_vector
+  : private circular_inline_arena<sizeof(_T) * _N, alignof(_T)>,
+    public circular_vector<_T, circular_inline_allocator<_T, circular_inline_arena<sizeof(_T) * _N, alignof(_T)> >,
+                           _Index, _Overflow, circular_inline_shrink<_Shrink, _N>, _Growth, _Stats> {
+  static_assert(_N > 0, "small_circular_vector needs inline room for at least one element");
+  typedef circular_inline_arena<sizeof(_T) * _N, alignof(_T)> arena_type;
+  // Moves are noexcept when moving the elements and constructing the policies are
+  static const bool kNothrowMove = std::is_nothrow_move_constructible<_T>::value &&
+      std::is_nothrow_default_constructible<_Shrink>::value &&
+      std::is_nothrow_default_constructible<_Stats>::value;
+
+  public:
+    typedef circular_vector<_T, circular_inline_allocator<_T, arena_type>,
+                            _Index, _Overflow, circular_inline_shrink<_Shrink, _N>, _Growth, _Stats> base_type;
+    typedef typename base_type::allocator_type  allocator_type;
+    typedef typename base_type::size_type       size_type;
+    typedef typename base_type::value_type      value_type;
+
+    // CONSTANTS:
+    // The number of elements held inline
+    static const size_type kInlineCapacity = _N;
+
+    // CONSTRUCTORS:
+    // @brief  Empty container constructor (default constructor). The inline storage is
+    //         the starting capacity, nothing is allocated.
+    small_circular_vector()
+      : base_type(_N, inline_allocator()) {}
+    // @brief  Empty container constructor with a specified amount of reserved space,
+    //         inline iff @a capacity is at most @a _N.
+    // @throws  std::invalid_argument  With negative capacity values
+    explicit small_circular_vector(size_type capacity)
+      : base_type(capacity, inline_allocator()) {}
+    // @brief  Fill constructor. Constructs a container with @a n copies of @a val.
+    small_circular_vector(size_type n, const value_type &val)
+      : base_type(n, val, inline_allocator()) {}
+    // @brief  Range constructor. Constructs a container with a copy of each element
+    //         in [first,last).
+    template <class InputIterator>
+      small_circular_vector(InputIterator first, InputIterator last)
+      : base_type(first, last, inline_allocator()) {}
+    // @brief  Copy constructor. The copy has its own inline storage.
+    small_circular_vector(const small_circular_vector &x)
+      : base_type(x, inline_allocator()) {}
+    // @brief  Move constructor. Heap storage is taken over in O(1), any
+    //         circular_inline_allocator releases it, inline elements are moved one by
+    //         one into the inline storage. x is left empty.
+    small_circular_vector(small_circular_vector &&x) noexcept(kNothrowMove)
+      : base_type(inline_allocator(), nullptr) {
+        take(x);
+      }
+
+    // @brief  Copy assignment. Elements that fit are assigned into the storage the
+    //         container has, inline storage stays inline.
+    small_circular_vector &operator = (const small_circular_vector &x) {
+      // A copy allocated while the inline storage is in use would go to the heap
+      if (!std::is_trivially_copyable<value_type>::value && this != &x && x.size() <= this->capacity())
+        this->assign(x.begin(), x.end());
+      else
+        base_type::operator=(x);
+      return *this;
+    }
+    // @brief  Move assignment. Heap storage is taken over as by the move constructor.
+    //         Inline elements are moved into the storage the container has if they
+    //         fit, otherwise into its inline storage.
+    small_circular_vector &operator = (small_circular_vector &&x) noexcept(kNothrowMove) {
+      if (this == &x)
+        return *this;
+      if (x.is_inline() && x.size() <= this->capacity()) {
+        base_type::operator=(std::move(x));
+      } else {
+        release();
+        take(x);
+      }
+      return *this;
+    }
+
+    // @brief  Exchanges the elements of the two containers, O(1) for heap storage and
+    //         element by element for inline storage.
+    void swap(small_circular_vector &x) noexcept(kNothrowMove) {
+      small_circular_vector temp(std::move(x));
+      x = std::move(*this);
+      *this = std::move(temp);
+    }
+
+    // CAPACITIES:
+    // @brief  Moves heap storage back inline, with the whole inline capacity, if the
+    //         elements fit, otherwise reduces the capacity to size() as
+    //         circular_vector::shrink_to_fit(). A no-op while the storage is inline
+    void shrink_to_fit() {
+      if (is_inline())
+        return;
+      if (this->size() <= _N)
+        this->relocate(_N);
+      else
+        base_type::shrink_to_fit();
+    }
+    // @return  True iff the elements are held in the inline storage
+    bool is_inline() const { return arena_type::in_use(); }
+
+  private:
+    allocator_type inline_allocator() { return allocator_type(static_cast<arena_type &>(*this)); }
+    // @brief  Gives this container, which has no storage, the heap storage of @a x or
+    //         inline storage holding its elements
+    void take(small_circular_vector &x) {
+      if (x.is_inline()) {
+        base_type temp(std::move(x), inline_allocator());
+        this->swap_storage(temp);
+      } else {
+        this->swap_storage(x);
+      }
+    }
+    // @brief  Destroys the elements and gives back the storage
+    void release() {
+      base_type(std::move(static_cast<base_type &>(*this)));
+    }
+};
+
+template <typename _T, std::size_t _N, typename... _Policies>
+void swap(small_circular_vector<_T, _N, _Policies...> &x, small_circular_vector<_T, _N, _Policies...> &y) {
+  x.swap(y);
+}
+
+#endif
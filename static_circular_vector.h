@@ -0,0 +1,424 @@
+/* ---------------------------------------------------------------------------
+** This software is in the public domain, furnished "as is", without technical
+** support, and with no warranty, express or implied, as to its usefulness for
+** any purpose.
+**
+** static_circular_vector.h
+** A fixed capacity Circular Vector with the capacity N as a compile time
+** constant. The elements are stored inline, index wrapping is a constant
+** modulo (a mask when N is a power of two) and there is no allocator or
+** heap traffic. Usable in constexpr contexts for trivial types (C++14).
+**
+**
+** Author: Konrad Janica
+** -------------------------------------------------------------------------*/
+
+#ifndef STATIC_CIRCULAR_VECTOR_HPP_
+#define STATIC_CIRCULAR_VECTOR_HPP_
+
+#include "circular_vector.h"
+
+#include <cstddef>     // std::size_t, std::ptrdiff_t
+#include <iterator>    // std::reverse_iterator, std::distance
+#include <new>         // placement new
+#include <stdexcept>   // std::length_error, std::out_of_range
+#include <type_traits> // std::is_trivial, std::aligned_storage
+#include <utility>     // std::pair, std::move, std::forward
+
+// Members mutating a container can only be constexpr from C++14
+#if __cplusplus >= 201402L
+#define CIRCULAR_CONSTEXPR14 constexpr
+#else
+#define CIRCULAR_CONSTEXPR14 inline
+#endif
+
+// The storage of a static_circular_vector
+//   Trivial types are held in a plain array, so the container is a literal type with
+//   compiler generated copies. Any other type is held in uninitialized storage and
+//   its elements are constructed, copied and destroyed one at a time.
+template <typename _T, std::size_t _N, bool = std::is_trivial<_T>::value>
+class static_circular_storage {
+  protected:
+    constexpr static_circular_storage() : start_(0), size_(0), data_() {}
+
+    CIRCULAR_CONSTEXPR14 _T *slots()             { return data_; }
+    constexpr const _T *slots() const            { return data_; }
+    template <typename... Args>
+      CIRCULAR_CONSTEXPR14 void construct(std::size_t index, Args&&... args) {
+        data_[index] = _T(std::forward<Args>(args)...);
+      }
+    CIRCULAR_CONSTEXPR14 void destroy(std::size_t) {}
+
+    // Storage index of the first element
+    std::size_t start_;
+    std::size_t size_;
+
+  private:
+    _T data_[_N];
+};
+
+template <typename _T, std::size_t _N>
+class static_circular_storage<_T, _N, false> {
+  protected:
+    static_circular_storage() : start_(0), size_(0) {}
+    static_circular_storage(const static_circular_storage &x) : start_(0), size_(0) {
+      copy_from(x);
+    }
+    static_circular_storage(static_circular_storage &&x) : start_(0), size_(0) {
+      move_from(x);
+    }
+    static_circular_storage &operator = (const static_circular_storage &x) {
+      if (this != &x) {
+        destroy_all();
+        copy_from(x);
+      }
+      return *this;
+    }
+    static_circular_storage &operator = (static_circular_storage &&x) {
+      if (this != &x) {
+        destroy_all();
+        move_from(x);
+      }
+      return *this;
+    }
+    ~static_circular_storage() { destroy_all(); }
+
+    _T *slots()             { return reinterpret_cast<_T *>(data_); }
+    const _T *slots() const { return reinterpret_cast<const _T *>(data_); }
+    template <typename... Args>
+      void construct(std::size_t index, Args&&... args) {
+        ::new (static_cast<void *>(slots() + index)) _T(std::forward<Args>(args)...);
+      }
+    void destroy(std::size_t index) { slots()[index].~_T(); }
+
+    std::size_t start_;
+    std::size_t size_;
+
+  private:
+    typename std::aligned_storage<sizeof(_T), alignof(_T)>::type data_[_N];
+
+    // @brief  Destroys every element, leaving the storage empty
+    void destroy_all() {
+      for (; size_ != 0; --size_)
+        destroy((start_ + size_ - 1) % _N);
+      start_ = 0;
+    }
+    // @brief  Copies the elements of x into the empty storage, keeping their
+    //         storage indices
+    void copy_from(const static_circular_storage &x) {
+      start_ = x.start_;
+      for (; size_ < x.size_; ++size_)
+        construct((start_ + size_) % _N, x.slots()[(start_ + size_) % _N]);
+    }
+    // @brief  Moves the elements of x into the empty storage, x keeps its moved
+    //         from elements
+    void move_from(static_circular_storage &x) {
+      start_ = x.start_;
+      for (; size_ < x.size_; ++size_)
+        construct((start_ + size_) % _N, std::move(x.slots()[(start_ + size_) % _N]));
+    }
+};
+
+// A Circular Vector of at most @a _N elements, stored inline
+//   Has the interface of %circular_vector except for the members that reallocate.
+//   The behaviour when full is selected with @a _Overflow: circular_grow (default),
+//   as the storage cannot grow, throws std::length_error. circular_overwrite gives
+//   ring buffer semantics.
+//   For trivial types every member except the iterators is constexpr from C++14.
+template <typename _T, std::size_t _N, typename _Overflow = circular_grow>
+class static_circular_vector : private static_circular_storage<_T, _N> {
+  static_assert(_N > 0, "static_circular_vector needs a capacity of at least one element");
+  typedef static_circular_storage<_T, _N> storage_type;
+  using storage_type::start_;
+  using storage_type::size_;
+
+  public:
+    // TYPEDEFS:
+    typedef static_circular_vector<_T, _N, _Overflow> self_type;
+    typedef _Overflow                                 overflow_policy;
+    typedef _T                                        value_type;
+    typedef _T *                                      pointer;
+    typedef const _T *                                const_pointer;
+    typedef _T &                                      reference;
+    typedef const _T &                                const_reference;
+    typedef std::size_t                               size_type;
+    typedef std::ptrdiff_t                            difference_type;
+    typedef circular_vector_iterator<self_type, self_type> iterator;
+    typedef circular_vector_iterator<self_type, const self_type, const value_type> const_iterator;
+    typedef std::reverse_iterator<iterator>           reverse_iterator;
+    typedef std::reverse_iterator<const_iterator>     const_reverse_iterator;
+    typedef std::pair<pointer, size_type>             array_range;
+    typedef std::pair<const_pointer, size_type>       const_array_range;
+
+    // CONSTANTS:
+    static const size_type kCapacity = _N;
+
+    // CONSTRUCTORS:
+    // @brief  Empty container constructor (default constructor)
+    constexpr static_circular_vector() {}
+    // @brief  Fill constructor. Constructs a container with @a n copies of @a val.
+    // @throws  std::length_error  If @a n is larger than @a _N
+    CIRCULAR_CONSTEXPR14 static_circular_vector(size_type n, const value_type &val) {
+      assign(n, val);
+    }
+    // @brief  Range constructor. Constructs a container with a copy of each element
+    //         in [first,last), in the same order.
+    // @throws  std::length_error  If the range is longer than @a _N, unless
+    //          circular_overwrite when the last @a _N elements are kept
+    template <class InputIterator>
+      CIRCULAR_CONSTEXPR14 static_circular_vector(InputIterator first, InputIterator last) {
+        assign(first, last);
+      }
+
+    // ITERATORS:
+    // @warn  Iterators are not constexpr
+    iterator         begin()              { return iterator(slot(start_), slot(0), slot(_N), 0); }
+    const_iterator   begin() const        { return const_iterator(slot(start_), slot(0), slot(_N), 0); }
+    iterator         end()                { return iterator(slot(wrap(start_ + size_)), slot(0), slot(_N), size_); }
+    const_iterator   end() const          { return const_iterator(slot(wrap(start_ + size_)), slot(0), slot(_N), size_); }
+    reverse_iterator rbegin()             { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    reverse_iterator rend()               { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const   { return const_reverse_iterator(begin()); }
+
+    // CAPACITIES:
+    constexpr size_type size() const      { return size_; }
+    constexpr size_type max_size() const  { return _N; }
+    constexpr size_type capacity() const  { return _N; }
+    constexpr bool empty() const          { return size_ == 0; }
+    constexpr bool full() const           { return size_ == _N; }
+    // @brief  Resizes the container to contain @a n elements, appending copies of
+    //         @a val or removing elements from the back
+    // @throws  std::length_error  If @a n is larger than @a _N
+    CIRCULAR_CONSTEXPR14 void resize(size_type n, const value_type &val = value_type()) {
+      if (n > _N)
+        throw std::length_error("static_circular_vector capacity exceeded");
+      while (size_ > n)
+        pop_back();
+      while (size_ < n)
+        emplace_back(val);
+    }
+
+    // MODIFIERS:
+    // @brief  Replaces the contents with a copy of each element in [first,last)
+    template <class InputIterator>
+      CIRCULAR_CONSTEXPR14 void assign(InputIterator first, InputIterator last) {
+        clear();
+        for (; first != last; ++first)
+          push_back(*first);
+      }
+    // @brief  Replaces the contents with @a n copies of @a val
+    // @throws  std::length_error  If @a n is larger than @a _N
+    CIRCULAR_CONSTEXPR14 void assign(size_type n, const value_type &val) {
+      clear();
+      resize(n, val);
+    }
+    // @brief  Adds an element to the tail of the %static_circular_vector
+    // @return  True iff the first element was overwritten to make room (circular_overwrite)
+    // @throws  std::length_error  If full, unless circular_overwrite
+    CIRCULAR_CONSTEXPR14 bool push_back(const value_type &val) {
+      const bool overwrite = _Overflow::overwrite && full();
+      emplace_back(val);
+      return overwrite;
+    }
+    CIRCULAR_CONSTEXPR14 bool push_back(value_type &&val) {
+      const bool overwrite = _Overflow::overwrite && full();
+      emplace_back(std::move(val));
+      return overwrite;
+    }
+    // @brief  Adds an element to the head of the %static_circular_vector
+    // @return  True iff the last element was overwritten to make room (circular_overwrite)
+    // @throws  std::length_error  If full, unless circular_overwrite
+    CIRCULAR_CONSTEXPR14 bool push_front(const value_type &val) {
+      const bool overwrite = _Overflow::overwrite && full();
+      emplace_front(val);
+      return overwrite;
+    }
+    CIRCULAR_CONSTEXPR14 bool push_front(value_type &&val) {
+      const bool overwrite = _Overflow::overwrite && full();
+      emplace_front(std::move(val));
+      return overwrite;
+    }
+    // @brief  Constructs an element in place at the tail of the %static_circular_vector
+    // @return  Reference to the new element
+    // @throws  std::length_error  If full, unless circular_overwrite
+    template <typename... Args>
+      CIRCULAR_CONSTEXPR14 reference emplace_back(Args&&... args) {
+        if (full()) {
+          if (!_Overflow::overwrite)
+            throw std::length_error("static_circular_vector capacity exceeded");
+          // Built before the pop, @a args may refer to the element overwritten
+          value_type temp(std::forward<Args>(args)...);
+          pop_front();
+          return emplace_back(std::move(temp));
+        }
+        const size_type index = wrap(start_ + size_);
+        storage_type::construct(index, std::forward<Args>(args)...);
+        ++size_;
+        return storage_type::slots()[index];
+      }
+    // @brief  Constructs an element in place at the head of the %static_circular_vector
+    // @return  Reference to the new element
+    // @throws  std::length_error  If full, unless circular_overwrite
+    template <typename... Args>
+      CIRCULAR_CONSTEXPR14 reference emplace_front(Args&&... args) {
+        if (full()) {
+          if (!_Overflow::overwrite)
+            throw std::length_error("static_circular_vector capacity exceeded");
+          // Built before the pop, @a args may refer to the element overwritten
+          value_type temp(std::forward<Args>(args)...);
+          pop_back();
+          return emplace_front(std::move(temp));
+        }
+        const size_type index = start_ == 0 ? _N - 1 : start_ - 1;
+        storage_type::construct(index, std::forward<Args>(args)...);
+        start_ = index;
+        ++size_;
+        return storage_type::slots()[index];
+      }
+    // @brief  Removes the first element
+    // @warn  Calling this function on an empty container causes undefined behaviour
+    CIRCULAR_CONSTEXPR14 void pop_front() {
+      storage_type::destroy(start_);
+      start_ = wrap(start_ + 1);
+      --size_;
+    }
+    // @brief  Removes the last element
+    // @warn  Calling this function on an empty container causes undefined behaviour
+    CIRCULAR_CONSTEXPR14 void pop_back() {
+      storage_type::destroy(wrap(start_ + size_ - 1));
+      --size_;
+    }
+    // @brief  Removes the first @a n elements
+    // @param  n  Number of elements to remove
+    // @warn  Undefined behaviour when @a n is larger than size(), as for
+    //        circular_vector::pop_front_n
+    CIRCULAR_CONSTEXPR14 void pop_front_n(size_type n) {
+      for (; n != 0; --n)
+        pop_front();
+    }
+    // @brief  Removes the last @a n elements
+    // @param  n  Number of elements to remove
+    // @warn  Undefined behaviour when @a n is larger than size(), as for
+    //        circular_vector::pop_back_n
+    CIRCULAR_CONSTEXPR14 void pop_back_n(size_type n) {
+      for (; n != 0; --n)
+        pop_back();
+    }
+    // @brief  Removes all elements
+    CIRCULAR_CONSTEXPR14 void clear() {
+      while (size_ != 0)
+        pop_back();
+      start_ = 0;
+    }
+    // @brief  Exchanges the contents of the two containers, element by element
+    void swap(static_circular_vector &x) {
+      static_circular_vector temp(std::move(x));
+      x = std::move(*this);
+      *this = std::move(temp);
+    }
+
+    // ELEMENT ACCESS:
+    // @warn  Calling this function with an argument @a n that is out of range
+    //        causes undefined behaviour
+    CIRCULAR_CONSTEXPR14 reference operator [] (size_type n)   { return storage_type::slots()[wrap(start_ + n)]; }
+    constexpr const_reference operator [] (size_type n) const { return storage_type::slots()[wrap(start_ + n)]; }
+    // @throw  std::out_of_range  If @a n is an invalid index
+    CIRCULAR_CONSTEXPR14 reference at(size_type n) {
+      if (n >= size_)
+        throw std::out_of_range("index larger than last index");
+      return (*this)[n];
+    }
+    CIRCULAR_CONSTEXPR14 const_reference at(size_type n) const {
+      if (n >= size_)
+        throw std::out_of_range("index larger than last index");
+      return (*this)[n];
+    }
+    // @warn  Calling these functions on an empty container causes undefined behaviour
+    CIRCULAR_CONSTEXPR14 reference front()             { return (*this)[0]; }
+    constexpr const_reference front() const           { return (*this)[0]; }
+    CIRCULAR_CONSTEXPR14 reference back()              { return (*this)[size_ - 1]; }
+    constexpr const_reference back() const            { return (*this)[size_ - 1]; }
+
+    // CONTIGUOUS ACCESS:
+    // @return  The first run, starting at front()
+    array_range array_one() {
+      return array_range(slot(start_), std::min(size_, _N - start_));
+    }
+    const_array_range array_one() const {
+      return const_array_range(slot(start_), std::min(size_, _N - start_));
+    }
+    // @return  The second run, starting at the beginning of the storage and ending
+    //          with back(). Its length is 0 unless the elements wrap
+    array_range array_two() {
+      return array_range(slot(0), size_ - array_one().second);
+    }
+    const_array_range array_two() const {
+      return const_array_range(slot(0), size_ - array_one().second);
+    }
+    // @return  True iff the elements occupy a single contiguous run
+    constexpr bool is_linearized() const { return start_ + size_ <= _N; }
+
+  private:
+    // @brief  Maps @a n in [0, 2 * _N) into [0, _N), a mask when _N is a power of two
+    static constexpr size_type wrap(size_type n) { return n % _N; }
+    pointer slot(size_type index)                { return storage_type::slots() + index; }
+    const_pointer slot(size_type index) const    { return storage_type::slots() + index; }
+};
+
+// RELATIONAL OPERATORS:
+// a==b
+template <typename _T, std::size_t _N, typename _Overflow>
+CIRCULAR_CONSTEXPR14 bool operator == (const static_circular_vector<_T, _N, _Overflow> &a,
+    const static_circular_vector<_T, _N, _Overflow> &b) {
+  if (a.size() != b.size())
+    return false;
+  for (std::size_t x = 0; x < a.size(); ++x) {
+    if (!(a[x] == b[x]))
+      return false;
+  }
+  return true;
+}
+// a!=b which is equivalent to !(a==b)
+template <typename _T, std::size_t _N, typename _Overflow>
+CIRCULAR_CONSTEXPR14 bool operator != (const static_circular_vector<_T, _N, _Overflow> &a,
+    const static_circular_vector<_T, _N, _Overflow> &b) {
+  return !(a == b);
+}
+// a<b
+template <typename _T, std::size_t _N, typename _Overflow>
+CIRCULAR_CONSTEXPR14 bool operator < (const static_circular_vector<_T, _N, _Overflow> &a,
+    const static_circular_vector<_T, _N, _Overflow> &b) {
+  for (std::size_t x = 0; x < a.size() && x < b.size(); ++x) {
+    if (a[x] < b[x])
+      return true;
+    if (b[x] < a[x])
+      return false;
+  }
+  return a.size() < b.size();
+}
+// a>b
+template <typename _T, std::size_t _N, typename _Overflow>
+CIRCULAR_CONSTEXPR14 bool operator > (const static_circular_vector<_T, _N, _Overflow> &a,
+    const static_circular_vector<_T, _N, _Overflow> &b) {
+  return b < a;
+}
+// a<=b which is equivalent to !(b<a)
+template <typename _T, std::size_t _N, typename _Overflow>
+CIRCULAR_CONSTEXPR14 bool operator <= (const static_circular_vector<_T, _N, _Overflow> &a,
+    const static_circular_vector<_T, _N, _Overflow> &b) {
+  return !(b < a);
+}
+// a>=b which is equivalent to !(a<b)
+template <typename _T, std::size_t _N, typename _Overflow>
+CIRCULAR_CONSTEXPR14 bool operator >= (const static_circular_vector<_T, _N, _Overflow> &a,
+    const static_circular_vector<_T, _N, _Overflow> &b) {
+  return !(a < b);
+}
+
+template <typename _T, std::size_t _N, typename _Overflow>
+void swap(static_circular_vector<_T, _N, _Overflow> &x, static_circular_vector<_T, _N, _Overflow> &y) {
+  x.swap(y);
+}
+
+#endif
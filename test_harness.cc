@@ -1,6 +1,37 @@
 #include "circular_vector.h"
-
+#include "concurrent_circular_vector.h"
+#include "circular_vector_pool.h"
+#include "small_circular_vector.h"
+#include "static_circular_vector.h"
+#include "mapped_circular_vector.h"
+#include "mirrored_circular_vector.h"
+#include "circular_vector_io.h"
+#include "circular_vector_stats.h"
+#include "circular_vector_window.h"
+#include "circular_vector_parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 void Print(const circular_vector<int> &input);
 
@@ -8,6 +39,30 @@ void TestMethods();
 void TestObjectOperators();
 void TestIteratorOperators();
 void TestIteratorAccess();
+void TestPow2Index();
+void TestIteratorWrapping();
+void TestSpans();
+void TestMoveSemantics();
+void TestEmplace();
+void TestTrivialCopies();
+void TestBulkMethods();
+void TestOverwrite();
+void TestSpsc();
+void TestMpmc();
+void TestInsertErase();
+void TestShrink();
+void TestGrowthPolicies();
+void TestGrowthPlacement();
+void TestAllocators();
+void TestSmallVector();
+void TestStaticVector();
+void TestMappedVector();
+void TestMirroredVector();
+void TestSerialization();
+void TestStats();
+void TestSimdAlgorithms();
+void TestWindow();
+void TestParallel();
 
 int main() {
   
@@ -18,8 +73,70 @@ int main() {
   TestIteratorOperators();
 
   TestIteratorAccess();
+
+  TestPow2Index();
+
+  TestIteratorWrapping();
+
+  TestSpans();
+
+  TestMoveSemantics();
+
+  TestEmplace();
+
+  TestTrivialCopies();
+
+  TestBulkMethods();
+
+  TestOverwrite();
+
+  TestSpsc();
+
+  TestMpmc();
+
+  TestInsertErase();
+
+  TestShrink();
+
+  TestGrowthPolicies();
+
+  TestGrowthPlacement();
+
+  TestAllocators();
+
+  TestSmallVector();
+
+  TestStaticVector();
+
+  TestMappedVector();
+
+  TestMirroredVector();
+
+  TestSerialization();
+
+  TestStats();
+
+  TestSimdAlgorithms();
+
+  TestWindow();
+
+  TestParallel();
 }
 
+// Element type counting its copies and moves
+struct Tracked {
+  static int copies;
+  static int moves;
+  int value;
+  Tracked(int v = 0) : value(v) {}
+  Tracked(const Tracked &other) : value(other.value) { ++copies; }
+  Tracked(Tracked &&other) noexcept : value(other.value) { other.value = -1; ++moves; }
+  Tracked &operator = (const Tracked &other) { value = other.value; ++copies; return *this; }
+  Tracked &operator = (Tracked &&other) noexcept { value = other.value; other.value = -1; ++moves; return *this; }
+};
+int Tracked::copies = 0;
+int Tracked::moves = 0;
+
 // Prints all elements in the %circular_vector
 void Print(const circular_vector<int> &input) {
   for (size_t x = 0; x < input.size(); ++x) {
@@ -440,7 +557,44 @@ void TestIteratorOperators() {
     std::cout << "iterator >= operator passes" << std::endl;
   else
     std::cout << "iterator >= operator fails" << std::endl;
-  
+
+  // Testing != operator
+  it = test1.begin();
+  it2 = test1.begin();
+  if (it != it2)
+    std::cout << "iterator != operator fails" << std::endl;
+  else
+    std::cout << "iterator != operator passes" << std::endl;
+  ++it2;
+  if (it != it2)
+    std::cout << "iterator != operator passes" << std::endl;
+  else
+    std::cout << "iterator != operator fails" << std::endl;
+
+  // Testing [] operator and n + iterator across the wrap
+  circular_vector<int> test2(8);
+  for (int x = 0; x < 12; ++x) {
+    if (test2.full())
+      test2.pop_front();
+    test2.push_back(x);
+  }
+  it = test2.begin() + 1;
+  if (it[0] == 5 && it[6] == 11 && it[-1] == 4 && (2 + it)[0] == 7 && *(it + 2) == (3 + test2.begin())[0])
+    std::cout << "iterator [] operator passes" << std::endl;
+  else
+    std::cout << "iterator [] operator fails" << std::endl;
+
+  // Testing comparisons between iterators and const iterators either way round
+  circular_vector<int>::const_iterator cit = test2.cbegin() + 1;
+  static_assert(std::is_same<circular_vector<int>::const_iterator::reference, const int &>::value &&
+      std::is_same<circular_vector<int>::const_iterator::pointer, const int *>::value,
+      "a const_iterator must not hand out mutable elements");
+  if (it == cit && cit == it && !(it != cit) && it <= cit && cit >= it && !(it < cit) &&
+      test2.end() - cit == 7 && test2.crend() - test2.rbegin() == 8 &&
+      circular_vector<int>::iterator() == circular_vector<int>::iterator())
+    std::cout << "iterator const iterator comparisons pass" << std::endl;
+  else
+    std::cout << "iterator const iterator comparisons fail" << std::endl;
 }
 
 void TestIteratorAccess() {
@@ -489,3 +643,1877 @@ void TestIteratorAccess() {
   else
     std::cout << "Iterator access fails" << std::endl;
 }
+
+void TestPow2Index() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING CIRCULAR_VECTOR POWER OF TWO INDEX POLICY" << std::endl;
+
+  typedef circular_vector<int, std::allocator<int>, circular_pow2_index> pow2_vector;
+
+  pow2_vector test1(5);
+  if (test1.capacity() == 8)
+    std::cout << "Pow2 constructor capacity passes" << std::endl;
+  else
+    std::cout << "Pow2 constructor capacity fails" << std::endl;
+
+  // Mix both ends so the indices wrap around the seam and force growth
+  for (int x = 0; x < 20; ++x) {
+    test1.push_back(x);
+    test1.push_front(-x - 1);
+  }
+  bool ordered = true;
+  for (int x = 0; x < 40; ++x) {
+    if (test1[x] != x - 20)
+      ordered = false;
+  }
+  std::cout << "Printing capacity: " << test1.capacity() << std::endl;
+  if (ordered && test1.size() == 40 && test1.capacity() == 64)
+    std::cout << "Pow2 push methods pass" << std::endl;
+  else
+    std::cout << "Pow2 push methods fail" << std::endl;
+
+  for (int x = 0; x < 10; ++x) {
+    test1.pop_front();
+    test1.pop_back();
+  }
+  if (test1.front() == -10 && test1.back() == 9 && test1.size() == 20)
+    std::cout << "Pow2 pop methods pass" << std::endl;
+  else
+    std::cout << "Pow2 pop methods fail" << std::endl;
+
+  test1.reserve(100);
+  test1.clear();
+  test1.resize(3, 7);
+  if (test1.capacity() == 128 && test1.size() == 3 && test1.at(2) == 7)
+    std::cout << "Pow2 reserve/clear/resize methods pass" << std::endl;
+  else
+    std::cout << "Pow2 reserve/clear/resize methods fail" << std::endl;
+}
+
+void TestIteratorWrapping() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING CIRCULAR_VECTOR ITERATOR ACROSS THE WRAP SEAM" << std::endl;
+
+  // Capacity 8 filled from both ends so the elements wrap around the array end
+  circular_vector<int> test1(8);
+  std::vector<int> expected;
+  for (int x = 0; x < 8; ++x) {
+    if (x % 2) {
+      test1.push_back(x);
+      expected.push_back(x);
+    } else {
+      test1.push_front(x);
+      expected.insert(expected.begin(), x);
+    }
+  }
+  std::cout << "Printing circular_vector: ";
+  Print(test1);
+
+  if (std::equal(test1.begin(), test1.end(), expected.begin()) &&
+      std::equal(test1.rbegin(), test1.rend(), expected.rbegin()))
+    std::cout << "Iterator wrap traversal passes" << std::endl;
+  else
+    std::cout << "Iterator wrap traversal fails" << std::endl;
+
+  bool jumps = test1.end() - test1.begin() == 8;
+  for (int x = 0; x <= 8; ++x) {
+    for (int y = 0; y <= 8; ++y) {
+      circular_vector<int>::iterator it = test1.begin() + x;
+      it -= x - y;
+      if (it - test1.begin() != y || (y < 8 && *it != expected[y]))
+        jumps = false;
+    }
+  }
+  if (jumps && test1.begin() != test1.end())
+    std::cout << "Iterator wrap arithmetic passes" << std::endl;
+  else
+    std::cout << "Iterator wrap arithmetic fails" << std::endl;
+}
+
+void TestSpans() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING CIRCULAR_VECTOR SPANS AND LINEARIZE METHODS" << std::endl;
+
+  // Starts in the middle of capacity 10, so 8 elements wrap
+  circular_vector<int> test1(10);
+  for (int x = 0; x < 8; ++x)
+    test1.push_back(x);
+  circular_vector<int>::array_range one = test1.array_one();
+  circular_vector<int>::array_range two = test1.array_two();
+
+  int copy[8];
+  std::memcpy(copy, one.first, one.second * sizeof(int));
+  std::memcpy(copy + one.second, two.first, two.second * sizeof(int));
+  if (one.second == 5 && two.second == 3 && !test1.is_linearized() &&
+      std::equal(test1.begin(), test1.end(), copy))
+    std::cout << "Spans method passes" << std::endl;
+  else
+    std::cout << "Spans method fails" << std::endl;
+
+  int *data = test1.linearize();
+  std::cout << "Printing circular_vector: ";
+  Print(test1);
+  if (test1.is_linearized() && test1.capacity() == 10 && test1.as_spans().second.second == 0 &&
+      std::equal(data, data + 8, copy) && std::equal(test1.begin(), test1.end(), copy))
+    std::cout << "Linearize method passes" << std::endl;
+  else
+    std::cout << "Linearize method fails" << std::endl;
+
+  // Non trivial elements, and a full %circular_vector with no gap to shift into
+  circular_vector<std::string> test2(4);
+  for (int x = 0; x < 4; ++x)
+    test2.push_front(std::string(20, char('a' + x)));
+  test2.pop_front();
+  test2.push_back("tail");
+  test2.linearize();
+  const circular_vector<std::string> &const_test2 = test2;
+  circular_vector<std::string>::const_array_range run = const_test2.array_one();
+  if (run.second == 4 && run.first[0] == std::string(20, 'c') && run.first[2] == std::string(20, 'a') &&
+      run.first[3] == "tail")
+    std::cout << "Linearize full method passes" << std::endl;
+  else
+    std::cout << "Linearize full method fails" << std::endl;
+}
+
+void TestMoveSemantics() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING CIRCULAR_VECTOR MOVE SEMANTICS" << std::endl;
+
+  circular_vector<Tracked> test1;
+  Tracked::copies = 0;
+  Tracked::moves = 0;
+  for (int x = 0; x < 20; ++x) {
+    if (x % 2)
+      test1.push_back(Tracked(x));
+    else
+      test1.push_front(Tracked(x));
+  }
+  std::cout << "Copies: " << Tracked::copies << ", moves: " << Tracked::moves << std::endl;
+  if (Tracked::copies == 0 && test1.size() == 20 && test1.front().value == 18 && test1.back().value == 19)
+    std::cout << "Rvalue push and move-on-grow passes" << std::endl;
+  else
+    std::cout << "Rvalue push and move-on-grow fails" << std::endl;
+
+  Tracked::moves = 0;
+  circular_vector<Tracked> test2(std::move(test1));
+  if (Tracked::moves == 0 && test2.size() == 20 && test1.size() == 0 && test1.capacity() == 0)
+    std::cout << "Move constructor passes" << std::endl;
+  else
+    std::cout << "Move constructor fails" << std::endl;
+
+  // A moved-from %circular_vector is reusable
+  test1.push_front(Tracked(1));
+  test1.push_back(Tracked(2));
+  test1 = std::move(test2);
+  if (Tracked::copies == 0 && test1.size() == 20 && test2.empty() && test1.back().value == 19)
+    std::cout << "Move assignment passes" << std::endl;
+  else
+    std::cout << "Move assignment fails" << std::endl;
+
+  circular_vector<std::string> test3;
+  for (int x = 0; x < 10; ++x)
+    test3.push_back(std::string(32, char('a' + x)));
+  circular_vector<std::string> test4;
+  test4 = test3;
+  test4 = test4;
+  if (test4 == test3 && test3.size() == 10)
+    std::cout << "Copy assignment passes" << std::endl;
+  else
+    std::cout << "Copy assignment fails" << std::endl;
+}
+
+void TestEmplace() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING CIRCULAR_VECTOR EMPLACE METHODS" << std::endl;
+
+  circular_vector<Tracked> test1(8);
+  Tracked::copies = 0;
+  Tracked::moves = 0;
+  for (int x = 0; x < 4; ++x) {
+    test1.emplace_back(x).value += 10;
+    test1.emplace_front(-x).value -= 10;
+  }
+  std::cout << "Copies: " << Tracked::copies << ", moves: " << Tracked::moves << std::endl;
+  if (Tracked::copies == 0 && Tracked::moves == 0 && test1.front().value == -13 && test1.back().value == 13)
+    std::cout << "Emplace methods pass" << std::endl;
+  else
+    std::cout << "Emplace methods fail" << std::endl;
+
+  // Pushing an element of the same %circular_vector while it has to grow
+  circular_vector<std::string> test2(2);
+  test2.emplace_back(24, 'x');
+  test2.emplace_front(24, 'y');
+  test2.push_back(test2.front());
+  test2.emplace_front(test2.back());
+  if (test2.size() == 4 && test2.back() == std::string(24, 'y') && test2.front() == test2.back())
+    std::cout << "Emplace self reference passes" << std::endl;
+  else
+    std::cout << "Emplace self reference fails" << std::endl;
+}
+
+void TestTrivialCopies() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING CIRCULAR_VECTOR TRIVIALLY COPYABLE FAST PATHS" << std::endl;
+
+  // Wrapped storage with both runs populated
+  circular_vector<int> test1(16);
+  std::vector<int> expected;
+  for (int x = 0; x < 12; ++x) {
+    test1.push_back(x);
+    expected.push_back(x);
+  }
+  circular_vector<int> test2(test1);
+  circular_vector<int> test3(4);
+  test3 = test1;
+  circular_vector<int> test4(32);
+  test4.push_back(-1);
+  test4 = test1;
+  if (test2 == test1 && test3 == test1 && test4 == test1 && test4.capacity() == 32 &&
+      std::equal(test2.begin(), test2.end(), expected.begin()))
+    std::cout << "Trivial copy passes" << std::endl;
+  else
+    std::cout << "Trivial copy fails" << std::endl;
+
+  // Growth copies both runs into the new storage
+  test1.reserve(40);
+  for (int x = 12; x < 50; ++x) {
+    test1.push_back(x);
+    expected.push_back(x);
+  }
+  if (test1.size() == 50 && std::equal(test1.begin(), test1.end(), expected.begin()))
+    std::cout << "Trivial growth passes" << std::endl;
+  else
+    std::cout << "Trivial growth fails" << std::endl;
+
+  test2.assign(expected.data(), expected.data() + expected.size());
+  const int *first = expected.data();
+  circular_vector<int> test5(first, first + 7);
+  if (test2 == test1 && test5.size() == 7 && test5.back() == 6)
+    std::cout << "Trivial range assign passes" << std::endl;
+  else
+    std::cout << "Trivial range assign fails" << std::endl;
+}
+
+void TestBulkMethods() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING CIRCULAR_VECTOR BULK PUSH AND POP METHODS" << std::endl;
+
+  const int batch[6] = {10, 11, 12, 13, 14, 15};
+  circular_vector<int> test1(8);
+  test1.push_back(0);
+  test1.push_back_n(batch, 3);
+  test1.push_front_n(batch + 3, batch + 6);
+  std::cout << "Printing circular_vector: ";
+  Print(test1);
+  const int expected1[7] = {13, 14, 15, 0, 10, 11, 12};
+  if (test1.size() == 7 && std::equal(test1.begin(), test1.end(), expected1))
+    std::cout << "Bulk push methods pass" << std::endl;
+  else
+    std::cout << "Bulk push methods fail" << std::endl;
+
+  // Growth and single pass iterators
+  std::istringstream input("1 2 3 4 5");
+  test1.push_front_n(std::istream_iterator<int>(input), std::istream_iterator<int>());
+  std::vector<int> tail(20, 9);
+  test1.push_back_n(tail.begin(), tail.end());
+  if (test1.size() == 32 && test1.front() == 1 && test1[4] == 5 && test1[5] == 13 && test1.back() == 9)
+    std::cout << "Bulk push growth passes" << std::endl;
+  else
+    std::cout << "Bulk push growth fails" << std::endl;
+
+  test1.pop_front_n(5);
+  test1.pop_back_n(20);
+  std::cout << "Printing circular_vector: ";
+  Print(test1);
+  if (test1.size() == 7 && std::equal(test1.begin(), test1.end(), expected1))
+    std::cout << "Bulk pop methods pass" << std::endl;
+  else
+    std::cout << "Bulk pop methods fail" << std::endl;
+
+  circular_vector<std::string> test2(4);
+  std::vector<std::string> words;
+  for (int x = 0; x < 6; ++x)
+    words.push_back(std::string(20, char('a' + x)));
+  test2.push_back_n(words.begin() + 3, words.end());
+  test2.push_front_n(words.begin(), words.begin() + 3);
+  test2.pop_front_n(2);
+  test2.pop_back_n(1);
+  test2.resize(1);
+  if (test2.size() == 1 && test2.front() == words[2])
+    std::cout << "Bulk methods with strings pass" << std::endl;
+  else
+    std::cout << "Bulk methods with strings fail" << std::endl;
+}
+
+void TestOverwrite() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING CIRCULAR_VECTOR OVERWRITE POLICY" << std::endl;
+
+  typedef circular_vector<int, std::allocator<int>, circular_modulo_index, circular_overwrite> ring;
+
+  ring test1(4);
+  int overwrites = 0;
+  for (int x = 0; x < 10; ++x)
+    overwrites += test1.push_back(x);
+  std::cout << "Printing ring: ";
+  for (size_t x = 0; x < test1.size(); ++x)
+    std::cout << test1[x] << ",";
+  std::cout << std::endl;
+  if (overwrites == 6 && test1.capacity() == 4 && test1.full() && test1.front() == 6 && test1.back() == 9)
+    std::cout << "Overwrite push_back passes" << std::endl;
+  else
+    std::cout << "Overwrite push_back fails" << std::endl;
+
+  bool overwrote = test1.push_front(5);
+  test1.emplace_front(4);
+  if (overwrote && test1.capacity() == 4 && test1.front() == 4 && test1[1] == 5 && test1.back() == 7)
+    std::cout << "Overwrite push_front passes" << std::endl;
+  else
+    std::cout << "Overwrite push_front fails" << std::endl;
+
+  const int batch[6] = {10, 11, 12, 13, 14, 15};
+  test1.push_back_n(batch, 3);
+  const int expected1[4] = {7, 10, 11, 12};
+  bool bulk = test1.capacity() == 4 && std::equal(test1.begin(), test1.end(), expected1);
+  test1.push_front_n(batch, batch + 6);
+  bulk = bulk && test1.capacity() == 4 && std::equal(test1.begin(), test1.end(), batch);
+  test1.pop_back();
+  test1.push_front_n(batch + 4, 2);
+  const int expected2[4] = {14, 15, 10, 11};
+  if (bulk && std::equal(test1.begin(), test1.end(), expected2))
+    std::cout << "Overwrite bulk methods pass" << std::endl;
+  else
+    std::cout << "Overwrite bulk methods fail" << std::endl;
+
+  circular_vector<std::string, std::allocator<std::string>, circular_modulo_index, circular_overwrite> test2(3);
+  for (int x = 0; x < 5; ++x)
+    test2.push_back(std::string(20, char('a' + x)));
+  test2.push_back(test2.front());
+  if (test2.size() == 3 && test2.back() == std::string(20, 'c') && test2.front() == std::string(20, 'd'))
+    std::cout << "Overwrite self reference passes" << std::endl;
+  else
+    std::cout << "Overwrite self reference fails" << std::endl;
+}
+
+void TestSpsc() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING SPSC_CIRCULAR_VECTOR" << std::endl;
+
+  spsc_circular_vector<std::string> test1(3);
+  bool single = test1.capacity() == 4 && test1.empty();
+  for (int x = 0; x < 4; ++x)
+    single = single && test1.try_push(std::string(20, char('a' + x)));
+  single = single && !test1.try_emplace(20, 'z') && test1.size() == 4;
+  std::string out;
+  single = single && test1.try_pop(out) && out == std::string(20, 'a');
+  single = single && test1.front() && *test1.front() == std::string(20, 'b');
+  test1.pop_front();
+  const std::string batch[3] = {"x", "y", "z"};
+  single = single && test1.try_push_n(batch, 3) == 2;
+  std::vector<std::string> popped;
+  single = single && test1.try_pop_n(std::back_inserter(popped), 10) == 4 && test1.empty() &&
+    popped[0] == std::string(20, 'c') && popped[3] == "y" && !test1.try_pop(out);
+  if (single)
+    std::cout << "Spsc single thread methods pass" << std::endl;
+  else
+    std::cout << "Spsc single thread methods fail" << std::endl;
+
+  // A producer and a consumer thread, the consumer checks the order
+  const int count = 200000;
+  spsc_circular_vector<int> test2(64);
+  std::thread producer([&] {
+    int batch[16];
+    for (int x = 0; x < count;) {
+      if (x % 3 == 0) {
+        if (test2.try_push(x))
+          ++x;
+      } else {
+        int n = std::min(16, count - x);
+        for (int y = 0; y < n; ++y)
+          batch[y] = x + y;
+        x += int(test2.try_push_n(batch, n));
+      }
+      std::this_thread::yield();
+    }
+  });
+  bool ordered = true;
+  int next = 0;
+  while (next < count) {
+    int batch[8];
+    size_t n = test2.try_pop_n(batch, 8);
+    for (size_t y = 0; y < n; ++y)
+      ordered = ordered && batch[y] == next++;
+    if (n == 0)
+      std::this_thread::yield();
+  }
+  producer.join();
+  if (ordered && test2.empty())
+    std::cout << "Spsc two thread order passes" << std::endl;
+  else
+    std::cout << "Spsc two thread order fails" << std::endl;
+}
+
+void TestMpmc() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING MPMC_CIRCULAR_VECTOR" << std::endl;
+
+  mpmc_circular_vector<std::string> test1(3);
+  bool single = test1.capacity() == 4 && test1.empty();
+  for (int x = 0; x < 4; ++x)
+    single = single && test1.try_push(std::string(20, char('a' + x)));
+  single = single && !test1.try_emplace(20, 'z') && test1.size() == 4;
+  std::string out;
+  for (int x = 0; x < 4; ++x)
+    single = single && test1.try_pop(out) && out == std::string(20, char('a' + x));
+  single = single && test1.empty() && !test1.try_pop(out);
+  // Laps around the ring, leaving elements for the destructor
+  for (int x = 0; x < 8; ++x) {
+    test1.push(std::string(20, char('a' + x)));
+    if (x % 2 == 0) {
+      test1.pop(out);
+      single = single && out == std::string(20, char('a' + x / 2));
+    }
+  }
+  single = single && test1.size() == 4;
+  if (single)
+    std::cout << "Mpmc single thread methods pass" << std::endl;
+  else
+    std::cout << "Mpmc single thread methods fail" << std::endl;
+
+  // Producers push disjoint ranges, consumers check every value arrives exactly once
+  // and each producer's values arrive in order at each consumer
+  const int threads = 4;
+  const int count = 50000;
+  mpmc_circular_vector<int> test2(64);
+  std::vector<std::thread> producers, consumers;
+  std::vector<std::vector<int> > received(threads);
+  for (int t = 0; t < threads; ++t) {
+    producers.emplace_back([&, t] {
+      for (int x = 0; x < count; ++x) {
+        if (x % 2 == 0)
+          test2.push(t * count + x);
+        else
+          while (!test2.try_push(t * count + x))
+            std::this_thread::yield();
+      }
+    });
+    consumers.emplace_back([&, t] {
+      int val;
+      for (int x = 0; x < count; ++x) {
+        test2.pop(val);
+        received[t].push_back(val);
+      }
+    });
+  }
+  for (int t = 0; t < threads; ++t) {
+    producers[t].join();
+    consumers[t].join();
+  }
+  bool exact = test2.empty();
+  std::vector<int> all;
+  for (int t = 0; t < threads; ++t) {
+    std::vector<int> last(threads, -1);
+    for (size_t x = 0; x < received[t].size(); ++x) {
+      int producer = received[t][x] / count;
+      exact = exact && received[t][x] > last[producer];
+      last[producer] = received[t][x];
+    }
+    all.insert(all.end(), received[t].begin(), received[t].end());
+  }
+  std::sort(all.begin(), all.end());
+  for (int x = 0; x < threads * count; ++x)
+    exact = exact && all[x] == x;
+  if (exact)
+    std::cout << "Mpmc multi thread exactly once passes" << std::endl;
+  else
+    std::cout << "Mpmc multi thread exactly once fails" << std::endl;
+}
+
+void TestInsertErase() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING CIRCULAR_VECTOR INSERT AND ERASE" << std::endl;
+
+  circular_vector<int> test1(8);
+  for (int x = 0; x < 6; ++x)
+    test1.push_back(x);
+  // Wrapped around the end of the storage array
+  test1.pop_front_n(2);
+  const std::vector<int> nines(3, 9);
+  test1.push_back_n(nines.begin(), nines.end());
+  test1.insert(test1.begin() + 1, 20);
+  test1.insert(test1.end() - 1, 2, 21);
+  test1.emplace(test1.begin() + 3, 22);
+  const int batch[3] = {23, 24, 25};
+  test1.insert(test1.begin(), batch, batch + 3);
+  std::cout << "Printing circular_vector: ";
+  Print(test1);
+  const int expected1[14] = {23, 24, 25, 2, 20, 3, 22, 4, 5, 9, 9, 21, 21, 9};
+  if (test1.size() == 14 && std::equal(test1.begin(), test1.end(), expected1))
+    std::cout << "Insert passes" << std::endl;
+  else
+    std::cout << "Insert fails" << std::endl;
+
+  test1.erase(test1.begin() + 4);
+  test1.erase(test1.end() - 3, test1.end() - 1);
+  test1.erase(test1.begin(), test1.begin() + 3);
+  std::cout << "Printing circular_vector: ";
+  Print(test1);
+  const int expected2[8] = {2, 3, 22, 4, 5, 9, 9, 9};
+  if (test1.size() == 8 && std::equal(test1.begin(), test1.end(), expected2))
+    std::cout << "Erase passes" << std::endl;
+  else
+    std::cout << "Erase fails" << std::endl;
+
+  // Random positions against std::deque, both sides and both sizes of gap
+  std::srand(7);
+  circular_vector<std::string> test2(4);
+  std::deque<std::string> reference;
+  bool random = true;
+  for (int x = 0; x < 2000 && random; ++x) {
+    const size_t pos = std::rand() % (reference.size() + 1);
+    const size_t n = 1 + std::rand() % 3;
+    const std::string val(20, char('a' + x % 26));
+    switch (std::rand() % 5) {
+      case 0:
+        test2.insert(test2.begin() + pos, val);
+        reference.insert(reference.begin() + pos, val);
+        break;
+      case 1:
+      case 2: {
+        std::vector<std::string> range(n, val);
+        if (x % 2)
+          test2.insert(test2.begin() + pos, n, val);
+        else
+          test2.insert(test2.begin() + pos, range.begin(), range.end());
+        reference.insert(reference.begin() + pos, range.begin(), range.end());
+        break;
+      }
+      default: {
+        const size_t count = std::min(n, reference.size() - pos);
+        test2.erase(test2.begin() + pos, test2.begin() + pos + count);
+        reference.erase(reference.begin() + pos, reference.begin() + pos + count);
+      }
+    }
+    random = test2.size() == reference.size() && std::equal(test2.begin(), test2.end(), reference.begin());
+  }
+  if (random)
+    std::cout << "Random insert and erase against std::deque passes" << std::endl;
+  else
+    std::cout << "Random insert and erase against std::deque fails" << std::endl;
+
+  // Self references, single pass ranges, integral counts and overwrite containers grow
+  circular_vector<std::string> test3(2);
+  test3.push_back("x");
+  test3.push_back("y");
+  test3.insert(test3.begin() + 1, test3.back());
+  test3.insert(test3.begin() + 1, 2, test3.front());
+  std::istringstream input("p q");
+  test3.insert(test3.end() - 1, std::istream_iterator<std::string>(input), std::istream_iterator<std::string>());
+  circular_vector<int, std::allocator<int>, circular_modulo_index, circular_overwrite> test4(2);
+  test4.push_back(1);
+  test4.push_back(2);
+  test4.insert(test4.begin() + 1, 3, 7);
+  test4.insert(test4.begin() + 1, 0, 8);
+  test4.erase(test4.begin() + 1, test4.begin() + 1);
+  const int expected4[5] = {1, 7, 7, 7, 2};
+  const char *expected3[7] = {"x", "x", "x", "y", "p", "q", "y"};
+  if (std::equal(test3.begin(), test3.end(), expected3) && test3.size() == 7 &&
+      test4.size() == 5 && std::equal(test4.begin(), test4.end(), expected4))
+    std::cout << "Insert special cases pass" << std::endl;
+  else
+    std::cout << "Insert special cases fail" << std::endl;
+}
+
+void TestShrink() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING CIRCULAR_VECTOR SHRINKING" << std::endl;
+
+  circular_vector<int> test1(8);
+  for (int x = 0; x < 1000; ++x)
+    test1.push_back(x);
+  test1.pop_front_n(995);
+  for (int x = 0; x < 5; ++x)
+    test1.push_front(-x);
+  const size_t capacity = test1.capacity();
+  test1.shrink_to_fit();
+  std::cout << "Printing circular_vector: ";
+  Print(test1);
+  const int expected1[10] = {-4, -3, -2, -1, 0, 995, 996, 997, 998, 999};
+  if (capacity >= 1000 && test1.capacity() == 10 &&
+      std::equal(test1.begin(), test1.end(), expected1))
+    std::cout << "Shrink to fit passes" << std::endl;
+  else
+    std::cout << "Shrink to fit fails" << std::endl;
+
+  typedef circular_shrink_hysteresis<4, 16> hysteresis;
+  circular_vector<std::string, std::allocator<std::string>, circular_pow2_index,
+    circular_grow, hysteresis> test2;
+  for (int x = 0; x < 1000; ++x)
+    test2.push_back(std::string(20, char('a' + x % 26)));
+  const size_t peak = test2.capacity();
+  bool shrunk = true;
+  for (int x = 0; x < 900; ++x) {
+    test2.pop_front();
+    shrunk = shrunk && test2.size() * 4 >= test2.capacity();
+  }
+  shrunk = shrunk && test2.capacity() == 256 && test2.shrink_policy().shrink_count() == 2 &&
+    test2.shrink_policy().bytes_reclaimed() == (peak - 256) * sizeof(std::string) &&
+    test2.front() == std::string(20, char('a' + 900 % 26));
+  // Small changes in size do not reallocate again
+  for (int x = 0; x < 100; ++x) {
+    test2.push_back(test2.front());
+    test2.pop_back();
+    test2.pop_back();
+    test2.push_front(test2.back());
+  }
+  shrunk = shrunk && test2.capacity() == 256 && test2.shrink_policy().shrink_count() == 2;
+  test2.erase(test2.begin(), test2.end() - 1);
+  shrunk = shrunk && test2.capacity() == 16 && test2.size() == 1;
+  if (shrunk)
+    std::cout << "Shrink hysteresis policy passes" << std::endl;
+  else
+    std::cout << "Shrink hysteresis policy fails" << std::endl;
+}
+
+// Records the capacities a %circular_vector grows through while pushing @a n elements
+template <typename Container>
+std::vector<size_t> GrowthSequence(Container &container, int n) {
+  std::vector<size_t> capacities(1, container.capacity());
+  for (int x = 0; x < n; ++x) {
+    if (x % 2)
+      container.push_back(x);
+    else
+      container.push_front(x);
+    if (container.capacity() != capacities.back())
+      capacities.push_back(container.capacity());
+  }
+  return capacities;
+}
+
+void TestGrowthPolicies() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING CIRCULAR_VECTOR GROWTH POLICIES" << std::endl;
+
+  circular_vector<int> test1(4);
+  const size_t expected1[5] = {4, 6, 9, 13, 19};
+  circular_vector<int, std::allocator<int>, circular_pow2_index, circular_grow,
+    circular_never_shrink, circular_growth_geometric<2, 1> > test2(3);
+  const size_t expected2[4] = {4, 8, 16, 32};
+  circular_vector<int, std::allocator<int>, circular_modulo_index, circular_grow,
+    circular_never_shrink, circular_growth_additive<10> > test3(4);
+  const size_t expected3[3] = {4, 14, 24};
+  circular_vector<int, std::allocator<int>, circular_modulo_index, circular_grow,
+    circular_never_shrink, circular_growth_page<4096> > test4(4);
+  const size_t expected4[3] = {4, 1024, 2048};
+  std::vector<size_t> sequence1 = GrowthSequence(test1, 19);
+  std::vector<size_t> sequence2 = GrowthSequence(test2, 32);
+  std::vector<size_t> sequence3 = GrowthSequence(test3, 24);
+  std::vector<size_t> sequence4 = GrowthSequence(test4, 2048);
+  if (sequence1.size() == 5 && std::equal(sequence1.begin(), sequence1.end(), expected1) &&
+      sequence2.size() == 4 && std::equal(sequence2.begin(), sequence2.end(), expected2) &&
+      sequence3.size() == 3 && std::equal(sequence3.begin(), sequence3.end(), expected3) &&
+      sequence4.size() == 3 && std::equal(sequence4.begin(), sequence4.end(), expected4) &&
+      test1[0] == 18 && test1[18] == 17 && test4[0] == 2046 && test4[2047] == 2047)
+    std::cout << "Growth on push passes" << std::endl;
+  else
+    std::cout << "Growth on push fails" << std::endl;
+
+  test1.reserve(20);
+  test3.reserve(100);
+  test4.reserve(2049);
+  if (test1.capacity() == 28 && test3.capacity() == 100 && test4.capacity() == 3072)
+    std::cout << "Growth on reserve passes" << std::endl;
+  else
+    std::cout << "Growth on reserve fails" << std::endl;
+}
+
+void TestGrowthPlacement() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING CIRCULAR_VECTOR GROWTH PLACEMENT" << std::endl;
+
+  // After growing, the growing end has all the new room before the elements wrap
+  circular_vector<std::string> test1;
+  circular_vector<std::string> test2;
+  bool linear = true;
+  for (int x = 0; x < 1000; ++x) {
+    size_t capacity = test1.capacity();
+    test1.push_back(std::string(20, char('a' + x % 26)));
+    test2.push_front(std::string(20, char('a' + x % 26)));
+    if (capacity != test1.capacity())
+      linear = linear && test1.is_linearized() && test2.is_linearized();
+  }
+  for (int x = 0; x < 1000 && linear; ++x)
+    linear = test1[x] == test2[999 - x];
+  if (linear)
+    std::cout << "Growth keeps the growing end unwrapped passes" << std::endl;
+  else
+    std::cout << "Growth keeps the growing end unwrapped fails" << std::endl;
+
+  // Growing wrapped storage in place with realloc
+  std::srand(3);
+  circular_vector<int, circular_realloc_allocator<int> > test3(4);
+  std::deque<int> reference;
+  bool in_place = true;
+  for (int x = 0; x < 5000 && in_place; ++x) {
+    switch (std::rand() % 4) {
+      case 0:
+        test3.push_front(x);
+        reference.push_front(x);
+        break;
+      case 1:
+        test3.pop_front_n(std::min<size_t>(1, test3.size()));
+        if (!reference.empty())
+          reference.pop_front();
+        break;
+      default:
+        test3.push_back(x);
+        reference.push_back(x);
+    }
+    if (x % 1000 == 999) {
+      test3.reserve(test3.capacity() + 1);
+      test3.push_front_n(&x, 1);
+      reference.push_front(x);
+    }
+    in_place = test3.size() == reference.size() && std::equal(test3.begin(), test3.end(), reference.begin());
+  }
+  if (in_place)
+    std::cout << "Growth with a realloc allocator passes" << std::endl;
+  else
+    std::cout << "Growth with a realloc allocator fails" << std::endl;
+}
+
+// Stateful allocator recording which instance allocated each block
+//   _Propagate selects all three propagate_on_container_* traits.
+std::map<void *, int> g_block_owner;
+bool g_owner_mismatch = false;
+template <typename _T, bool _Propagate>
+struct TaggedAllocator {
+  typedef _T value_type;
+  typedef std::integral_constant<bool, _Propagate> propagate_on_container_copy_assignment;
+  typedef std::integral_constant<bool, _Propagate> propagate_on_container_move_assignment;
+  typedef std::integral_constant<bool, _Propagate> propagate_on_container_swap;
+  int id;
+  explicit TaggedAllocator(int i) : id(i) {}
+  template <typename _U>
+  TaggedAllocator(const TaggedAllocator<_U, _Propagate> &other) : id(other.id) {}
+  TaggedAllocator select_on_container_copy_construction() const { return TaggedAllocator(id + 100); }
+  _T *allocate(size_t n) {
+    _T *p = std::allocator<_T>().allocate(n);
+    g_block_owner[p] = id;
+    return p;
+  }
+  void deallocate(_T *p, size_t n) {
+    if (g_block_owner[p] != id)
+      g_owner_mismatch = true;
+    g_block_owner.erase(p);
+    std::allocator<_T>().deallocate(p, n);
+  }
+};
+template <typename _T, typename _U, bool _Propagate>
+bool operator == (const TaggedAllocator<_T, _Propagate> &a, const TaggedAllocator<_U, _Propagate> &b) { return a.id == b.id; }
+template <typename _T, typename _U, bool _Propagate>
+bool operator != (const TaggedAllocator<_T, _Propagate> &a, const TaggedAllocator<_U, _Propagate> &b) { return a.id != b.id; }
+
+void TestAllocators() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING CIRCULAR_VECTOR ALLOCATORS" << std::endl;
+
+  {
+    typedef TaggedAllocator<std::string, true> propagating;
+    typedef TaggedAllocator<std::string, false> sticky;
+    circular_vector<std::string, propagating> test1(4, propagating(1));
+    for (int x = 0; x < 10; ++x)
+      test1.push_back(std::to_string(x));
+    circular_vector<std::string, propagating> test2(test1);
+    circular_vector<std::string, propagating> test3(propagating(3));
+    test3 = test1;
+    circular_vector<std::string, propagating> test4(propagating(4));
+    test4 = std::move(test3);
+    circular_vector<std::string, propagating> test5(propagating(5));
+    test5.swap(test4);
+    if (test2.get_allocator().id == 101 && test3.get_allocator().id == 1 &&
+        test4.get_allocator().id == 5 && test5.get_allocator().id == 1 &&
+        test2 == test1 && test5 == test1 && test4.empty())
+      std::cout << "Propagating allocator passes" << std::endl;
+    else
+      std::cout << "Propagating allocator fails" << std::endl;
+
+    circular_vector<std::string, sticky> test6(4, sticky(6));
+    for (int x = 0; x < 10; ++x)
+      test6.push_front(std::to_string(x));
+    circular_vector<std::string, sticky> test7(sticky(7));
+    test7 = test6;
+    circular_vector<std::string, sticky> test8(sticky(8));
+    test8 = std::move(test6);
+    circular_vector<std::string, sticky> test9(std::move(test8), sticky(9));
+    circular_vector<std::string, sticky> test10(std::move(test7), sticky(7));
+    if (test7.get_allocator().id == 7 && test8.get_allocator().id == 8 &&
+        test9.get_allocator().id == 9 && test10.get_allocator().id == 7 &&
+        test6.empty() && test8.empty() && test7.empty() &&
+        test9 == test10 && test9.size() == 10 && test9.front() == "9")
+      std::cout << "Non propagating allocator passes" << std::endl;
+    else
+      std::cout << "Non propagating allocator fails" << std::endl;
+  }
+  if (!g_owner_mismatch && g_block_owner.empty())
+    std::cout << "Blocks freed by their allocator passes" << std::endl;
+  else
+    std::cout << "Blocks freed by their allocator fails" << std::endl;
+
+  // Short lived vectors recycle the pool's blocks
+  circular_block_pool pool;
+  circular_pool_allocator<int> pool_alloc(pool);
+  bool drained = true;
+  for (int x = 0; x < 100; ++x) {
+    circular_vector<int, circular_pool_allocator<int>, circular_pow2_index,
+      circular_grow, circular_shrink_hysteresis<> > test11(pool_alloc);
+    for (int y = 0; y < 1000; ++y)
+      test11.push_back(y);
+    while (test11.size() > 1)
+      test11.pop_front();
+    drained = drained && test11.front() == 999 && test11.capacity() < 1000;
+  }
+  if (drained && pool.upstream_allocations() < 20 && pool.recycled_allocations() > 1000 &&
+      pool.cached_bytes() > 0) {
+    pool.release();
+    if (pool.cached_bytes() == 0)
+      std::cout << "Block pool recycling passes" << std::endl;
+    else
+      std::cout << "Block pool recycling fails" << std::endl;
+  } else {
+    std::cout << "Block pool recycling fails" << std::endl;
+  }
+
+#ifdef CIRCULAR_VECTOR_POOL_HAS_PMR
+  circular_pool_resource resource;
+  {
+    pmr_circular_vector<std::pmr::string> test12(4, &resource);
+    for (int x = 0; x < 100; ++x)
+      test12.push_back(std::pmr::string(40, char('a' + x % 26)));
+    pmr_circular_vector<std::pmr::string> test13(std::move(test12));
+    test12 = test13;
+    if (test12 == test13 && test12.get_allocator().resource() == &resource &&
+        test13.back().get_allocator().resource() == &resource)
+      std::cout << "Polymorphic allocator passes" << std::endl;
+    else
+      std::cout << "Polymorphic allocator fails" << std::endl;
+  }
+  if (resource.pool().cached_bytes() > 0 && resource.pool().upstream_allocations() > 0)
+    std::cout << "Pool memory resource passes" << std::endl;
+  else
+    std::cout << "Pool memory resource fails" << std::endl;
+#endif
+}
+
+void TestSmallVector() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING SMALL_CIRCULAR_VECTOR" << std::endl;
+
+  // Wraps inline, spills to the heap on overflow and comes back on shrink_to_fit
+  small_circular_vector<std::string, 4> test1;
+  bool stayed_inline = test1.is_inline() && test1.capacity() == 4;
+  for (int x = 0; x < 20; ++x) {
+    test1.push_back(std::to_string(x));
+    if (test1.size() > 3)
+      test1.pop_front();
+    stayed_inline = stayed_inline && test1.is_inline();
+  }
+  const void *inline_storage = &test1.front();
+  if (stayed_inline && test1.size() == 3 && test1.front() == "17" && test1.back() == "19" &&
+      !test1.is_linearized() && (const char *)inline_storage >= (const char *)&test1 &&
+      (const char *)inline_storage < (const char *)(&test1 + 1))
+    std::cout << "Inline wrapping passes" << std::endl;
+  else
+    std::cout << "Inline wrapping fails" << std::endl;
+
+  test1.push_front("16");
+  test1.push_front("15");
+  bool spilled = !test1.is_inline() && test1.size() == 5 && test1.front() == "15";
+  test1.pop_back_n(2);
+  test1.shrink_to_fit();
+  const bool returned = test1.is_inline() && test1.capacity() == 4;
+  test1.push_back("18");
+  if (spilled && returned && test1.is_inline() && test1.size() == 4 && test1[0] == "15" && test1[3] == "18")
+    std::cout << "Heap overflow and return passes" << std::endl;
+  else
+    std::cout << "Heap overflow and return fails" << std::endl;
+  test1.pop_back();
+
+  // Copies and moves keep their own inline storage
+  small_circular_vector<std::string, 4> test2(test1);
+  small_circular_vector<std::string, 4> test3(std::move(test1));
+  small_circular_vector<std::string, 4> test4(6, "x");
+  small_circular_vector<std::string, 4> test5(test4);
+  small_circular_vector<std::string, 4> test6;
+  test6 = test3;
+  const bool assigned_inline = test6.is_inline() && test6 == test3;
+  swap(test3, test4);
+  test5 = std::move(test6);
+  // Moving inline elements keeps the storage they fit in, a swap hands heap storage over
+  bool kept_heap = test4.is_inline() && !test5.is_inline();
+  test4.shrink_to_fit();
+  test5.shrink_to_fit();
+  if (kept_heap && assigned_inline && test2.is_inline() && test2 == test5 && test1.empty() && test6.empty() &&
+      test3.size() == 6 && !test3.is_inline() && test4.size() == 3 && test4.is_inline() &&
+      test4 == test2 && test5.is_inline() && &test4.front() != &test2.front())
+    std::cout << "Inline copy and move passes" << std::endl;
+  else
+    std::cout << "Inline copy and move fails" << std::endl;
+
+  // Heap storage changes owner without moving an element, so a std::vector of them
+  // relocates by moving
+  static_assert(std::is_nothrow_move_constructible<small_circular_vector<std::string, 4> >::value,
+      "small_circular_vector moves are noexcept");
+  small_circular_vector<std::string, 4> test9(test3);
+  const std::string *heap_storage = &test3.front();
+  small_circular_vector<std::string, 4> test10(std::move(test3));
+  test9.push_back("y");
+  test4 = std::move(test10);
+  std::vector<small_circular_vector<std::string, 4> > many(1, test4);
+  many.reserve(many.capacity() + 1);
+  if (test3.empty() && test10.empty() && &test4.front() == heap_storage && test4.size() == 6 &&
+      !many[0].is_inline() && many[0] == test4 && test9.size() == 7)
+    std::cout << "Heap storage handover passes" << std::endl;
+  else
+    std::cout << "Heap storage handover fails" << std::endl;
+
+  // Shrinking never moves inline storage to the heap, and heap storage shrinks back
+  // into the whole inline capacity
+  small_circular_vector<int, 8> test7;
+  test7.push_back(1);
+  test7.shrink_to_fit();
+  small_circular_vector<int, 8, circular_modulo_index, circular_grow, circular_shrink_hysteresis<4, 2> > test8;
+  test8.push_back(1);
+  test8.push_back(2);
+  test8.pop_back();
+  bool kept_inline = test7.is_inline() && test7.capacity() == 8 && test8.is_inline() && test8.capacity() == 8;
+  for (int x = 0; x < 60; ++x)
+    test8.push_back(x);
+  const bool grew = !test8.is_inline() && test8.capacity() > 8;
+  while (test8.size() > 1)
+    test8.pop_front();
+  if (kept_inline && grew && test8.is_inline() && test8.capacity() == 8 && test8.front() == 59 &&
+      test8.shrink_policy().shrink_count() > 0)
+    std::cout << "Inline shrinking passes" << std::endl;
+  else
+    std::cout << "Inline shrinking fails" << std::endl;
+}
+
+#if __cplusplus >= 201402L
+// Runs a static_circular_vector through a wrap at compile time
+constexpr int StaticWrapSum() {
+  static_circular_vector<int, 4> ring;
+  for (int x = 0; x < 10; ++x) {
+    ring.push_back(x);
+    if (ring.size() > 3)
+      ring.pop_front();
+  }
+  ring.push_front(100);
+  return ring[0] + ring[1] + ring.back() + int(ring.size()) * 1000;
+}
+static_assert(StaticWrapSum() == 4000 + 100 + 7 + 9, "static_circular_vector is constexpr");
+#endif
+
+void TestStaticVector() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING STATIC_CIRCULAR_VECTOR" << std::endl;
+
+  // Matches circular_vector on random pushes and pops at both ends
+  std::srand(17);
+  static_circular_vector<std::string, 8> test1;
+  std::deque<std::string> reference;
+  bool matches = true;
+  for (int x = 0; x < 2000 && matches; ++x) {
+    const int op = std::rand() % 4;
+    if (op == 0 && !test1.full()) {
+      test1.push_back(std::to_string(x));
+      reference.push_back(std::to_string(x));
+    } else if (op == 1 && !test1.full()) {
+      test1.emplace_front(3, char('a' + x % 26));
+      reference.push_front(std::string(3, char('a' + x % 26)));
+    } else if (op == 2 && !test1.empty()) {
+      test1.pop_front();
+      reference.pop_front();
+    } else if (!test1.empty()) {
+      test1.pop_back();
+      reference.pop_back();
+    }
+    matches = test1.size() == reference.size() && std::equal(test1.begin(), test1.end(), reference.begin()) &&
+      (test1.empty() || (test1.front() == reference.front() && test1[test1.size() - 1] == reference.back()));
+  }
+  if (matches)
+    std::cout << "Push and pop at both ends passes" << std::endl;
+  else
+    std::cout << "Push and pop at both ends fails" << std::endl;
+
+  static_circular_vector<std::string, 8> test2(test1);
+  static_circular_vector<std::string, 8> test3(std::move(test2));
+  static_circular_vector<std::string, 8> test4(3, "x");
+  swap(test3, test4);
+  static_circular_vector<std::string, 8> test5;
+  test5 = test4;
+  if (test4 == test1 && test5 == test1 && test3.size() == 3 && test3[2] == "x" &&
+      (test1.empty() || test5 != test3))
+    std::cout << "Copy, move and swap passes" << std::endl;
+  else
+    std::cout << "Copy, move and swap fails" << std::endl;
+
+  static_circular_vector<int, 4> test6;
+  static_circular_vector<int, 4, circular_overwrite> test7;
+  bool threw = false;
+  for (int x = 0; x < 6; ++x) {
+    test7.push_back(x);
+    try {
+      test6.push_back(x);
+    } catch (const std::length_error &) {
+      threw = true;
+    }
+  }
+  if (threw && test6.size() == 4 && test6.back() == 3 && test7.front() == 2 && test7.back() == 5 &&
+      !test7.is_linearized() && test7.array_one().second + test7.array_two().second == 4 &&
+      sizeof(test7) == 4 * sizeof(int) + 2 * sizeof(size_t))
+    std::cout << "Full behaviour passes" << std::endl;
+  else
+    std::cout << "Full behaviour fails" << std::endl;
+
+  // Overwriting with a copy of the element being overwritten
+  static_circular_vector<std::string, 3, circular_overwrite> test8;
+  test8.push_back(std::string(40, 'a'));
+  test8.push_back(std::string(40, 'b'));
+  test8.push_back(std::string(40, 'c'));
+  test8.push_back(test8.front());
+  test8.push_front(test8.back());
+  test8.emplace_back(test8.front());
+  if (test8.size() == 3 && test8[0] == std::string(40, 'b') && test8[1] == std::string(40, 'c') &&
+      test8[2] == std::string(40, 'a'))
+    std::cout << "Overwrite with an aliased element passes" << std::endl;
+  else
+    std::cout << "Overwrite with an aliased element fails" << std::endl;
+}
+
+void TestMappedVector() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING MAPPED_CIRCULAR_VECTOR" << std::endl;
+
+  const char *dir = std::getenv("TMPDIR");
+  const std::string path = std::string(dir ? dir : "/tmp") + "/circular_vector_test_" +
+    std::to_string(getpid()) + ".ring";
+  std::srand(23);
+  std::deque<long long> reference;
+  bool matches = true;
+  {
+    mapped_circular_vector<long long> test1(path, 4);
+    for (int x = 0; x < 3000 && matches; ++x) {
+      switch (std::rand() % 4) {
+        case 0:
+          test1.push_front(x);
+          reference.push_front(x);
+          break;
+        case 1:
+          if (!reference.empty()) {
+            test1.pop_front();
+            reference.pop_front();
+          }
+          break;
+        default:
+          test1.push_back(x);
+          reference.push_back(x);
+      }
+      matches = test1.size() == reference.size() && std::equal(test1.begin(), test1.end(), reference.begin());
+    }
+    const long long bulk[3] = {-1, -2, -3};
+    test1.push_back_n(bulk, 3);
+    reference.insert(reference.end(), bulk, bulk + 3);
+    test1.sync();
+  }
+  // Reopening ignores the capacity argument and finds the elements where they were
+  {
+    mapped_circular_vector<long long> test2(path, 1);
+    if (matches && test2.size() == reference.size() && test2.capacity() >= reference.size() &&
+        std::equal(test2.begin(), test2.end(), reference.begin()) && test2.back() == -3)
+      std::cout << "Reopen after growth passes" << std::endl;
+    else
+      std::cout << "Reopen after growth fails" << std::endl;
+  }
+
+  bool wrong_size = false, unopenable = false;
+  try {
+    mapped_circular_vector<int> test3(path);
+  } catch (const std::runtime_error &) {
+    wrong_size = true;
+  }
+  try {
+    mapped_circular_vector<int> test4("/nonexistent_directory/ring");
+  } catch (const std::system_error &) {
+    unopenable = true;
+  }
+  std::remove(path.c_str());
+  if (wrong_size && unopenable)
+    std::cout << "Open errors passes" << std::endl;
+  else
+    std::cout << "Open errors fails" << std::endl;
+
+  // A rolling journal keeps its size on disk
+  {
+    mapped_circular_vector<int, circular_overwrite> test5(path, 8);
+    for (int x = 0; x < 100; ++x)
+      test5.push_back(x);
+    test5.push_front(-1);
+  }
+  {
+    mapped_circular_vector<int, circular_overwrite> test6(path, 8);
+    if (test6.capacity() == 8 && test6.size() == 8 && test6.front() == -1 && test6.back() == 98 &&
+        test6[1] == 92 && test6.array_one().second + test6.array_two().second == 8)
+      std::cout << "Overwriting journal passes" << std::endl;
+    else
+      std::cout << "Overwriting journal fails" << std::endl;
+  }
+  std::remove(path.c_str());
+
+  // A grow from 4 to 8 written back part way: the file extended and the wrapped
+  //   run copied past the old end, then also the journaled capacity
+  {
+    mapped_circular_vector<long long> test7(path, 4);
+    for (long long x = 0; x < 4; ++x)
+      test7.push_back(x);
+    test7.pop_front();
+    test7.pop_front();
+    test7.push_back(4);
+    test7.push_back(5);
+  }
+  const long long moved[2] = {4, 5};
+  circular_mapped_header header;
+  int fd = ::open(path.c_str(), O_RDWR);
+  bool interrupted = ::pread(fd, &header, sizeof(header), 0) == ssize_t(sizeof(header)) &&
+    ::ftruncate(fd, off_t(sizeof(header) + 8 * sizeof(long long))) == 0 &&
+    ::pwrite(fd, moved, sizeof(moved), off_t(sizeof(header) + 4 * sizeof(long long))) == ssize_t(sizeof(moved));
+  header.grow_start_idx = 2;
+  interrupted = interrupted && ::pwrite(fd, &header, sizeof(header), 0) == ssize_t(sizeof(header));
+  {
+    mapped_circular_vector<long long> test8(path);
+    interrupted = interrupted && test8.capacity() == 4 && test8.size() == 4 &&
+      test8.front() == 2 && test8.back() == 5;
+  }
+  header.grow_capacity = 8;
+  interrupted = interrupted && ::pwrite(fd, &header, sizeof(header), 0) == ssize_t(sizeof(header));
+  ::close(fd);
+  {
+    mapped_circular_vector<long long> test9(path);
+    const long long expected[4] = {2, 3, 4, 5};
+    interrupted = interrupted && test9.capacity() == 8 && test9.size() == 4 &&
+      std::equal(test9.begin(), test9.end(), expected) && test9.array_two().second == 0;
+  }
+  {
+    mapped_circular_vector<long long> test10(path);
+    test10.push_back(6);
+    interrupted = interrupted && test10.capacity() == 8 && test10.back() == 6;
+  }
+  std::remove(path.c_str());
+  if (interrupted)
+    std::cout << "Interrupted grow passes" << std::endl;
+  else
+    std::cout << "Interrupted grow fails" << std::endl;
+
+  // A grow smaller than either wrapped run still copies the shorter one past the old
+  //   end, so the file holds the old layout until the grow commits
+  bool preserved = false;
+  {
+    mapped_circular_vector<long long, circular_grow, circular_growth_additive<1> > test12(path, 8);
+    for (long long x = 0; x < 8; ++x)
+      test12.push_back(x);
+    test12.pop_front_n(4);
+    for (long long x = 8; x < 12; ++x)
+      test12.push_back(x);
+    test12.reserve(9);
+    const long long expected[8] = {4, 5, 6, 7, 8, 9, 10, 11};
+    preserved = test12.capacity() == 12 && std::equal(test12.begin(), test12.end(), expected);
+  }
+  // Written back before the grow committed, the old header finds the old layout
+  header.capacity = 8;
+  header.start_idx = header.end_idx = 4;
+  header.size = 8;
+  header.grow_capacity = 0;
+  fd = ::open(path.c_str(), O_RDWR);
+  preserved = preserved && ::pwrite(fd, &header, sizeof(header), 0) == ssize_t(sizeof(header));
+  ::close(fd);
+  {
+    mapped_circular_vector<long long, circular_grow, circular_growth_additive<1> > test13(path);
+    const long long expected[8] = {4, 5, 6, 7, 8, 9, 10, 11};
+    preserved = preserved && test13.capacity() == 8 && std::equal(test13.begin(), test13.end(), expected);
+  }
+  std::remove(path.c_str());
+  if (preserved)
+    std::cout << "Grow keeps the old layout passes" << std::endl;
+  else
+    std::cout << "Grow keeps the old layout fails" << std::endl;
+
+  // Growing a full vector from its own elements, the remap may move the mapping
+  bool aliased = true;
+  {
+    mapped_circular_vector<long long> test11(path, 1024);
+    for (long long x = 0; x < 1024; ++x)
+      test11.push_back(x);
+    test11.push_back(test11.front());
+    while (!test11.full())
+      test11.push_back(-1);
+    test11.push_front(test11[1023]);
+    while (!test11.full())
+      test11.push_back(-1);
+    test11.push_back_n(test11.array_two().first + 1, 2);
+    aliased = test11.front() == 1023 && test11[1] == 0 && test11[1025] == 0 &&
+      test11[test11.size() - 2] == 1 && test11.back() == 2;
+  }
+  std::remove(path.c_str());
+  if (aliased)
+    std::cout << "Growing from aliased elements passes" << std::endl;
+  else
+    std::cout << "Growing from aliased elements fails" << std::endl;
+}
+
+void TestMirroredVector() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING MIRRORED_CIRCULAR_VECTOR" << std::endl;
+
+  // Both storages against std::deque, the elements always contiguous
+  for (int mirror = 1; mirror >= 0; --mirror) {
+    std::srand(29);
+    mirrored_circular_vector<int> test1(1000, mirror != 0);
+    std::deque<int> reference;
+    bool matches = true;
+    for (int x = 0; x < 20000 && matches; ++x) {
+      switch (std::rand() % 5) {
+        case 0:
+          test1.push_front(x);
+          reference.push_front(x);
+          break;
+        case 1:
+          if (!reference.empty()) {
+            test1.pop_front();
+            reference.pop_front();
+          }
+          break;
+        case 2:
+          if (!reference.empty()) {
+            test1.pop_back();
+            reference.pop_back();
+          }
+          break;
+        default:
+          test1.push_back(x);
+          reference.push_back(x);
+      }
+      if (x % 5000 == 4999) {
+        const int bulk[3] = {-1, -2, -3};
+        test1.push_back_n(bulk, 3);
+        reference.insert(reference.end(), bulk, bulk + 3);
+      }
+      matches = test1.size() == reference.size() &&
+        std::equal(test1.data(), test1.data() + test1.size(), reference.begin()) &&
+        (test1.empty() || &test1.back() == test1.data() + test1.size() - 1);
+    }
+#ifdef CIRCULAR_VECTOR_HAS_MEMFD
+    matches = matches && test1.is_mirrored() == (mirror != 0);
+#endif
+    mirrored_circular_vector<int> test2(test1);
+    if (matches && test1.capacity() % 1024 == 0 && test2.size() == test1.size() &&
+        std::equal(test2.begin(), test2.end(), reference.begin()))
+      std::cout << (mirror ? "Double mapped" : "Fallback") << " storage passes" << std::endl;
+    else
+      std::cout << (mirror ? "Double mapped" : "Fallback") << " storage fails" << std::endl;
+  }
+
+  // A write through the first view is seen through the second
+  mirrored_circular_vector<int, circular_overwrite> test3(1);
+  const size_t capacity = test3.capacity();
+  for (size_t x = 0; x < capacity + capacity / 2; ++x)
+    test3.push_back(int(x));
+  bool seamless = test3.full() && test3.front() == int(capacity / 2) && test3.back() == int(capacity + capacity / 2 - 1);
+  for (size_t x = 0; x < test3.size() && seamless; ++x)
+    seamless = test3[x] == int(capacity / 2 + x);
+  if (seamless)
+    std::cout << "Wrapped elements contiguous passes" << std::endl;
+  else
+    std::cout << "Wrapped elements contiguous fails" << std::endl;
+
+  // Growing a full vector from its own elements
+  bool aliased = true;
+  for (int mirror = 1; mirror >= 0; --mirror) {
+    mirrored_circular_vector<int> test4(1, mirror != 0);
+    while (!test4.full())
+      test4.push_back(int(test4.size()));
+    const int first = test4.front(), last = test4.back();
+    const size_t size = test4.size();
+    test4.push_back(test4.front());
+    while (!test4.full())
+      test4.push_back(0);
+    test4.emplace_front(test4[size - 1]);
+    test4.push_back_n(test4.data() + 1, 2);
+    aliased = aliased && test4.front() == last && test4[1] == 0 && test4[size + 1] == first &&
+      test4[test4.size() - 2] == 0 && test4.back() == 1;
+  }
+  if (aliased)
+    std::cout << "Growing from aliased elements passes" << std::endl;
+  else
+    std::cout << "Growing from aliased elements fails" << std::endl;
+}
+
+// Length prefixed std::string codec
+struct StringCodec {
+  void encode(std::ostream &os, const std::string &val) {
+    const unsigned length = unsigned(val.size());
+    os.write(reinterpret_cast<const char *>(&length), sizeof(length));
+    os.write(val.data(), length);
+  }
+  std::string decode(std::istream &is) {
+    unsigned length = 0;
+    is.read(reinterpret_cast<char *>(&length), sizeof(length));
+    std::string val(length, '\0');
+    is.read(&val[0], length);
+    return val;
+  }
+};
+
+void TestSerialization() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING CIRCULAR_VECTOR SERIALIZATION" << std::endl;
+
+  // A wrapped vector through a file descriptor, read back into an unrelated vector
+  circular_vector<long long> test1(100);
+  for (int x = 0; x < 160; ++x) {
+    test1.push_back(x);
+    if (test1.size() > 90)
+      test1.pop_front();
+  }
+  const char *dir = std::getenv("TMPDIR");
+  const std::string path = std::string(dir ? dir : "/tmp") + "/circular_vector_io_" +
+    std::to_string(getpid()) + ".bin";
+  const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  circular_vector<long long> test2(3);
+  test2.push_back(7);
+  circular_vector<long long> test3;
+  bool truncated = false;
+  if (fd >= 0) {
+    write_circular_vector(fd, test1);
+    write_circular_vector(fd, circular_vector<long long>(1));
+    lseek(fd, 0, SEEK_SET);
+    read_circular_vector(fd, test2);
+    read_circular_vector(fd, test3);
+    lseek(fd, 0, SEEK_SET);
+    if (ftruncate(fd, 100) == 0) {
+      try {
+        read_circular_vector(fd, test3);
+      } catch (const std::runtime_error &) {
+        truncated = true;
+      }
+    }
+    close(fd);
+    std::remove(path.c_str());
+  }
+  if (!test1.is_linearized() && test2 == test1 && test2.capacity() == test1.size() &&
+      test3.empty() && truncated)
+    std::cout << "File descriptor round trip passes" << std::endl;
+  else
+    std::cout << "File descriptor round trip fails" << std::endl;
+
+  // Streams, raw and through a codec, reject data of another encoding
+  std::stringstream stream1, stream2;
+  write_circular_vector(stream1, test1);
+  circular_vector<std::string> test4;
+  for (int x = 0; x < 50; ++x) {
+    test4.push_back(std::string(x, 'a'));
+    test4.push_front(std::to_string(x));
+  }
+  StringCodec codec;
+  write_circular_vector(stream2, test4, codec);
+  const std::string raw = stream1.str();
+  circular_vector<long long, std::allocator<long long>, circular_pow2_index> test5;
+  circular_vector<std::string> test6;
+  circular_vector<int> test7;
+  read_circular_vector(stream1, test5);
+  read_circular_vector(stream2, test6, codec);
+  std::istringstream stream3(raw);
+  bool rejected = false;
+  try {
+    read_circular_vector(stream3, test7);
+  } catch (const std::runtime_error &) {
+    rejected = true;
+  }
+  if (test5.size() == test1.size() && std::equal(test5.begin(), test5.end(), test1.begin()) &&
+      test6 == test4 && rejected && test7.empty())
+    std::cout << "Stream and codec round trip passes" << std::endl;
+  else
+    std::cout << "Stream and codec round trip fails" << std::endl;
+
+  // A corrupt size is rejected before anything is allocated for it
+  const circular_io_header huge = circular_io_make_header(size_t(1) << 40, sizeof(long long));
+  const circular_io_header huge_codec = circular_io_make_header(~size_t(0), 0);
+  std::stringstream stream4, stream5;
+  stream4.write(reinterpret_cast<const char *>(&huge), sizeof(huge));
+  stream4 << "only a few bytes";
+  stream5.write(reinterpret_cast<const char *>(&huge_codec), sizeof(huge_codec));
+  int corrupt = 0;
+  try {
+    read_circular_vector(stream4, test5);
+  } catch (const std::runtime_error &) {
+    ++corrupt;
+  }
+  try {
+    read_circular_vector(stream5, test6, codec);
+  } catch (const std::runtime_error &) {
+    ++corrupt;
+  }
+  const int fd2 = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd2 >= 0) {
+    if (write(fd2, &huge, sizeof(huge)) == ssize_t(sizeof(huge)) && write(fd2, "bytes", 5) == 5) {
+      lseek(fd2, 0, SEEK_SET);
+      try {
+        read_circular_vector(fd2, test2);
+      } catch (const std::runtime_error &) {
+        ++corrupt;
+      }
+    }
+    close(fd2);
+    std::remove(path.c_str());
+  }
+  // Committing nothing to a moved from vector, which has no storage
+  circular_vector<long long> test8(test1);
+  circular_vector<long long> test9(std::move(test8));
+  test8.prepare_back(0);
+  test8.commit_back(0);
+  if (corrupt == 3 && test5.size() == test1.size() && test6 == test4 && test2 == test1 && test8.empty() &&
+      test9 == test1)
+    std::cout << "Corrupt size rejection passes" << std::endl;
+  else
+    std::cout << "Corrupt size rejection fails" << std::endl;
+
+  // A codec read past the first reserve keeps every element of an overwriting vector
+  typedef circular_vector<std::string, std::allocator<std::string>, circular_modulo_index,
+          circular_overwrite> overwrite_vector;
+  overwrite_vector test10(3000), test11(1);
+  for (int x = 0; x < 3000; ++x)
+    test10.push_back(std::to_string(x));
+  std::stringstream stream6;
+  write_circular_vector(stream6, test10, codec);
+  read_circular_vector(stream6, test11, codec);
+  if (test11 == test10 && test11.front() == "0" && test11.back() == "2999")
+    std::cout << "Long codec read passes" << std::endl;
+  else
+    std::cout << "Long codec read fails" << std::endl;
+}
+
+void TestStats() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING CIRCULAR_VECTOR STATISTICS" << std::endl;
+
+  typedef circular_vector<int, std::allocator<int>, circular_modulo_index, circular_grow,
+          circular_never_shrink, circular_growth_geometric<>, circular_stats> stats_vector;
+  typedef circular_vector<int, std::allocator<int>, circular_modulo_index, circular_overwrite,
+          circular_never_shrink, circular_growth_geometric<>, circular_stats> stats_ring;
+  // The members of a circular_vector<int> before the statistics policy
+  struct unstatted_layout {
+    size_t size, capacity, start, end;
+    std::allocator<int> alloc;
+    int *array;
+    circular_never_shrink shrink;
+  };
+  static_assert(sizeof(circular_vector<int>) == sizeof(unstatted_layout),
+      "circular_no_stats must not add to the size of a circular_vector");
+  static_assert(std::is_nothrow_move_constructible<circular_vector<int> >::value &&
+      !std::is_nothrow_move_constructible<stats_vector>::value,
+      "moving is noexcept unless registering the statistics may throw");
+
+  circular_stats_registry &registry = circular_stats_registry::instance();
+  const size_t live = registry.size();
+  std::ostringstream dump;
+  {
+    // Capacity 4 centred at index 2, the end wraps on the second push
+    stats_vector test1(4);
+    test1.stats().label("orders");
+    for (int x = 1; x <= 5; ++x)
+      test1.push_back(x);
+    test1.pop_front();
+    test1.pop_front();
+    test1.push_front(0);
+    const circular_stats &stats = test1.stats();
+    if (stats.push_back_count() == 5 && stats.push_front_count() == 1 &&
+        stats.pop_front_count() == 2 && stats.pop_back_count() == 0 &&
+        stats.reallocations() == 1 && stats.elements_relocated() == 4 &&
+        stats.peak_size() == 5 && stats.peak_capacity() == 6 && stats.wraps() == 1)
+      std::cout << "Push, pop, reallocation and wrap counts pass" << std::endl;
+    else
+      std::cout << "Push, pop, reallocation and wrap counts fail" << std::endl;
+
+    // Overwrites count a push and a pop, bulk operations count every element
+    stats_ring test2(4);
+    for (int x = 0; x < 6; ++x)
+      test2.push_back(x);
+    const int values[3] = {7, 8, 9};
+    test2.push_front_n(values, 3);
+    test2.pop_back_n(2);
+    stats_vector test3(test1);
+    if (test2.stats().push_back_count() == 6 && test2.stats().pop_front_count() == 2 &&
+        test2.stats().push_front_count() == 3 && test2.stats().pop_back_count() == 5 &&
+        test2.stats().reallocations() == 0 && test2.stats().peak_size() == 4 &&
+        test3.stats().push_back_count() == test1.size() && test3.stats().pop_front_count() == 0 &&
+        registry.size() == live + 3)
+      std::cout << "Overwrite, bulk and copy counts pass" << std::endl;
+    else
+      std::cout << "Overwrite, bulk and copy counts fail" << std::endl;
+
+    // A monitoring thread dumps the registry while the owner keeps pushing
+    std::atomic<bool> done(false);
+    std::thread monitor([&] {
+      while (!done.load()) {
+        std::ostringstream periodic;
+        registry.dump(periodic);
+      }
+    });
+    for (int x = 0; x < 100000; ++x) {
+      test1.push_back(x);
+      test1.pop_front();
+    }
+    done = true;
+    monitor.join();
+    registry.dump(dump);
+  }
+  if (registry.size() == live && dump.str().find("orders: reallocations 1") != std::string::npos)
+    std::cout << "Registry passes" << std::endl;
+  else
+    std::cout << "Registry fails" << std::endl;
+}
+
+// Checks the algorithms of circular_vector_simd.h against the standard algorithms on
+// containers of every size up to @a max_size, wrapped at every offset
+template <typename T>
+bool CheckSimdAlgorithms(size_t max_size) {
+  for (size_t n = 0; n <= max_size; n += 1 + n / 8) {
+    for (size_t offset = 0; offset <= n; offset += 1 + n / 4) {
+      circular_vector<T> a(n + 1), b(n + 1);
+      for (size_t x = 0; x < offset; ++x) {
+        a.push_back(T(0));
+        b.push_back(T(0));
+      }
+      for (size_t x = 0; x < n; ++x) {
+        a.push_back(T((x * 37 + 11) % 101));
+        b.push_back(T((x * 37 + 11) % 101));
+      }
+      a.pop_front_n(offset);
+      b.pop_front_n(offset);
+      if (circular_accumulate(a, 0LL) != std::accumulate(a.begin(), a.end(), 0LL) ||
+          circular_accumulate(a, T(0)) != std::accumulate(a.begin(), a.end(), T(0)) ||
+          circular_count(a, T(48)) != size_t(std::count(a.begin(), a.end(), T(48))) ||
+          circular_find(a, T(48)) != std::find(a.begin(), a.end(), T(48)) ||
+          circular_find(a, T(200)) != a.end() || !(a == b) || a < b || b < a)
+        return false;
+      if (n != 0) {
+        const std::pair<T, T> mm = circular_minmax(a);
+        if (mm.first != *std::min_element(a.begin(), a.end()) || mm.second != *std::max_element(a.begin(), a.end()))
+          return false;
+        // A single difference anywhere decides equality and order
+        const size_t at = (n * 7) / 11;
+        b[at] = T(b[at] + 1);
+        if (a == b || !(a < b) || b < a || !(b > a))
+          return false;
+        b[at] = a[at];
+        b.pop_back();
+        if (a == b || !(b < a) || a < b)
+          return false;
+      }
+    }
+  }
+  return true;
+}
+
+void TestSimdAlgorithms() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING CIRCULAR_VECTOR SIMD ALGORITHMS" << std::endl;
+
+  if (CheckSimdAlgorithms<signed char>(300) && CheckSimdAlgorithms<unsigned short>(300) &&
+      CheckSimdAlgorithms<int>(300) && CheckSimdAlgorithms<unsigned long long>(300) &&
+      CheckSimdAlgorithms<float>(300) && CheckSimdAlgorithms<double>(300))
+    std::cout << "Arithmetic algorithms pass" << std::endl;
+  else
+    std::cout << "Arithmetic algorithms fail" << std::endl;
+
+  // Counts above what a byte lane can hold, and lanes widened to the accumulator
+  circular_vector<unsigned char> test1(100000);
+  for (int x = 0; x < 100000; ++x)
+    test1.push_back(static_cast<unsigned char>(x % 3 == 0 ? 7 : 200));
+  // The baseline kernel, whatever the CPU, against the dispatched one
+  bool baseline = true;
+#ifdef CIRCULAR_VECTOR_HAS_SIMD
+  const circular_simd_count_kernel<unsigned char> kernel = {circular_simd_runs<unsigned char>(test1),
+    static_cast<unsigned char>(7)};
+  baseline = kernel() == circular_simd_dispatch(kernel);
+#endif
+  if (circular_count(test1, 7) == 33334 && baseline &&
+      circular_accumulate(test1, 0ULL) == 33334ULL * 7 + 66666ULL * 200 &&
+      circular_accumulate(test1, static_cast<unsigned char>(0)) ==
+        std::accumulate(test1.begin(), test1.end(), static_cast<unsigned char>(0)))
+    std::cout << "Lane overflow passes" << std::endl;
+  else
+    std::cout << "Lane overflow fails" << std::endl;
+
+  // NaNs compare neither less nor greater, and never equal
+  circular_vector<double> test2, test3;
+  for (int x = 0; x < 40; ++x) {
+    test2.push_back(x == 5 ? std::numeric_limits<double>::quiet_NaN() : x);
+    test3.push_back(x == 5 ? std::numeric_limits<double>::quiet_NaN() : x == 30 ? 31 : x);
+  }
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  if (test2 != test2 && test2 < test3 && !(test3 < test2) && circular_find(test2, nan) == test2.end() &&
+      circular_count(test2, nan) == 0)
+    std::cout << "Floating point semantics pass" << std::endl;
+  else
+    std::cout << "Floating point semantics fail" << std::endl;
+
+  // Other element types use the standard algorithms over the runs
+  circular_vector<std::string> test4(4);
+  for (int x = 0; x < 6; ++x)
+    test4.push_back(std::to_string(x));
+  test4.pop_front_n(2);
+  circular_vector<std::string> test5(test4);
+  if (circular_find(test4, std::string("3")) == test4.begin() + 1 && circular_count(test4, std::string("5")) == 1 &&
+      circular_accumulate(test4, std::string()) == "2345" && circular_minmax(test4).second == "5" &&
+      test4 == test5 && !(test4 < test5))
+    std::cout << "Other element types pass" << std::endl;
+  else
+    std::cout << "Other element types fail" << std::endl;
+}
+
+// Concatenates the elements in order, not commutative
+struct ConcatMonoid {
+  typedef std::string value_type;
+  std::string identity() const                                  { return std::string(); }
+  std::string lift(char c) const                                { return std::string(1, c); }
+  std::string combine(const std::string &a, const std::string &b) const { return a + b; }
+};
+
+void TestWindow() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING SLIDING WINDOW AGGREGATES" << std::endl;
+
+  // Random pushes and pops at both ends, checked against a fold of the whole window
+  srand(7);
+  circular_window<char, ConcatMonoid> test1(50);
+  circular_window<int, circular_sum_monoid<int, long long> > test2(50);
+  circular_window<int, circular_minmax_monoid<int> > test3(50);
+  std::deque<int> model;
+  bool ordered = true, summed = true, bounded = true;
+  for (int x = 0; x < 20000; ++x) {
+    const int op = rand() % 8;
+    const int val = rand() % 1000 - 500;
+    if (op < 3 || model.empty()) {
+      test1.push_back(char('a' + val % 26 + 25) );
+      test2.push_back(val);
+      test3.push_back(val);
+      model.push_back(val);
+      if (model.size() > 50)
+        model.pop_front();
+    } else if (op < 5) {
+      test1.push_front(char('a' + val % 26 + 25));
+      test2.push_front(val);
+      test3.push_front(val);
+      model.push_front(val);
+      if (model.size() > 50)
+        model.pop_back();
+    } else if (op < 7) {
+      test1.pop_front();
+      test2.pop_front();
+      test3.pop_front();
+      model.pop_front();
+    } else {
+      test1.pop_back();
+      test2.pop_back();
+      test3.pop_back();
+      model.pop_back();
+    }
+    std::string concat;
+    for (size_t y = 0; y < model.size(); ++y)
+      concat += char('a' + model[y] % 26 + 25);
+    ordered = ordered && test1.aggregate() == concat;
+    summed = summed && test2.aggregate() == std::accumulate(model.begin(), model.end(), 0LL) &&
+      test2.size() == model.size() && std::equal(model.begin(), model.end(), test2.elements().begin());
+    if (!model.empty())
+      bounded = bounded && test3.aggregate().first == *std::min_element(model.begin(), model.end()) &&
+        test3.aggregate().second == *std::max_element(model.begin(), model.end());
+    else
+      bounded = bounded && test3.aggregate().first == std::numeric_limits<int>::max();
+  }
+  if (ordered)
+    std::cout << "Non commutative monoid passes" << std::endl;
+  else
+    std::cout << "Non commutative monoid fails" << std::endl;
+  if (summed)
+    std::cout << "Sum monoid passes" << std::endl;
+  else
+    std::cout << "Sum monoid fails" << std::endl;
+  if (bounded)
+    std::cout << "Min max monoid passes" << std::endl;
+  else
+    std::cout << "Min max monoid fails" << std::endl;
+
+  // A time window of doubles far from zero, as push_back with eviction
+  circular_window_stats<double> test4(100);
+  std::deque<double> samples;
+  bool stats = true;
+  for (int x = 0; x < 5000; ++x) {
+    const double val = 1e9 + (rand() % 10000) / 100.0;
+    test4.push_back(val);
+    samples.push_back(val);
+    if (samples.size() > 100)
+      samples.pop_front();
+    if (x % 97 == 96) {
+      const double n = double(samples.size());
+      const double mean = std::accumulate(samples.begin(), samples.end(), 0.0) / n;
+      double squares = 0;
+      for (size_t y = 0; y < samples.size(); ++y)
+        squares += (samples[y] - mean) * (samples[y] - mean);
+      stats = stats && std::fabs(test4.mean() - mean) < 1e-14 * mean &&
+        std::fabs(test4.variance() - squares / n) < 1e-6 * (1 + squares / n) &&
+        std::fabs(test4.sample_variance() - squares / (n - 1)) < 1e-6 * (1 + squares / n) &&
+        std::fabs(test4.sum() - mean * n) < 1e-3 &&
+        test4.min() == *std::min_element(samples.begin(), samples.end()) &&
+        test4.max() == *std::max_element(samples.begin(), samples.end());
+    }
+  }
+  test4.pop_back();
+  test4.pop_front();
+  test4.push_front(1e9);
+  stats = stats && test4.size() == 99 && test4.min() == 1e9 && test4.elements().front() == 1e9;
+  while (!test4.empty())
+    test4.pop_back();
+  test4.push_back(3);
+  test4.push_back(5);
+  stats = stats && test4.mean() == 4 && test4.variance() == 1 && test4.sum() == 8 &&
+    test4.min() == 3 && test4.max() == 5;
+  if (stats)
+    std::cout << "Window statistics pass" << std::endl;
+  else
+    std::cout << "Window statistics fail" << std::endl;
+
+  // Pushing a copy of the element the push evicts
+  circular_window<std::string, circular_sum_monoid<std::string> > test6(2);
+  test6.push_back(std::string(40, 'a'));
+  test6.push_back(std::string(40, 'b'));
+  test6.push_back(test6.front());
+  test6.push_front(test6.back());
+  circular_window_stats<double> test7(1);
+  test7.push_back(2);
+  test7.push_back(test7.elements().front());
+  test7.push_front(test7.elements().back());
+  if (test6.aggregate() == std::string(40, 'a') + std::string(40, 'b') && test6.size() == 2 &&
+      test7.size() == 1 && test7.sum() == 2 && test7.mean() == 2 && test7.max() == 2)
+    std::cout << "Evicting an aliased element passes" << std::endl;
+  else
+    std::cout << "Evicting an aliased element fails" << std::endl;
+
+  bool thrown = false;
+  try {
+    circular_window_stats<int> test5(0);
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  if (thrown)
+    std::cout << "Zero window size throws passes" << std::endl;
+  else
+    std::cout << "Zero window size throws fails" << std::endl;
+}
+
+void TestParallel() {
+  std::cout << "======================================================" << std::endl;
+  std::cout << "TESTING PARALLEL ALGORITHMS" << std::endl;
+
+#if __cplusplus >= 202002L
+  static_assert(std::random_access_iterator<circular_vector<int>::iterator> &&
+      std::random_access_iterator<circular_vector<int>::const_iterator>,
+      "circular_vector iterators must model std::random_access_iterator");
+#endif
+  // The standard algorithms over the iterators of a wrapped %circular_vector
+  circular_vector<int> test1(1000);
+  for (int x = 0; x < 1600; ++x) {
+    if (test1.full())
+      test1.pop_front();
+    test1.push_back((x * 7919) % 1009);
+  }
+  std::vector<int> expected(test1.begin(), test1.end());
+  std::sort(expected.begin(), expected.end());
+  circular_vector<int> test2(test1);
+  std::sort(test2.begin(), test2.end());
+  std::nth_element(test1.begin(), test1.begin() + 500, test1.end());
+  if (std::equal(expected.begin(), expected.end(), test2.begin()) && test1[500] == expected[500])
+    std::cout << "std::sort and std::nth_element over iterators pass" << std::endl;
+  else
+    std::cout << "std::sort and std::nth_element over iterators fail" << std::endl;
+
+  // Small grains so the runs of a wrapped vector are split across every thread
+  circular_thread_pool pool(4);
+  const circular_parallel_policy par = circular_par(pool, 1000);
+  circular_vector<long long> test3(100000);
+  for (long long x = 0; x < 150000; ++x) {
+    if (test3.full())
+      test3.pop_front();
+    test3.push_back((x * 7919) % 100003);
+  }
+  std::vector<long long> copy(test3.begin(), test3.end());
+  circular_for_each(par, test3, [](long long &x) { x *= 3; });
+  bool each = true;
+  for (size_t x = 0; x < copy.size(); ++x)
+    each = each && test3[x] == copy[x] * 3;
+  std::vector<long long> doubled(test3.size());
+  const std::vector<long long>::iterator last =
+    circular_transform(par, test3, doubled.begin(), [](long long x) { return x * 2; });
+  circular_vector<long long> halved(test3.size());
+  halved.resize(test3.size());
+  circular_transform(par, test3, halved.begin(), [](long long x) { return x / 3; });
+  if (each && last == doubled.end() && doubled.front() == copy.front() * 6 &&
+      doubled.back() == copy.back() * 6 && std::equal(copy.begin(), copy.end(), halved.begin()))
+    std::cout << "Parallel for_each and transform pass" << std::endl;
+  else
+    std::cout << "Parallel for_each and transform fail" << std::endl;
+
+  const long long sum = std::accumulate(copy.begin(), copy.end(), 0LL) * 3;
+  const long long max = circular_reduce(par, test3, 0LL, [](long long a, long long b) { return std::max(a, b); });
+  if (circular_reduce(par, test3, 5LL) == sum + 5 && max == *std::max_element(copy.begin(), copy.end()) * 3 &&
+      circular_reduce(circular_seq(), test3, 0LL) == sum && circular_reduce(par, circular_vector<int>(), 7) == 7)
+    std::cout << "Parallel reduce passes" << std::endl;
+  else
+    std::cout << "Parallel reduce fails" << std::endl;
+
+  std::sort(copy.begin(), copy.end(), std::greater<long long>());
+  circular_sort(par, test3, std::greater<long long>());
+  circular_vector<int> test4(test1);
+  circular_sort(par, test4);
+  if (std::equal(copy.begin(), copy.end(), test3.begin(), [](long long a, long long b) { return a == b / 3; }) &&
+      std::equal(expected.begin(), expected.end(), test4.begin()))
+    std::cout << "Parallel sort passes" << std::endl;
+  else
+    std::cout << "Parallel sort fails" << std::endl;
+
+  // The first exception of a task reaches the caller, and the pool stays usable
+  bool thrown = false;
+  try {
+    circular_for_each(par, test3, [](long long &x) {
+      if (x == 0)
+        throw std::runtime_error("zero");
+    });
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+  std::atomic<int> calls(0);
+  circular_for_each(par, test3, [&](long long &) { calls.fetch_add(1, std::memory_order_relaxed); });
+  if (thrown && calls.load() == int(test3.size()))
+    std::cout << "Parallel exceptions pass" << std::endl;
+  else
+    std::cout << "Parallel exceptions fail" << std::endl;
+
+#ifdef CIRCULAR_VECTOR_HAS_EXECUTION
+  circular_vector<long long> test5(test3);
+  circular_sort(std::execution::par, test5);
+  if (circular_reduce(std::execution::par, test5, 0LL) == sum && circular_reduce(std::execution::seq, test5, 0LL) == sum &&
+      std::is_sorted(test5.begin(), test5.end()))
+    std::cout << "Standard execution policies pass" << std::endl;
+  else
+    std::cout << "Standard execution policies fail" << std::endl;
+#endif
+}